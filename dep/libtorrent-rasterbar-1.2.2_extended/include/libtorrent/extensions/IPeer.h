@@ -12,7 +12,7 @@ namespace libtorrent {
         IPeer() {};
         virtual ~IPeer() {};
 
-        virtual void sendMessage(std::shared_ptr<std::string> message) = 0;
+        virtual void sendMessage(std::shared_ptr<const std::string> message) = 0;
 
         virtual std::string getInfo() const = 0;
 
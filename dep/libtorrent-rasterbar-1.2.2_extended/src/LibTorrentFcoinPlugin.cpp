@@ -115,7 +115,7 @@ struct FcoinPeerPlugin final
         }
     }
 
-    virtual void sendMessage(std::shared_ptr<std::string> message) {
+    virtual void sendMessage(std::shared_ptr<const std::string> message) {
         if(libtorrent_thread_id_ == std::this_thread::get_id()) {
             sendMessageWithinSingleThread(message);
         } else {
@@ -154,7 +154,7 @@ struct FcoinPeerPlugin final
 
 protected:
 
-    virtual void sendMessageWithinSingleThread(std::shared_ptr<std::string> message) {
+    virtual void sendMessageWithinSingleThread(std::shared_ptr<const std::string> message) {
         std::vector<char> header_buffer(6);
         char* header = &header_buffer[0];
         int total_size = 2 + message->length();
@@ -174,7 +174,7 @@ protected:
     peer_info peer_info_;
 
     mutable std::mutex mtx_buffer_access_;
-    std::queue<std::shared_ptr<std::string>> buffered_msgs_;
+    std::queue<std::shared_ptr<const std::string>> buffered_msgs_;
 };
 
 
@@ -18,10 +18,12 @@
 #include <git_info.h>
 
 #include "scn/Miner/MinerLocal.h"
+#include "scn/Miner/MinerServer.h"
 #include "scn/Blockchain/Blockchain.h"
 #include "scn/P2PConnector/P2PConnector.h"
 #include "scn/BlockchainManager/BlockchainManager.h"
 #include "scn/SystemMonitor/SystemMonitor.h"
+#include "scn/Common/CpuAffinity.h"
 #include <chrono>
 
 
@@ -37,10 +39,29 @@ int main(int argc, char* argv[]) {
 
 int startCommandLineApp(int argc, char* argv[]) {
     if (argc < 5) {
-        std::cerr << "Usage: " << argv[0] << " PUBLIC_KEY_FILE PRIVATE_KEY_FILE NUM_MINING_THREADS LISTEN_PORT" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " PUBLIC_KEY_FILE PRIVATE_KEY_FILE NUM_MINING_THREADS LISTEN_PORT [MINER_SERVER] [MINER_CORES] [MINER_HOST_ID]" << std::endl;
+        std::cerr << "  MINER_SERVER: [ADDRESS:]PORT of the miner server, ADDRESS defaults to 127.0.0.1 (local miners only), PORT 0 disables the miner server" << std::endl;
+        std::cerr << "  MINER_CORES: cores of the mining threads (e.g. 2-7,10) or numa:N for all cores of numa node N, - for no pinning" << std::endl;
+        std::cerr << "  MINER_HOST_ID: number unique among the nodes mining with the same key, random by default" << std::endl;
         return 1;
     }
 
+    //the miner cores have to be known before any consensus thread is started
+    if(argc > 6 && std::string(argv[6]) != "-") {
+        std::string miner_cores_arg(argv[6]);
+        std::vector<uint32_t> miner_cores;
+        if(miner_cores_arg.compare(0, 5, "numa:") == 0) {
+            miner_cores = scn::CpuAffinity::getCoresOfNumaNode(std::stoi(miner_cores_arg.substr(5)));
+        } else {
+            scn::CpuAffinity::parseCoreList(miner_cores_arg, miner_cores);
+        }
+        if(miner_cores.empty()) {
+            std::cerr << "Invalid miner cores: " << miner_cores_arg << std::endl;
+            return 1;
+        }
+        scn::CpuAffinity::setMinerCores(miner_cores);
+    }
+
     std::srand(std::time(nullptr));
 
     std::ifstream public_key_stream(argv[1]);
@@ -52,7 +73,30 @@ int startCommandLineApp(int argc, char* argv[]) {
     scn::Blockchain blockchain("./blockchains/" + std::string(argv[4]) + "/");
     scn::P2PConnector p2p_connector(std::stoi(std::string(argv[4])), blockchain);
     scn::MinerLocal miner(std::stoi(std::string(argv[3])));
-    scn::BlockchainManager manager(public_key, private_key_string.str(), blockchain, p2p_connector, miner);
+    //nodes mining with the same key on different hosts check disjoint values only with different host ids
+    if(argc > 7) {
+        miner.setHostId(static_cast<uint32_t>(std::stoul(std::string(argv[7]))));
+    }
+    //remote miners (full_node_miner) connect to the miner server and mine next to the local threads
+    std::unique_ptr<scn::MinerServer> miner_server;
+    if(argc > 5) {
+        std::string miner_server_arg(argv[5]);
+        std::string miner_server_address = scn::MinerServer::default_listen_address;
+        auto separator = miner_server_arg.rfind(':');
+        if(separator != std::string::npos) {
+            miner_server_address = miner_server_arg.substr(0, separator);
+            //IPv6 addresses in brackets, e.g. [::1]:13287
+            if(miner_server_address.size() >= 2 && miner_server_address.front() == '[' && miner_server_address.back() == ']') {
+                miner_server_address = miner_server_address.substr(1, miner_server_address.size() - 2);
+            }
+            miner_server_arg = miner_server_arg.substr(separator + 1);
+        }
+        if(std::stoi(miner_server_arg) != 0) {
+            miner_server = std::make_unique<scn::MinerServer>(std::stoi(miner_server_arg), &miner, miner_server_address);
+        }
+    }
+    scn::IMiner& node_miner = miner_server ? static_cast<scn::IMiner&>(*miner_server) : miner;
+    scn::BlockchainManager manager(public_key, private_key_string.str(), blockchain, p2p_connector, node_miner);
     scn::SystemMonitor system_monitor;
 
     while(true) {
@@ -102,7 +146,7 @@ int startCommandLineApp(int argc, char* argv[]) {
                 auto num_peers = p2p_connector.numConnectedPeers();
                 auto percent_synchronized = manager.percentBlockchainSynchronized();
                 auto num_worker_threads = miner.numWorkerThreads();
-                auto cps = miner.numChecksPerSecond();
+                auto cps = node_miner.numChecksPerSecond();
                 std::cout << "Newest Block Index: " << block->header.block_uid << std::endl <<
                           "Newest Block Hash: " << scn::hash_helper::toString(block->header.generic_header.block_hash) << std::endl <<
                           "Balance: " << std::fixed << std::setprecision(6) << static_cast<double>(blockchain.getBalance(public_key)) /
@@ -110,7 +154,15 @@ int startCommandLineApp(int argc, char* argv[]) {
                           "Peers: " << (num_peers>0 ? "\033[1;32m" : "\033[1;31m") << num_peers << "\033[0m" << "\t\t" <<
                           "Miner: " << (miner.isRunning() ? "\033[1;" + std::string(num_worker_threads == 0 ? "33" : "32") + "mrunning (threads: " + std::to_string(num_worker_threads) + " cps: " + std::to_string(cps) + ")\033[0m" : "\033[1;31mnot running\033[0m") << "\t" <<
                           "Blockchain: " << (percent_synchronized == 100 ? "\033[1;32msynchronized" : "\033[1;33msynchronizing") << " (" << (uint32_t)percent_synchronized << "%)\033[0m" << std::endl <<
-                          "Epoch: " << mining_state.epoch << "\t\tCoins in circulation: " << (mining_state.num_minings_in_epoch + mining_state.epoch * scn::CollectionBlock::max_num_creations) << std::endl << std::endl;
+                          "Epoch: " << mining_state.epoch << "\t\tCoins in circulation: " << (mining_state.num_minings_in_epoch + mining_state.epoch * scn::CollectionBlock::max_num_creations) << std::endl;
+                std::cout << "Consensus phases (avg/max ms):";
+                for(auto& phase_stats : manager.getConsensusPhaseStats()) {
+                    auto& stats = phase_stats.second;
+                    std::cout << "  " << (phase_stats.first == scn::BlockchainManager::ConsensusPhase::IntroduceBlockStart ? "block start " :
+                                          phase_stats.first == scn::BlockchainManager::ConsensusPhase::IntroduceBlockEnd ? "block end " : "validate ") <<
+                              (stats.total_duration_us / std::max<uint64_t>(stats.num_phases, 1) / 1000) << "/" << (stats.max_duration_us / 1000);
+                }
+                std::cout << std::endl << std::endl;
                 break;
             }
             case 'p':
@@ -0,0 +1,42 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <iostream>
+#include "scn/Miner/MinerClient.h"
+#include <chrono>
+#include <thread>
+
+
+int main(int argc, char* argv[]) {
+
+    google::InitGoogleLogging(argv[0]);
+
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " FULL_NODE_HOST MINER_SERVER_PORT NUM_MINING_THREADS" << std::endl;
+        return 1;
+    }
+
+    scn::MinerClient miner(argv[1], std::stoi(std::string(argv[2])), std::stoi(std::string(argv[3])));
+    miner.start();
+
+    while(true) {
+        std::this_thread::sleep_for(std::chrono::seconds(10));
+        std::cout << "Checks per second: " << miner.numChecksPerSecond() << "\tFound values: " << miner.numFoundValues() << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,365 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "BlockStore.h"
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <vector>
+#include <fcntl.h>
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#endif
+
+using namespace scn;
+
+
+class BlockStore::Segment {
+public:
+    Segment(const std::string& path, bool create, bool read_only = false)
+    :path_(path)
+    ,size_(0)
+    ,remove_on_close_(false) {
+#ifdef _WIN32
+        fd_ = ::_open(path.c_str(), (read_only ? _O_RDONLY : _O_RDWR) | _O_BINARY | (create ? _O_CREAT : 0), _S_IREAD | _S_IWRITE);
+        if(fd_ >= 0) {
+            size_ = ::_lseeki64(fd_, 0, SEEK_END);
+        }
+#else
+        fd_ = ::open(path.c_str(), (read_only ? O_RDONLY : O_RDWR) | (create ? O_CREAT : 0), 0644);
+        if(fd_ >= 0) {
+            size_ = ::lseek(fd_, 0, SEEK_END);
+        }
+#endif
+        if(fd_ < 0) {
+            LOG(ERROR) << "BlockStore: could not open segment " << path;
+        }
+    }
+
+    ~Segment() {
+        if(fd_ >= 0) {
+#ifdef _WIN32
+            ::_close(fd_);
+#else
+            ::close(fd_);
+#endif
+        }
+        if(remove_on_close_) {
+            boost::system::error_code error_code;
+            boost::filesystem::remove(path_, error_code);
+        }
+    }
+
+    bool isOpen() const {
+        return fd_ >= 0;
+    }
+
+    uint64_t size() const {
+        return size_;
+    }
+
+    bool readAt(uint64_t offset, void* buffer, uint64_t length) const {
+        auto position = static_cast<uint8_t*>(buffer);
+#ifdef _WIN32
+        //no positioned read in the C runtime, reads of one segment are serialized
+        std::lock_guard<std::mutex> lock(mtx_file_access_);
+        if(::_lseeki64(fd_, offset, SEEK_SET) < 0) {
+            return false;
+        }
+#endif
+        while(length > 0) {
+#ifdef _WIN32
+            auto num_read = ::_read(fd_, position, static_cast<unsigned int>(std::min<uint64_t>(length, 1 << 30)));
+#else
+            auto num_read = ::pread(fd_, position, length, offset);
+#endif
+            if(num_read <= 0) {
+                return false;
+            }
+            position += num_read;
+            offset += num_read;
+            length -= num_read;
+        }
+        return true;
+    }
+
+    //NOTE: only one thread appends at a time (see BlockStore::mtx_append_access_)
+    bool append(const void* data, uint64_t length) {
+        auto position = static_cast<const uint8_t*>(data);
+#ifdef _WIN32
+        std::lock_guard<std::mutex> lock(mtx_file_access_);
+        if(::_lseeki64(fd_, size_, SEEK_SET) < 0) {
+            return false;
+        }
+#endif
+        while(length > 0) {
+#ifdef _WIN32
+            auto num_written = ::_write(fd_, position, static_cast<unsigned int>(std::min<uint64_t>(length, 1 << 30)));
+#else
+            auto num_written = ::pwrite(fd_, position, length, size_);
+#endif
+            if(num_written <= 0) {
+                return false;
+            }
+            position += num_written;
+            size_ += num_written;
+            length -= num_written;
+        }
+        return true;
+    }
+
+    void truncate(uint64_t size) {
+#ifdef _WIN32
+        std::lock_guard<std::mutex> lock(mtx_file_access_);
+        ::_chsize_s(fd_, size);
+#else
+        if(::ftruncate(fd_, size) != 0) {
+            LOG(ERROR) << "BlockStore: could not truncate segment " << path_;
+        }
+#endif
+        size_ = size;
+    }
+
+    void removeOnClose() {
+        remove_on_close_ = true;
+    }
+
+protected:
+    const std::string path_;
+    int fd_;
+    std::atomic<uint64_t> size_;
+    std::atomic<bool> remove_on_close_;
+#ifdef _WIN32
+    mutable std::mutex mtx_file_access_;
+#endif
+};
+
+
+BlockStore::BlockStore(const std::string& folder_path, bool read_only)
+:folder_path_(folder_path)
+,read_only_(read_only)
+,index_()
+,segments_()
+,next_segment_id_(1) {
+    open();
+}
+
+
+BlockStore::~BlockStore() = default;
+
+
+std::shared_ptr<const std::string> BlockStore::read(block_uid_t uid) const {
+    Location location;
+    std::shared_ptr<Segment> segment;
+    {
+        LOCK_MUTEX_WATCHDOG(mtx_index_access_);
+        auto it = index_.find(uid);
+        if(it == index_.end()) {
+            return nullptr;
+        }
+        location = it->second;
+        segment = segments_.at(location.segment_id);
+    }
+
+    //the segment stays open while it is read, even if the store is cleared in the meantime
+    std::string data(location.length, '\0');
+    if(!segment->readAt(location.offset, &data[0], location.length)) {
+        LOG(ERROR) << "BlockStore: could not read block " << uid;
+        return nullptr;
+    }
+    return std::make_shared<const std::string>(std::move(data));
+}
+
+
+bool BlockStore::contains(block_uid_t uid) const {
+    LOCK_MUTEX_WATCHDOG(mtx_index_access_);
+    return index_.find(uid) != index_.end();
+}
+
+
+void BlockStore::append(block_uid_t uid, const std::string& data) {
+    if(read_only_) {
+        LOG(ERROR) << "BlockStore: could not write block " << uid << " to read-only store " << folder_path_;
+        return;
+    }
+
+    LOCK_MUTEX_WATCHDOG(mtx_append_access_);
+    uint64_t segment_id;
+    auto segment = getAppendSegment(segment_id);
+    if(!segment) {
+        return;
+    }
+
+    auto offset = segment->size();
+    RecordHeader record_header = {uid, data.size()};
+    if(!segment->append(&record_header, sizeof(RecordHeader)) || !segment->append(data.data(), data.size())) {
+        LOG(ERROR) << "BlockStore: could not write block " << uid;
+        segment->truncate(offset);
+        return;
+    }
+
+    {
+        LOCK_MUTEX_WATCHDOG(mtx_index_access_);
+        index_[uid] = {segment_id, offset + sizeof(RecordHeader), data.size()};
+    }
+}
+
+
+bool BlockStore::append(const std::vector<std::pair<block_uid_t, std::string>>& blocks) {
+    if(blocks.empty()) {
+        return true;
+    }
+    if(read_only_) {
+        LOG(ERROR) << "BlockStore: could not write " << blocks.size() << " blocks to read-only store " << folder_path_;
+        return false;
+    }
+
+    LOCK_MUTEX_WATCHDOG(mtx_append_access_);
+    uint64_t segment_id;
+    auto segment = getAppendSegment(segment_id);
+    if(!segment) {
+        return false;
+    }
+
+    //all records are written with one call
+    uint64_t buffer_size = 0;
+    for(auto& block : blocks) {
+        buffer_size += sizeof(RecordHeader) + block.second.size();
+    }
+    std::string buffer;
+    buffer.reserve(buffer_size);
+    for(auto& block : blocks) {
+        RecordHeader record_header = {block.first, block.second.size()};
+        buffer.append(reinterpret_cast<const char*>(&record_header), sizeof(RecordHeader));
+        buffer.append(block.second);
+    }
+
+    auto offset = segment->size();
+    if(!segment->append(buffer.data(), buffer.size())) {
+        LOG(ERROR) << "BlockStore: could not write " << blocks.size() << " blocks";
+        segment->truncate(offset);
+        return false;
+    }
+
+    {
+        LOCK_MUTEX_WATCHDOG(mtx_index_access_);
+        for(auto& block : blocks) {
+            index_[block.first] = {segment_id, offset + sizeof(RecordHeader), block.second.size()};
+            offset += sizeof(RecordHeader) + block.second.size();
+        }
+    }
+    return true;
+}
+
+
+void BlockStore::clear() {
+    if(read_only_) {
+        LOG(ERROR) << "BlockStore: could not clear read-only store " << folder_path_;
+        return;
+    }
+
+    LOCK_MUTEX_WATCHDOG(mtx_append_access_);
+    //the index is released after unlocking, readers only wait for the swap
+    std::map<block_uid_t, Location> index;
+    std::map<uint64_t, std::shared_ptr<Segment>> segments;
+    {
+        LOCK_MUTEX_WATCHDOG(mtx_index_access_);
+        index.swap(index_);
+        segments.swap(segments_);
+    }
+    for(auto& segment : segments) {
+        segment.second->removeOnClose();
+    }
+}
+
+
+uint64_t BlockStore::numBlocks() const {
+    LOCK_MUTEX_WATCHDOG(mtx_index_access_);
+    return index_.size();
+}
+
+
+uint64_t BlockStore::numSegments() const {
+    LOCK_MUTEX_WATCHDOG(mtx_index_access_);
+    return segments_.size();
+}
+
+
+void BlockStore::open() {
+    if(!boost::filesystem::is_directory(folder_path_)) {
+        return;
+    }
+
+    std::map<uint64_t, std::string> segment_paths;
+    for(auto& entry : boost::filesystem::directory_iterator(folder_path_)) {
+        if(entry.path().extension() != ".seg") {
+            continue;
+        }
+        try {
+            segment_paths[std::stoull(entry.path().stem().string())] = entry.path().string();
+        } catch(const std::exception& e) {
+            //not a segment of this store
+        }
+    }
+
+    for(auto& segment_path : segment_paths) {
+        auto segment = std::make_shared<Segment>(segment_path.second, false, read_only_);
+        if(!segment->isOpen()) {
+            continue;
+        }
+        uint64_t offset = 0;
+        RecordHeader record_header;
+        while(offset + sizeof(RecordHeader) <= segment->size() &&
+              segment->readAt(offset, &record_header, sizeof(RecordHeader)) &&
+              record_header.length <= segment->size() - offset - sizeof(RecordHeader)) {
+            index_[record_header.block_uid] = {segment_path.first, offset + sizeof(RecordHeader), record_header.length};
+            offset += sizeof(RecordHeader) + record_header.length;
+        }
+        if(offset != segment->size()) {
+            //incomplete record at the end (e.g. power loss while writing)
+            if(read_only_) {
+                LOG(WARNING) << "BlockStore: skipping incomplete record at the end of " << segment_path.second;
+            } else {
+                LOG(WARNING) << "BlockStore: dropping incomplete record at the end of " << segment_path.second;
+                segment->truncate(offset);
+            }
+        }
+        segments_[segment_path.first] = segment;
+        next_segment_id_ = segment_path.first + 1;
+    }
+}
+
+
+std::shared_ptr<BlockStore::Segment> BlockStore::getAppendSegment(uint64_t& segment_id) {
+    LOCK_MUTEX_WATCHDOG(mtx_index_access_);
+    if(segments_.empty() || segments_.rbegin()->second->size() >= max_segment_size) {
+        auto new_segment = std::make_shared<Segment>(getSegmentPath(next_segment_id_), true);
+        if(!new_segment->isOpen()) {
+            return nullptr;
+        }
+        segments_[next_segment_id_++] = new_segment;
+    }
+    segment_id = segments_.rbegin()->first;
+    return segments_.rbegin()->second;
+}
+
+
+std::string BlockStore::getSegmentPath(uint64_t segment_id) const {
+    return folder_path_ + "/" + std::to_string(segment_id) + ".seg";
+}
@@ -0,0 +1,99 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FULL_NODE_BLOCKSTORE_H
+#define FULL_NODE_BLOCKSTORE_H
+
+#include "scn/Common/Common.h"
+#include <mutex>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace scn {
+
+    //serialized blocks in append-only segment files ("<id>.seg") plus an in-memory index uid -> (segment, offset, length)
+    //reads use positioned reads on already open files and only hold a lock for the index lookup, so many readers
+    //are served concurrently
+    //record layout: block uid (8 bytes), length (8 bytes), serialized block - native byte order, the store is local
+    class BlockStore {
+    public:
+        //a read-only store never modifies the folder (e.g. the data folder of another node): segments are opened
+        //read-only, an incomplete record at the end is only skipped and appending or clearing fails
+        explicit BlockStore(const std::string& folder_path, bool read_only = false);
+
+        virtual ~BlockStore();
+
+        //nullptr if the block is not stored
+        std::shared_ptr<const std::string> read(block_uid_t uid) const;
+
+        bool contains(block_uid_t uid) const;
+
+        //a block stored again replaces the previous version
+        void append(block_uid_t uid, const std::string& data);
+
+        //appends all blocks with a single write, returns false (and stores none of them) if writing failed
+        bool append(const std::vector<std::pair<block_uid_t, std::string>>& blocks);
+
+        //drops all blocks, segment files are deleted as soon as no read uses them anymore
+        void clear();
+
+        uint64_t numBlocks() const;
+
+        uint64_t numSegments() const;
+
+        static const uint64_t max_segment_size = 64 * 1024 * 1024;
+
+    protected:
+
+        class Segment;
+
+        struct RecordHeader {
+            uint64_t block_uid;
+            uint64_t length;
+        };
+
+        struct Location {
+            uint64_t segment_id;
+            uint64_t offset; //of the serialized block in the segment
+            uint64_t length;
+        };
+
+        //reads the record headers of all existing segments (later segments win)
+        void open();
+
+        //segment new blocks are appended to, a new one is started once the current one is full
+        //NOTE: requires mtx_append_access_ to be locked
+        std::shared_ptr<Segment> getAppendSegment(uint64_t& segment_id);
+
+        std::string getSegmentPath(uint64_t segment_id) const;
+
+        const std::string folder_path_;
+        const bool read_only_;
+
+        mutable std::mutex mtx_index_access_;
+        std::map<block_uid_t, Location> index_;
+        std::map<uint64_t, std::shared_ptr<Segment>> segments_;
+        uint64_t next_segment_id_;
+
+        std::mutex mtx_append_access_;
+    };
+
+}
+
+#endif //FULL_NODE_BLOCKSTORE_H
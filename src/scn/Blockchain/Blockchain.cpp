@@ -20,13 +20,20 @@
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
 #include <set>
+#include <unordered_map>
 
 using namespace scn;
 
 
-Blockchain::Blockchain(const std::string& folder_path)
-:cache_(folder_path)
+Blockchain::Blockchain(const std::string& folder_path, uint64_t max_cache_memory_bytes)
+:cache_(folder_path, max_cache_memory_bytes)
+,verifier_()
+,verdict_cache_()
 ,folder_path_(folder_path)
+,sealed_epochs_(folder_path + "/sealed_epochs")
+,data_value_hashes_of_epoch_()
+,wallets_changed_(true)
+,data_value_hashes_of_epoch_changed_(true)
 ,current_meta_data_initialized_(false) {
     initEmptyChain();
 }
@@ -60,11 +67,13 @@ void Blockchain::importBlockchain(const std::string& folder_path) {
         return;
     }
 
-    auto baseline_block = std::static_pointer_cast<scn::BaselineBlock>(Cache::getExternalBlockFromDisk(folder_path, meta_data.root_block_id));
+    //the folder may belong to another node, it is only read
+    BlockStore store(folder_path, true);
+    auto baseline_block = std::static_pointer_cast<scn::BaselineBlock>(Cache::getExternalBlockFromDisk(folder_path, store, meta_data.root_block_id));
     setRootBlock(*baseline_block);
 
     for(block_uid_t i=meta_data.root_block_id+1;i<=meta_data.newest_block_id;i++) {
-        auto collection_block = std::static_pointer_cast<scn::CollectionBlock>(Cache::getExternalBlockFromDisk(folder_path, i));
+        auto collection_block = std::static_pointer_cast<scn::CollectionBlock>(Cache::getExternalBlockFromDisk(folder_path, store, i));
         addBlock(*collection_block);
     }
 }
@@ -73,45 +82,53 @@ const std::shared_ptr<BaseBlock> Blockchain::getBlock(block_uid_t uid) const {
     return cache_.getBlock(uid);
 }
 
+
+std::shared_ptr<const std::string> Blockchain::getEncodedBlock(block_uid_t uid, const Cache::encoder_t& encoder) const {
+    return cache_.getEncodedBlock(uid, encoder);
+}
+
 const std::shared_ptr<BaseBlock> Blockchain::getRootBlock() const {
-    MetaData meta = getMetaData();
-    return getBlock(meta.root_block_id);
+    return getBlock(getChainState()->root_block_id);
 }
 
 const std::shared_ptr<BaseBlock> Blockchain::getNewestBlock() const {
-    MetaData meta = getMetaData();
-    return getBlock(meta.newest_block_id);
+    return getBlock(getChainState()->newest_block_id);
 }
 
 block_uid_t Blockchain::getRootBlockId() const {
-    MetaData meta = getMetaData();
-    return meta.root_block_id;
+    return getChainState()->root_block_id;
 }
 
 
 block_uid_t Blockchain::getNewestBlockId() const {
-    MetaData meta = getMetaData();
-    return meta.newest_block_id;
+    return getChainState()->newest_block_id;
 }
 
 
 block_uid_t Blockchain::addBlock(const BaselineBlock& block) {
+    verdict_cache_.invalidate();
     auto this_block_id = cache_.addBlock(block);
     {
         LOCK_MUTEX_WATCHDOG(mtx_current_baseline_access_);
-        current_baseline_ = block;
+        current_baseline_.header = block.header;
         current_baseline_.header.generic_header.block_hash = 0;
+        current_baseline_.mining_state = block.mining_state;
+        setDataValueHashes(block.data_value_hashes);
+        wallets_.assign(block.wallets);
+        wallets_changed_ = true;
     }
 
     MetaData meta = getMetaData();
     meta.newest_block_id = this_block_id;
     setMetaData(meta);
-    
+    publishChainState();
+
     return this_block_id;
 }
 
 
 block_uid_t Blockchain::addBlock(const CollectionBlock& block) {
+    verdict_cache_.invalidate();
     auto this_block_id = cache_.addBlock(block);
     
     MetaData meta = getMetaData();
@@ -119,6 +136,7 @@ block_uid_t Blockchain::addBlock(const CollectionBlock& block) {
     setMetaData(meta);
 
     updateCurrentBaseline(block);
+    publishChainState();
 
     return this_block_id;
 }
@@ -140,6 +158,7 @@ void Blockchain::setRootBlock(const BaselineBlock& block) {
         meta.newest_block_id = block.header.block_uid;
         setMetaData(meta);
     }
+    publishChainState();
 }
 
 
@@ -154,10 +173,12 @@ block_uid_t Blockchain::establishBaseline() {
         cache_.resetCache(current_baseline_.header.block_uid);
         LOG(INFO) << "  reset cache done";
         google::FlushLogFiles(google::GLOG_INFO);
+        materializeBaseline();
         CryptoHelper::fillHash(current_baseline_);
         LOG(INFO) << "  filled hash";
         google::FlushLogFiles(google::GLOG_INFO);
         this_block_id = cache_.addBlock(current_baseline_);
+        releaseBaseline();
         LOG(INFO) << "New Baseline " << current_baseline_.header.block_uid << ": " << hash_helper::toString(current_baseline_.header.generic_header.block_hash);
         google::FlushLogFiles(google::GLOG_INFO);
         current_baseline_.header.generic_header.block_hash = 0;
@@ -170,32 +191,28 @@ block_uid_t Blockchain::establishBaseline() {
             setMetaData(meta);
         }
     }
+    publishChainState();
     return this_block_id;
 }
 
 
 uint64_t Blockchain::getBalance(const public_key_t& public_key) {
-    {
-        LOCK_MUTEX_WATCHDOG(mtx_current_baseline_access_);
-        auto it = current_baseline_.wallets.find(public_key);
-        if(it == current_baseline_.wallets.end()) {
-            return 0;
-        } else {
-            return it->second;
-        }
-    }
+    return getChainState()->wallets->getBalance(public_key);
 }
 
 
 uint64_t Blockchain::getNumWallets() const {
-    LOCK_MUTEX_WATCHDOG(mtx_current_baseline_access_);
-    return current_baseline_.wallets.size();
+    return getChainState()->wallets->size();
 }
 
 
 MiningState Blockchain::getMiningState() const {
-    LOCK_MUTEX_WATCHDOG(mtx_current_baseline_access_);
-    return current_baseline_.mining_state;
+    return getChainState()->mining_state;
+}
+
+
+std::shared_ptr<const Blockchain::ChainState> Blockchain::getChainState() const {
+    return std::atomic_load(&chain_state_);
 }
 
 
@@ -363,7 +380,8 @@ bool Blockchain::validateBlock(const CollectionBlock& block) {
     t0 = std::chrono::system_clock::now();
 
     //check block id
-    auto newest_block_in_chain = getNewestBlock();
+    auto chain_state = getChainState();
+    auto newest_block_in_chain = getBlock(chain_state->newest_block_id);
     if(block.header.block_uid == 0 || block.header.block_uid != newest_block_in_chain->header.block_uid + 1) {
         LOG(ERROR) << "validateBlock: block uid invalid: " << block.header.block_uid << " - expected: " << newest_block_in_chain->header.block_uid + 1;
         return false;
@@ -385,38 +403,59 @@ bool Blockchain::validateBlock(const CollectionBlock& block) {
 
     t2 = std::chrono::system_clock::now();
 
-    //check every transaction
+    //check every transaction (hash and signature checks are independent, so they run in parallel)
+    //sub-blocks already verified on top of the same newest block (e.g. by a previous propagation of a candidate block) are skipped
+    const hash_t& newest_block_hash = newest_block_in_chain->header.generic_header.block_hash;
+    std::vector<const TransactionSubBlock*> transactions_to_check;
+    transactions_to_check.reserve(block.transactions.size());
     for(auto& transaction : block.transactions) {
-        if(!validateSubBlock(transaction.second, *newest_block_in_chain)) {
-            LOG(ERROR) << "validateBlock: transaction invalid";
-            return false;
+        if(!verdict_cache_.isVerified(transaction.second, newest_block_hash)) {
+            transactions_to_check.push_back(&transaction.second);
         }
     }
+    if(verifier_.verify(transactions_to_check.size(), [&](uint32_t index) {
+            return validateSubBlock(*transactions_to_check[index], *newest_block_in_chain);
+        }) != transactions_to_check.size()) {
+        LOG(ERROR) << "validateBlock: transaction invalid";
+        return false;
+    }
+    for(auto transaction : transactions_to_check) {
+        verdict_cache_.setVerified(*transaction, newest_block_hash);
+    }
 
     t3 = std::chrono::system_clock::now();
 
     //check every creation
-    auto mining_state = getMiningState();
+    auto mining_state = chain_state->mining_state;
     hash_t max_allowed_hash, min_allowed_hash;
     getHashArea(mining_state.epoch, max_allowed_hash, min_allowed_hash);
-    std::vector<hash_t> data_value_hashes_of_epoch;
-    {
-        LOCK_MUTEX_WATCHDOG(mtx_current_baseline_access_);
-        if(current_baseline_.data_value_hashes.size() > 0) {
-            data_value_hashes_of_epoch = current_baseline_.data_value_hashes.back();
-        }
-    }
+    const auto& data_value_hashes_of_epoch = *chain_state->data_value_hashes_of_epoch;
+    std::vector<const CreationSubBlock*> creations_to_check;
+    std::vector<const std::string*> data_values_to_check;
+    creations_to_check.reserve(block.creations.size());
+    data_values_to_check.reserve(block.creations.size());
     for(auto& creation : block.creations) {
-        if(!validateSubBlock(creation.second,
-                             *newest_block_in_chain,
-                             mining_state,
-                             max_allowed_hash,
-                             min_allowed_hash,
-                             data_value_hashes_of_epoch)) {
-            LOG(ERROR) << "validateBlock: creation invalid";
-            return false;
+        if(!verdict_cache_.isVerified(creation.second, newest_block_hash)) {
+            creations_to_check.push_back(&creation.second);
+            data_values_to_check.push_back(&creation.second.data_value);
         }
     }
+    auto data_value_hashes_to_check = CryptoHelper::calcHashBatch(data_values_to_check);
+    if(verifier_.verify(creations_to_check.size(), [&](uint32_t index) {
+            return validateSubBlock(*creations_to_check[index],
+                                    data_value_hashes_to_check[index],
+                                    *newest_block_in_chain,
+                                    mining_state,
+                                    max_allowed_hash,
+                                    min_allowed_hash,
+                                    data_value_hashes_of_epoch);
+        }) != creations_to_check.size()) {
+        LOG(ERROR) << "validateBlock: creation invalid";
+        return false;
+    }
+    for(auto creation : creations_to_check) {
+        verdict_cache_.setVerified(*creation, newest_block_hash);
+    }
 
     t4 = std::chrono::system_clock::now();
 
@@ -469,7 +508,7 @@ bool Blockchain::validateBlock(const CollectionBlock& block) {
     //check that every wallet's balance is >= 0
     {
         //calculate resulting balance for all wallets which have creations or transactions in this block
-        std::map<public_key_t, int64_t> wallet_diffs; //NOTE: use signed integer here to detect negative balance values
+        std::unordered_map<public_key_t, int64_t> wallet_diffs; //NOTE: use signed integer here to detect negative balance values
         for(auto& creation : block.creations) {
             wallet_diffs[creation.second.creator] += TransactionSubBlock::fraction_per_coin;
         }
@@ -477,17 +516,25 @@ bool Blockchain::validateBlock(const CollectionBlock& block) {
             wallet_diffs[transaction.second.pre_owner] -= transaction.second.fraction;
             wallet_diffs[transaction.second.post_owner] += transaction.second.fraction;
         }
+        bool balances_valid = true;
         {
             LOCK_MUTEX_WATCHDOG(mtx_current_baseline_access_);
             for (auto& wallet_diff : wallet_diffs) {
-                if (wallet_diff.second < 0 && wallet_diff.second + static_cast<int64_t>(current_baseline_.wallets[wallet_diff.first]) < 0) {
+                //NOTE: creates an empty wallet for an unknown debtor, which is part of the baseline content
+                if (wallet_diff.second < 0 && wallet_diff.second + static_cast<int64_t>(wallets_[wallet_diff.first]) < 0) {
                     LOG(ERROR) << "validateBlock: wallet's balance is invalid: "
-                               << wallet_diff.second + static_cast<int64_t>(current_baseline_.wallets[wallet_diff.first])
+                               << wallet_diff.second + static_cast<int64_t>(wallets_[wallet_diff.first])
                                << " - " << wallet_diff.first.getAsShortString();
-                    return false;
+                    wallets_changed_ = true;
+                    balances_valid = false;
+                    break;
                 }
             }
         }
+        if(!balances_valid) {
+            publishChainState();
+            return false;
+        }
     }
 
     t9 = std::chrono::system_clock::now();
@@ -501,14 +548,26 @@ bool Blockchain::validateBlock(const CollectionBlock& block) {
               (std::chrono::duration_cast<std::chrono::milliseconds>(t6 - t5)).count() << " t67:" <<
               (std::chrono::duration_cast<std::chrono::milliseconds>(t7 - t6)).count() << " t78:" <<
               (std::chrono::duration_cast<std::chrono::milliseconds>(t8 - t7)).count() << " t89:" <<
-              (std::chrono::duration_cast<std::chrono::milliseconds>(t9 - t8)).count();
+              (std::chrono::duration_cast<std::chrono::milliseconds>(t9 - t8)).count() << " verified sub-blocks:" <<
+              transactions_to_check.size() + creations_to_check.size() << "/" <<
+              block.transactions.size() + block.creations.size() << " verdict cache hit rate:" <<
+              verdict_cache_.hitRate();
 
     return true;
 }
 
 
 bool Blockchain::validateSubBlock(const TransactionSubBlock& sub_block) {
-    return validateSubBlock(sub_block, *getNewestBlock());
+    auto newest_block_in_chain = getNewestBlock();
+    const hash_t& newest_block_hash = newest_block_in_chain->header.generic_header.block_hash;
+    if(verdict_cache_.isVerified(sub_block, newest_block_hash)) {
+        return true;
+    }
+    if(!validateSubBlock(sub_block, *newest_block_in_chain)) {
+        return false;
+    }
+    verdict_cache_.setVerified(sub_block, newest_block_hash);
+    return true;
 }
 
 
@@ -562,31 +621,80 @@ bool Blockchain::validateSubBlock(const TransactionSubBlock& sub_block, BaseBloc
 
 
 bool Blockchain::validateSubBlock(const CreationSubBlock& sub_block) {
-    auto mining_state = getMiningState();
+    auto chain_state = getChainState();
+    auto newest_block_in_chain = getBlock(chain_state->newest_block_id);
+    const hash_t& newest_block_hash = newest_block_in_chain->header.generic_header.block_hash;
+    if(verdict_cache_.isVerified(sub_block, newest_block_hash)) {
+        return true;
+    }
+    auto mining_state = chain_state->mining_state;
     hash_t max_allowed_hash, min_allowed_hash;
     getHashArea(mining_state.epoch, max_allowed_hash, min_allowed_hash);
-    std::vector<hash_t> data_value_hashes_of_epoch;
-    {
-        LOCK_MUTEX_WATCHDOG(mtx_current_baseline_access_);
-        if(current_baseline_.data_value_hashes.size() > 0) {
-            data_value_hashes_of_epoch = current_baseline_.data_value_hashes.back();
+    if(!validateSubBlock(sub_block,
+                         CryptoHelper::calcHash(sub_block.data_value),
+                         *newest_block_in_chain,
+                         mining_state,
+                         max_allowed_hash,
+                         min_allowed_hash,
+                         *chain_state->data_value_hashes_of_epoch)) {
+        return false;
+    }
+    verdict_cache_.setVerified(sub_block, newest_block_hash);
+    return true;
+}
+
+
+std::vector<bool> Blockchain::validateSubBlocks(const std::vector<const CreationSubBlock*>& sub_blocks) {
+    auto chain_state = getChainState();
+    auto newest_block_in_chain = getBlock(chain_state->newest_block_id);
+    const hash_t& newest_block_hash = newest_block_in_chain->header.generic_header.block_hash;
+    auto mining_state = chain_state->mining_state;
+    hash_t max_allowed_hash, min_allowed_hash;
+    getHashArea(mining_state.epoch, max_allowed_hash, min_allowed_hash);
+    const auto& data_value_hashes_of_epoch = *chain_state->data_value_hashes_of_epoch;
+
+    std::vector<const std::string*> data_values;
+    data_values.reserve(sub_blocks.size());
+    for(auto sub_block : sub_blocks) {
+        data_values.push_back(&sub_block->data_value);
+    }
+    auto data_value_hashes = CryptoHelper::calcHashBatch(data_values);
+
+    //every sub block gets its own verdict, so no check fails from the verifier's point of view
+    std::vector<uint8_t> verdicts(sub_blocks.size(), 0);
+    verifier_.verify(sub_blocks.size(), [&](uint32_t index) {
+        if(verdict_cache_.isVerified(*sub_blocks[index], newest_block_hash)) {
+            verdicts[index] = 1;
+            return true;
+        }
+        verdicts[index] = validateSubBlock(*sub_blocks[index],
+                                           data_value_hashes[index],
+                                           *newest_block_in_chain,
+                                           mining_state,
+                                           max_allowed_hash,
+                                           min_allowed_hash,
+                                           data_value_hashes_of_epoch) ? 1 : 0;
+        return true;
+    });
+
+    std::vector<bool> result(sub_blocks.size());
+    for(uint32_t i=0;i<sub_blocks.size();i++) {
+        result[i] = (verdicts[i] != 0);
+        if(result[i]) {
+            verdict_cache_.setVerified(*sub_blocks[i], newest_block_hash);
         }
     }
-    return validateSubBlock(sub_block,
-                            *getNewestBlock(),
-                            mining_state,
-                            max_allowed_hash,
-                            min_allowed_hash,
-                            data_value_hashes_of_epoch);
+    return result;
 }
 
 
 bool Blockchain::validateSubBlock(const CreationSubBlock& sub_block,
+                                  const hash_t& data_value_hash,
                                   BaseBlock& newest_block_in_chain,
                                   MiningState& mining_state,
                                   hash_t& max_allowed_hash,
                                   hash_t& min_allowed_hash,
-                                  std::vector<hash_t>& data_value_hashes_of_epoch) {
+                                  const EpochHashSet& data_value_hashes_of_epoch) {
     //check if block is valid and fits to new block in current blockchain
 
     //check block type
@@ -624,7 +732,6 @@ bool Blockchain::validateSubBlock(const CreationSubBlock& sub_block,
     }
 
     //check data value hash area
-    hash_t data_value_hash = CryptoHelper::calcHash(sub_block.data_value);
     if(data_value_hash < min_allowed_hash || data_value_hash > max_allowed_hash) {
         LOG(ERROR) << "validateSubBlock: Data value hash area mismatch!" << std::endl << hash_helper::toString(data_value_hash) << std::endl << sub_block.data_value << std::endl << "min/max:" << hash_helper::toString(min_allowed_hash) << "/" << hash_helper::toString(max_allowed_hash);
         return false;
@@ -637,7 +744,7 @@ bool Blockchain::validateSubBlock(const CreationSubBlock& sub_block,
     }
 
     //check if data_value is already in blockchain
-    if(std::binary_search(data_value_hashes_of_epoch.begin(), data_value_hashes_of_epoch.end(), data_value_hash)) {
+    if(data_value_hashes_of_epoch.contains(data_value_hash)) {
         LOG(ERROR) << "validateSubBlock: data_value already found in blockchain: " << hash_helper::toString(data_value_hash);
         return false;
     }
@@ -647,25 +754,26 @@ bool Blockchain::validateSubBlock(const CreationSubBlock& sub_block,
 
 
 void Blockchain::getHashArea(const epoch_t& epoch, hash_t& max_allowed_hash, hash_t& min_allowed_hash) {
-    boost::multiprecision::uint512_t temp = std::numeric_limits<boost::multiprecision::uint256_t>::max();
-    for(epoch_t i=0;i<epoch;i++)
-    {
-        temp = temp *
-               boost::multiprecision::uint512_t(1000000000000000ul) /
-               boost::multiprecision::uint512_t(1001776032062287ul);
-    }
-    max_allowed_hash = boost::multiprecision::uint256_t(temp);
-    min_allowed_hash = std::min(boost::multiprecision::uint256_t(
-            boost::multiprecision::uint512_t(max_allowed_hash) *
-            boost::multiprecision::uint512_t(1000000000000000ul) /
-            boost::multiprecision::uint512_t(1001776032062287ul)) + 1, max_allowed_hash);
+    HashAreaTable::getInstance().getHashArea(epoch, max_allowed_hash, min_allowed_hash);
 }
 
 
 void Blockchain::writeCurrentBaselineToFile(const std::string& filename) {
     LOCK_MUTEX_WATCHDOG(mtx_current_baseline_access_);
     std::ofstream ofs(filename);
+    materializeBaseline();
     ofs << current_baseline_;
+    releaseBaseline();
+}
+
+
+const SubBlockVerdictCache& Blockchain::getSubBlockVerdictCache() const {
+    return verdict_cache_;
+}
+
+
+const Cache& Blockchain::getCache() const {
+    return cache_;
 }
 
 
@@ -715,17 +823,26 @@ void Blockchain::updateCurrentBaseline(const CollectionBlock& block) {
 
     assert(current_baseline_.data_value_hashes.size() == current_baseline_.mining_state.epoch+1);
     current_baseline_.data_value_hashes[current_baseline_.mining_state.epoch].reserve(CollectionBlock::max_num_creations);
+    std::vector<const std::string*> data_values;
+    data_values.reserve(block.creations.size());
     for(auto& creation : block.creations) {
-        auto data_value_hash = CryptoHelper::calcHash(creation.second.data_value);
-        current_baseline_.data_value_hashes[current_baseline_.mining_state.epoch].push_back(data_value_hash);
-        current_baseline_.wallets[creation.second.creator] += TransactionSubBlock::fraction_per_coin;
+        data_values.push_back(&creation.second.data_value);
+        wallets_[creation.second.creator] += TransactionSubBlock::fraction_per_coin;
+        wallets_changed_ = true;
+    }
+    if(!data_values.empty()) {
+        auto data_value_hashes = CryptoHelper::calcHashBatch(data_values);
+        data_value_hashes_of_epoch_.insert(data_value_hashes);
+        data_value_hashes_of_epoch_changed_ = true;
+        EpochHashSet::mergeBatch(current_baseline_.data_value_hashes[current_baseline_.mining_state.epoch], std::move(data_value_hashes));
     }
-    std::sort(current_baseline_.data_value_hashes[current_baseline_.mining_state.epoch].begin(), current_baseline_.data_value_hashes[current_baseline_.mining_state.epoch].end());
 
     for(auto& transaction : block.transactions) {
-        assert(current_baseline_.wallets[transaction.second.pre_owner] >= transaction.second.fraction);
-        current_baseline_.wallets[transaction.second.pre_owner] -= transaction.second.fraction;
-        current_baseline_.wallets[transaction.second.post_owner] += transaction.second.fraction;
+        auto& pre_owner_balance = wallets_[transaction.second.pre_owner];
+        assert(pre_owner_balance >= transaction.second.fraction);
+        pre_owner_balance -= transaction.second.fraction;
+        wallets_[transaction.second.post_owner] += transaction.second.fraction;
+        wallets_changed_ = true;
     }
 
     current_baseline_.mining_state.highest_hash_of_current_epoch = current_baseline_.data_value_hashes[current_baseline_.mining_state.epoch].size() > 0 ?
@@ -737,7 +854,86 @@ void Blockchain::updateCurrentBaseline(const CollectionBlock& block) {
         current_baseline_.mining_state.highest_hash_of_last_epoch = current_baseline_.mining_state.highest_hash_of_current_epoch;
         current_baseline_.mining_state.highest_hash_of_current_epoch = 0;
         current_baseline_.data_value_hashes.resize(current_baseline_.mining_state.epoch + 1);
+        data_value_hashes_of_epoch_ = EpochHashSet();
+        data_value_hashes_of_epoch_changed_ = true;
+        sealCompletedEpochs();
+    }
+}
+
+
+void Blockchain::setDataValueHashes(const std::vector<std::vector<hash_t>>& data_value_hashes) {
+    auto num_sealed_epochs = data_value_hashes.empty() ? 0 : data_value_hashes.size() - 1;
+    if(!sealed_epochs_.assign(data_value_hashes, num_sealed_epochs)) {
+        LOG(ERROR) << "Blockchain: could not seal epochs, " << num_sealed_epochs - sealed_epochs_.numEpochs() << " are kept in RAM";
+    }
+    current_baseline_.data_value_hashes.clear();
+    current_baseline_.data_value_hashes.resize(data_value_hashes.size());
+    for(epoch_t epoch=sealed_epochs_.numEpochs();epoch<data_value_hashes.size();epoch++) {
+        current_baseline_.data_value_hashes[epoch] = data_value_hashes[epoch];
+    }
+    data_value_hashes_of_epoch_ = EpochHashSet(data_value_hashes.empty() ? std::vector<hash_t>() : data_value_hashes.back());
+    data_value_hashes_of_epoch_changed_ = true;
+}
+
+
+void Blockchain::sealCompletedEpochs() {
+    if(sealed_epochs_.numEpochs() > current_baseline_.mining_state.epoch) {
+        LOG(FATAL) << "Blockchain: " << sealed_epochs_.numEpochs() << " sealed epochs but only "
+                   << current_baseline_.mining_state.epoch << " completed epochs";
+    }
+    for(epoch_t epoch=sealed_epochs_.numEpochs();epoch<current_baseline_.mining_state.epoch;epoch++) {
+        auto& hashes = current_baseline_.data_value_hashes[epoch];
+        bool sealed = sealed_epochs_.appendEpoch(hashes);
+        if(sealed_epochs_.numEpochs() < epoch) {
+            //the RAM copies of these epochs are already released
+            LOG(FATAL) << "Blockchain: sealed epochs lost, " << sealed_epochs_.numEpochs() << " of " << epoch << " left";
+        }
+        if(!sealed) {
+            LOG(ERROR) << "Blockchain: could not seal epoch " << epoch << ", it is kept in RAM";
+            return;
+        }
+        std::vector<hash_t>().swap(hashes);
+    }
+}
+
+
+void Blockchain::materializeBaseline() {
+    current_baseline_.wallets = wallets_.toOrderedMap();
+    for(epoch_t epoch=0;epoch<sealed_epochs_.numEpochs();epoch++) {
+        current_baseline_.data_value_hashes[epoch] = sealed_epochs_.getEpoch(epoch);
+    }
+}
+
+
+void Blockchain::releaseBaseline() {
+    current_baseline_.wallets.clear();
+    for(epoch_t epoch=0;epoch<sealed_epochs_.numEpochs();epoch++) {
+        std::vector<hash_t>().swap(current_baseline_.data_value_hashes[epoch]);
+    }
+}
+
+
+void Blockchain::publishChainState() {
+    auto chain_state = std::make_shared<ChainState>();
+    {
+        LOCK_MUTEX_WATCHDOG(mtx_current_baseline_access_);
+        auto meta = getMetaData();
+        chain_state->root_block_id = meta.root_block_id;
+        chain_state->newest_block_id = meta.newest_block_id;
+        chain_state->mining_state = current_baseline_.mining_state;
+        //copies only share the shards (see WalletTable), blocks without creations and transactions even share the tables
+        if(wallets_changed_ || !published_wallets_) {
+            published_wallets_ = std::make_shared<const WalletTable>(wallets_);
+            wallets_changed_ = false;
+        }
+        chain_state->wallets = published_wallets_;
+        if(data_value_hashes_of_epoch_changed_ || !published_data_value_hashes_of_epoch_) {
+            published_data_value_hashes_of_epoch_ = std::make_shared<const EpochHashSet>(data_value_hashes_of_epoch_);
+            data_value_hashes_of_epoch_changed_ = false;
+        }
+        chain_state->data_value_hashes_of_epoch = published_data_value_hashes_of_epoch_;
     }
+    std::atomic_store(&chain_state_, std::shared_ptr<const ChainState>(chain_state));
 }
 
 
@@ -20,6 +20,12 @@
 #include "scn/Common/Common.h"
 #include "BlockDefinitions.h"
 #include "Cache.h"
+#include "ParallelVerifier.h"
+#include "SubBlockVerdictCache.h"
+#include "HashAreaTable.h"
+#include "WalletTable.h"
+#include "EpochHashSet.h"
+#include "SealedEpochStore.h"
 #include "scn/CryptoHelper/CryptoHelper.h"
 #include <mutex>
 
@@ -28,7 +34,17 @@ namespace scn {
     class Blockchain {
     public:
 
-        explicit Blockchain(const std::string& folder_path);
+        //immutable state of the chain, published after every change of the chain
+        //readers keep a snapshot as long as they need it and are never blocked by a writer
+        struct ChainState {
+            block_uid_t root_block_id;
+            block_uid_t newest_block_id;
+            MiningState mining_state;
+            std::shared_ptr<const WalletTable> wallets;
+            std::shared_ptr<const EpochHashSet> data_value_hashes_of_epoch; //current epoch only
+        };
+
+        explicit Blockchain(const std::string& folder_path, uint64_t max_cache_memory_bytes = Cache::default_max_memory_bytes);
 
         virtual ~Blockchain();
 
@@ -38,6 +54,9 @@ namespace scn {
 
         virtual const std::shared_ptr<BaseBlock> getBlock(block_uid_t uid) const;
 
+        //see Cache::getEncodedBlock
+        virtual std::shared_ptr<const std::string> getEncodedBlock(block_uid_t uid, const Cache::encoder_t& encoder) const;
+
         virtual const std::shared_ptr<BaseBlock> getRootBlock() const;
 
         virtual const std::shared_ptr<BaseBlock> getNewestBlock() const;
@@ -60,6 +79,8 @@ namespace scn {
 
         virtual MiningState getMiningState() const;
 
+        std::shared_ptr<const ChainState> getChainState() const;
+
         bool validateBlock(const BaselineBlock& block);
 
         static bool validateBlockWithoutContext(const BaselineBlock& block);
@@ -70,10 +91,18 @@ namespace scn {
 
         bool validateSubBlock(const CreationSubBlock& sub_block);
 
+        //validates many creations at once (one snapshot of the epoch state, batch hashing, parallel checks)
+        //returns one verdict per sub block, duplicates inside sub_blocks are not detected
+        std::vector<bool> validateSubBlocks(const std::vector<const CreationSubBlock*>& sub_blocks);
+
         static void getHashArea(const epoch_t& epoch, hash_t& max_allowed_hash, hash_t& min_allowed_hash);
 
         void writeCurrentBaselineToFile(const std::string& filename);
 
+        const SubBlockVerdictCache& getSubBlockVerdictCache() const;
+
+        const Cache& getCache() const;
+
     protected:
 
         struct MetaData {
@@ -91,11 +120,12 @@ namespace scn {
         bool validateSubBlock(const TransactionSubBlock& sub_block, BaseBlock& newest_block_in_chain);
 
         bool validateSubBlock(const CreationSubBlock& sub_block,
+                              const hash_t& data_value_hash,
                               BaseBlock& newest_block_in_chain,
                               MiningState& mining_state,
                               hash_t& max_allowed_hash,
                               hash_t& min_allowed_hash,
-                              std::vector<hash_t>& data_value_hashes_of_epoch);
+                              const EpochHashSet& data_value_hashes_of_epoch);
 
         virtual MetaData getMetaData() const;
 
@@ -105,11 +135,39 @@ namespace scn {
 
         void updateCurrentBaseline(const CollectionBlock& block);
 
+        //takes over the data value hashes of a baseline, all epochs except the last one are sealed
+        void setDataValueHashes(const std::vector<std::vector<hash_t>>& data_value_hashes);
+
+        //moves completed epochs which are still in RAM to sealed_epochs_, if writing fails they stay in RAM and
+        //are sealed together with the next completed epoch
+        void sealCompletedEpochs();
+
+        //fills current_baseline_.wallets and the sealed epochs of current_baseline_.data_value_hashes while the
+        //baseline is serialized, releaseBaseline() empties them again
+        //NOTE: this copies all sealed epochs into RAM for the duration of the serialization
+        void materializeBaseline();
+
+        void releaseBaseline();
+
+        //makes the current state visible to readers (called by writers after every change)
+        void publishChainState();
+
         Cache cache_;
+        ParallelVerifier verifier_;
+        SubBlockVerdictCache verdict_cache_;
         const std::string folder_path_;
 
         mutable std::mutex mtx_current_baseline_access_;
-        BaselineBlock current_baseline_;
+        BaselineBlock current_baseline_; //wallets are kept in wallets_ and completed epochs in sealed_epochs_
+        WalletTable wallets_;
+        SealedEpochStore sealed_epochs_; //vectors of these epochs in current_baseline_.data_value_hashes stay empty, see sealCompletedEpochs()
+        EpochHashSet data_value_hashes_of_epoch_; //current_baseline_.data_value_hashes of the current epoch
+        std::shared_ptr<const WalletTable> published_wallets_; //wallets_ at the last publishChainState()
+        bool wallets_changed_;
+        std::shared_ptr<const EpochHashSet> published_data_value_hashes_of_epoch_; //data_value_hashes_of_epoch_ at the last publishChainState()
+        bool data_value_hashes_of_epoch_changed_;
+
+        std::shared_ptr<const ChainState> chain_state_; //only accessed by std::atomic_load/std::atomic_store
 
         mutable MetaData current_meta_data_;
         bool current_meta_data_initialized_;
@@ -16,6 +16,8 @@
 
 #include "Cache.h"
 #include <fstream>
+#include <algorithm>
+#include <sstream>
 #include <cereal/archives/portable_binary.hpp>
 #include <boost/filesystem.hpp>
 #ifdef _WIN32
@@ -25,12 +27,45 @@
 using namespace scn;
 
 
-Cache::Cache(const std::string& folder_path)
+const uint64_t Cache::default_max_memory_bytes;
+const uint32_t Cache::num_hot_newest_blocks;
+const uint32_t Cache::flush_batch_size;
+const uint32_t Cache::flush_interval_ms;
+const uint32_t Cache::min_sequential_accesses;
+const uint32_t Cache::max_stream_gap;
+const uint32_t Cache::max_num_streams;
+const uint32_t Cache::read_ahead_blocks;
+constexpr double Cache::protected_share;
+constexpr double Cache::max_block_share;
+
+
+Cache::Cache(const std::string& folder_path, uint64_t max_memory_bytes)
 :folder_path_(folder_path)
+,max_memory_bytes_(max_memory_bytes)
+,block_store_(folder_path)
 ,next_free_block_id_(1)
+,cached_blocks_()
+,probationary_lru_()
+,protected_lru_()
+,probationary_bytes_(0)
+,protected_bytes_(0)
+,dirty_blocks_()
+,reset_counter_(0)
+,num_hits_(0)
+,num_misses_(0)
+,num_evictions_(0)
+,num_encoded_block_hits_(0)
+,num_read_ahead_blocks_(0)
+,flush_requested_(false)
+,streams_()
+,read_ahead_queue_()
+,read_ahead_queued_()
+,read_ahead_in_progress_(0)
 ,running_(true)
-,cache_thread_(&Cache::cacheThread, this) {
+,cache_thread_(&Cache::cacheThread, this)
+,read_ahead_thread_(&Cache::readAheadThread, this) {
     boost::filesystem::create_directories(folder_path_);
+    removeLegacyBlockFiles();
 
 #ifdef _WIN32
     SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
@@ -43,60 +78,260 @@ Cache::Cache(const std::string& folder_path)
 
 
 Cache::~Cache() {
-    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(mtx_flush_signal_);
+        running_ = false;
+    }
+    {
+        //the read-ahead thread either still sees running_ or is already waiting for this notification
+        std::lock_guard<std::mutex> lock(mtx_read_ahead_);
+    }
+    cv_flush_.notify_one();
+    cv_read_ahead_.notify_one();
     cache_thread_.join();
+    read_ahead_thread_.join();
 }
 
 
 std::shared_ptr<BaseBlock> Cache::getBlock(block_uid_t uid) const {
+    if(uid == 0) {
+        return nullptr;
+    }
+
+    std::shared_ptr<BaseBlock> cached_block;
+    uint64_t reset_counter;
+    {
+        LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+        auto cached_blocks_entry = cached_blocks_.find(uid);
+        if(cached_blocks_entry != cached_blocks_.end()) {
+            num_hits_++;
+            touch(uid, cached_blocks_entry->second);
+            cached_block = cached_blocks_entry->second.block;
+        } else {
+            num_misses_++;
+        }
+        reset_counter = reset_counter_;
+    }
+    detectSequentialAccess(uid);
+    if(cached_block) {
+        return cached_block;
+    }
+
+    {
+        //take over the block if it is still queued for reading ahead, wait for it if it is being read right now
+        std::unique_lock<std::mutex> lock(mtx_read_ahead_);
+        read_ahead_queued_.erase(uid);
+        if(read_ahead_in_progress_ == uid) {
+            cv_read_ahead_done_.wait_for(lock, std::chrono::seconds(1), [this, uid]() {
+                return read_ahead_in_progress_ != uid;
+            });
+        }
+    }
     {
         LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
-        auto cached_block = cached_blocks_.find(uid);
-        if(cached_block != cached_blocks_.end()) {
-            return cached_block->second;
+        auto cached_blocks_entry = cached_blocks_.find(uid);
+        if(cached_blocks_entry != cached_blocks_.end()) {
+            return cached_blocks_entry->second.block;
         }
     }
-    return getBlockFromDisk(uid);
+
+    auto data = block_store_.read(uid);
+    if(!data) {
+        return nullptr;
+    }
+    auto block = deserializeBlock(*data);
+    if(block) {
+        cacheReadBlock(uid, block, data->size(), reset_counter, false);
+    }
+    return block;
 }
 
 
-block_uid_t Cache::addBlock(const BaselineBlock& block) {
-    auto this_block_id = next_free_block_id_;
-    assert(this_block_id == block.header.block_uid);
-    auto block_to_cache = std::make_shared<BaselineBlock>(block);
+std::shared_ptr<const std::string> Cache::getEncodedBlock(block_uid_t uid, const encoder_t& encoder) const {
+    std::shared_ptr<const std::string> encoded_block;
+    {
+        LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+        auto cached_blocks_entry = cached_blocks_.find(uid);
+        if(cached_blocks_entry != cached_blocks_.end() && cached_blocks_entry->second.encoded_block) {
+            num_hits_++;
+            num_encoded_block_hits_++;
+            touch(uid, cached_blocks_entry->second);
+            encoded_block = cached_blocks_entry->second.encoded_block;
+        }
+    }
+    if(encoded_block) {
+        detectSequentialAccess(uid);
+        return encoded_block;
+    }
+
+    auto block = getBlock(uid);
+    if(!block) {
+        return nullptr;
+    }
+    encoded_block = std::make_shared<const std::string>(encoder(*block));
+
     {
         LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
-        cached_blocks_[this_block_id] = block_to_cache;
+        auto cached_blocks_entry = cached_blocks_.find(uid);
+        if(cached_blocks_entry != cached_blocks_.end() && cached_blocks_entry->second.block == block) {
+            auto& entry = cached_blocks_entry->second;
+            if(entry.encoded_block) {
+                return entry.encoded_block; //encoded concurrently
+            }
+            if(entry.dirty) {
+                //dirty blocks are charged (or lose the encoded form) when they are written
+                entry.encoded_block = encoded_block;
+            } else if(isCacheable(entry.size + encoded_block->size())) {
+                entry.encoded_block = encoded_block;
+                entry.size += encoded_block->size();
+                (entry.is_protected ? protected_bytes_ : probationary_bytes_) += encoded_block->size();
+                evict();
+            }
+        }
+    }
+    return encoded_block;
+}
+
+
+void Cache::detectSequentialAccess(block_uid_t uid) const {
+    std::lock_guard<std::mutex> lock(mtx_read_ahead_);
+    auto stream = std::find_if(streams_.begin(), streams_.end(), [uid](const Stream& stream) {
+        return stream.last_uid < uid && uid <= stream.last_uid + max_stream_gap;
+    });
+
+    if(stream == streams_.end()) {
+        bool inside_stream = std::any_of(streams_.begin(), streams_.end(), [uid](const Stream& stream) {
+            return uid <= stream.last_uid && uid + max_stream_gap > stream.last_uid;
+        });
+        if(!inside_stream) {
+            if(streams_.size() >= max_num_streams) {
+                streams_.erase(streams_.begin());
+            }
+            streams_.push_back({uid, 1, uid});
+        }
+        return;
+    }
+
+    auto advanced_stream = *stream;
+    streams_.erase(stream);
+    advanced_stream.last_uid = uid;
+    advanced_stream.num_accesses++;
+
+    //streams caught up by this one are merged into it
+    for(auto other_stream = streams_.begin(); other_stream != streams_.end();) {
+        if(other_stream->last_uid <= uid && other_stream->last_uid + max_stream_gap > uid) {
+            advanced_stream.num_accesses = std::max(advanced_stream.num_accesses, other_stream->num_accesses);
+            advanced_stream.read_ahead_up_to = std::max(advanced_stream.read_ahead_up_to, other_stream->read_ahead_up_to);
+            other_stream = streams_.erase(other_stream);
+        } else {
+            ++other_stream;
+        }
+    }
+
+    //blocks are queued in chunks of half the read-ahead distance
+    if(advanced_stream.num_accesses >= min_sequential_accesses &&
+       advanced_stream.read_ahead_up_to < uid + read_ahead_blocks / 2) {
+        auto last_uid_to_read = std::min<block_uid_t>(uid + read_ahead_blocks, next_free_block_id_ - 1);
+        for(auto uid_to_read = std::max(advanced_stream.read_ahead_up_to, uid) + 1; uid_to_read <= last_uid_to_read; uid_to_read++) {
+            if(read_ahead_queued_.insert(uid_to_read).second) {
+                read_ahead_queue_.push_back(uid_to_read);
+            }
+        }
+        advanced_stream.read_ahead_up_to = uid + read_ahead_blocks;
+        cv_read_ahead_.notify_one();
+    }
+    streams_.push_back(advanced_stream);
+}
+
+
+void Cache::cacheReadBlock(block_uid_t uid, const std::shared_ptr<BaseBlock>& block, uint64_t size, uint64_t reset_counter, bool read_ahead) const {
+    LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+    if(reset_counter == reset_counter_ && isCacheable(size) && cached_blocks_.find(uid) == cached_blocks_.end()) {
+        probationary_lru_.push_front(uid);
+        cached_blocks_[uid] = {block, size, false, false, read_ahead, nullptr, probationary_lru_.begin()};
+        probationary_bytes_ += size;
+        evict();
     }
-    next_free_block_id_++;
-    return this_block_id;
+}
+
+
+block_uid_t Cache::addBlock(const BaselineBlock& block) {
+    return addBlockToCache(block);
 }
 
 
 block_uid_t Cache::addBlock(const CollectionBlock& block) {
-    auto this_block_id = next_free_block_id_;
-    assert(this_block_id == block.header.block_uid);
-    auto block_to_cache = std::make_shared<CollectionBlock>(block);
+    return addBlockToCache(block);
+}
+
+
+template<class BLOCK>
+block_uid_t Cache::addBlockToCache(const BLOCK& block) {
+    auto block_to_cache = std::make_shared<BLOCK>(block);
+    block_uid_t this_block_id;
+    bool flush_now;
     {
         LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
-        cached_blocks_[this_block_id] = block_to_cache;
+        this_block_id = next_free_block_id_;
+        assert(this_block_id == block.header.block_uid);
+        auto cached_block = cached_blocks_.find(this_block_id);
+        if(cached_block == cached_blocks_.end()) {
+            dirty_blocks_.push_back(this_block_id);
+        } else if(!cached_block->second.dirty) {
+            auto& entry = cached_block->second;
+            (entry.is_protected ? protected_bytes_ : probationary_bytes_) -= entry.size;
+            (entry.is_protected ? protected_lru_ : probationary_lru_).erase(entry.lru_position);
+            dirty_blocks_.push_back(this_block_id);
+        }
+        cached_blocks_[this_block_id] = {block_to_cache, 0, true, false, false, nullptr, {}};
+        next_free_block_id_++;
+        evict(); //the oldest block just left the hot set
+        flush_now = dirty_blocks_.size() >= flush_batch_size;
+    }
+
+    if(flush_now) {
+        {
+            std::lock_guard<std::mutex> lock(mtx_flush_signal_);
+            flush_requested_ = true;
+        }
+        cv_flush_.notify_one();
     }
-    next_free_block_id_++;
     return this_block_id;
 }
 
 
-std::shared_ptr<BaseBlock> Cache::getBlockFromDisk(block_uid_t uid) const {
+void Cache::flush() {
+    LOCK_MUTEX_WATCHDOG(mtx_cache_hd_transfer_);
+    flushDirtyBlocks();
+}
+
+
+std::shared_ptr<BaseBlock> Cache::getExternalBlockFromDisk(const std::string& folder_path, const BlockStore& store, block_uid_t uid) {
     if(uid == 0)
     {
         return nullptr;
     }
 
+    auto data = store.read(uid);
+    if(!data) {
+        //folder written by a version with one file per block
+        std::ifstream ifs(folder_path + "/" + std::to_string(uid) + ".blk", std::ifstream::binary);
+        if(!ifs) {
+            return nullptr;
+        }
+        std::stringstream data_stream;
+        data_stream << ifs.rdbuf();
+        return deserializeBlock(data_stream.str());
+    }
+    return deserializeBlock(*data);
+}
+
+
+std::shared_ptr<BaseBlock> Cache::deserializeBlock(const std::string& data) {
     try {
-        LOCK_MUTEX_WATCHDOG(mtx_hd_access_);
+        std::istringstream iss(data);
+        cereal::PortableBinaryInputArchive ia(iss);
         BlockType block_type;
-        std::ifstream ifs(folder_path_ + "/" + std::to_string(uid) + ".blk", std::ifstream::binary);
-        cereal::PortableBinaryInputArchive ia(ifs);
         ia >> block_type;
 
         switch (block_type) {
@@ -106,16 +341,14 @@ std::shared_ptr<BaseBlock> Cache::getBlockFromDisk(block_uid_t uid) const {
                 ia >> *block;
                 LOG(INFO) << "Finished reading baseline block from disk";
                 return std::static_pointer_cast<BaseBlock>(block);
-                break;
             }
             case BlockType::CollectionBlock: {
                 auto block = std::make_shared<CollectionBlock>();
                 ia >> *block;
                 return std::static_pointer_cast<BaseBlock>(block);
-                break;
             }
             default:
-                assert(false); //should never happen
+                LOG(ERROR) << "Cache: invalid block type on disk";
                 break;
         }
     }
@@ -126,29 +359,57 @@ std::shared_ptr<BaseBlock> Cache::getBlockFromDisk(block_uid_t uid) const {
 }
 
 
-std::shared_ptr<BaseBlock> Cache::getExternalBlockFromDisk(const std::string& folder_path, block_uid_t uid) {
-    if(uid == 0)
+template<class BLOCK>
+std::string Cache::serializeBlock(const BLOCK& block) {
+    std::ostringstream oss;
     {
-        return nullptr;
+        cereal::PortableBinaryOutputArchive oa(oss);
+        oa << (uint8_t)block.header.generic_header.block_type;
+        oa << block;
     }
+    return oss.str();
+}
 
-    try {
-        BlockType block_type;
-        std::ifstream ifs(folder_path + "/" + std::to_string(uid) + ".blk", std::ifstream::binary);
-        cereal::PortableBinaryInputArchive ia(ifs);
-        ia >> block_type;
 
-        switch (block_type) {
+void Cache::removeLegacyBlockFiles() {
+    uint64_t num_removed = 0;
+    boost::system::error_code error_code;
+    for(auto& entry : boost::filesystem::directory_iterator(folder_path_, error_code)) {
+        if(entry.path().extension() == ".blk" && boost::filesystem::remove(entry.path(), error_code)) {
+            num_removed++;
+        }
+    }
+    if(num_removed > 0) {
+        LOG(INFO) << "Cache: removed " << num_removed << " block files of the previous storage format";
+    }
+}
+
+
+void Cache::flushDirtyBlocks() {
+    std::vector<std::shared_ptr<BaseBlock>> blocks_to_write;
+    {
+        LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+        for(auto uid : dirty_blocks_) {
+            blocks_to_write.push_back(cached_blocks_.at(uid).block);
+        }
+    }
+    if(blocks_to_write.empty()) {
+        return;
+    }
+
+    std::vector<std::pair<block_uid_t, std::string>> records;
+    records.reserve(blocks_to_write.size());
+    for(auto& block_to_write : blocks_to_write) {
+        switch (block_to_write->header.generic_header.block_type) {
             case BlockType::BaselineBlock: {
-                auto block = std::make_shared<BaselineBlock>();
-                ia >> *block;
-                return std::static_pointer_cast<BaseBlock>(block);
+                LOG(INFO) << "Writing baseline block from cache to disk...";
+                auto block = std::static_pointer_cast<scn::BaselineBlock>(block_to_write);
+                records.emplace_back(block->header.block_uid, serializeBlock(*block));
                 break;
             }
             case BlockType::CollectionBlock: {
-                auto block = std::make_shared<CollectionBlock>();
-                ia >> *block;
-                return std::static_pointer_cast<BaseBlock>(block);
+                auto block = std::static_pointer_cast<scn::CollectionBlock>(block_to_write);
+                records.emplace_back(block->header.block_uid, serializeBlock(*block));
                 break;
             }
             default:
@@ -156,93 +417,257 @@ std::shared_ptr<BaseBlock> Cache::getExternalBlockFromDisk(const std::string& fo
                 break;
         }
     }
-    catch(const std::exception& e) {
-        return nullptr;
+
+    if(!block_store_.append(records)) {
+        return; //blocks stay dirty and are written with the next batch
+    }
+
+    {
+        LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+        for(auto& record : records) {
+            //blocks are only removed or replaced by resetCache, which waits for the transfer to finish
+            assert(dirty_blocks_.front() == record.first);
+            dirty_blocks_.pop_front();
+            auto& entry = cached_blocks_.at(record.first);
+            entry.dirty = false;
+            if(entry.encoded_block && !isCacheable(record.second.size() + entry.encoded_block->size())) {
+                entry.encoded_block.reset();
+            }
+            entry.size = record.second.size() + (entry.encoded_block ? entry.encoded_block->size() : 0);
+            if(!isCacheable(entry.size)) {
+                //released with blocks_to_write after unlocking
+                cached_blocks_.erase(record.first);
+                continue;
+            }
+            probationary_lru_.push_front(record.first);
+            entry.lru_position = probationary_lru_.begin();
+            probationary_bytes_ += entry.size;
+        }
+        evict();
     }
-    return nullptr;
 }
 
 
-void Cache::writeBlockToDisk(const BaselineBlock& block) {
-    LOCK_MUTEX_WATCHDOG(mtx_hd_access_);
-    LOG(INFO) << "Writing baseline block from cache to disk...";
-    std::ofstream ofs(folder_path_ + "/" + std::to_string(block.header.block_uid) + ".blk", std::ofstream::binary);
-    cereal::PortableBinaryOutputArchive oa(ofs);
-    oa << (uint8_t)block.header.generic_header.block_type;
-    oa << block;
-    LOG(INFO) << "Finished writing baseline block from cache to disk";
+bool Cache::isHot(block_uid_t uid) const {
+    return uid + num_hot_newest_blocks >= next_free_block_id_;
 }
 
 
-void Cache::writeBlockToDisk(const CollectionBlock& block) {
-    LOCK_MUTEX_WATCHDOG(mtx_hd_access_);
-    std::ofstream ofs(folder_path_ + "/" + std::to_string(block.header.block_uid) + ".blk", std::ofstream::binary);
-    cereal::PortableBinaryOutputArchive oa(ofs);
-    oa << (uint8_t)block.header.generic_header.block_type;
-    oa << block;
+bool Cache::isCacheable(uint64_t size) const {
+    return size <= maxCachedBlockSize();
 }
 
 
-void Cache::resetCache(const uint64_t root_block_uid) {
-    {
-        LOCK_MUTEX_WATCHDOG(mtx_cache_hd_transfer_);
-        {
-            LOCK_MUTEX_WATCHDOG(mtx_hd_access_);
-            //remove all blocks with smaller or equal block_id
-            for (block_uid_t i = 1; i <= root_block_uid; i++) {
-                boost::filesystem::remove(folder_path_ + "/" + std::to_string(i) + ".blk");
+void Cache::touch(block_uid_t uid, Entry& entry) const {
+    if(entry.dirty) {
+        return;
+    }
+    if(entry.read_ahead) {
+        //first access of a sequential read, the block keeps its place so that a scan does not displace other blocks
+        entry.read_ahead = false;
+        return;
+    }
+    if(entry.is_protected) {
+        protected_lru_.splice(protected_lru_.begin(), protected_lru_, entry.lru_position);
+        return;
+    }
+
+    //second access: promote to the protected segment
+    protected_lru_.splice(protected_lru_.begin(), probationary_lru_, entry.lru_position);
+    entry.is_protected = true;
+    probationary_bytes_ -= entry.size;
+    protected_bytes_ += entry.size;
+
+    //demote the least recently used protected blocks if the protected segment is full
+    while(protected_bytes_ > max_memory_bytes_ * protected_share && protected_lru_.size() > 1) {
+        auto& demoted_entry = cached_blocks_.at(protected_lru_.back());
+        probationary_lru_.splice(probationary_lru_.begin(), protected_lru_, demoted_entry.lru_position);
+        demoted_entry.is_protected = false;
+        protected_bytes_ -= demoted_entry.size;
+        probationary_bytes_ += demoted_entry.size;
+    }
+}
+
+
+void Cache::evict() const {
+    auto evict_from = [this](std::list<block_uid_t>& lru, uint64_t& bytes) {
+        for(auto position = lru.end(); position != lru.begin() && probationary_bytes_ + protected_bytes_ > max_memory_bytes_;) {
+            --position;
+            if(isHot(*position)) {
+                continue;
             }
+            auto cached_block = cached_blocks_.find(*position);
+            bytes -= cached_block->second.size;
+            cached_blocks_.erase(cached_block);
+            position = lru.erase(position);
+            num_evictions_++;
         }
+    };
+    evict_from(probationary_lru_, probationary_bytes_);
+    evict_from(protected_lru_, protected_bytes_);
+}
 
-        {
-            LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
-            cached_blocks_.clear();
-        }
+
+void Cache::resetCache(const uint64_t root_block_uid) {
+    //dropped blocks are released after unlocking (freeing a large baseline must not stall readers)
+    std::unordered_map<block_uid_t, Entry> dropped_blocks;
+    std::list<block_uid_t> dropped_probationary_lru;
+    std::list<block_uid_t> dropped_protected_lru;
+
+    LOCK_MUTEX_WATCHDOG(mtx_cache_hd_transfer_);
+    //all stored blocks are dropped (blocks <= root_block_uid are pruned, newer ones are added again)
+    //the cost does not depend on the uid range: whole segments are dropped and deleted once no read uses them
+    block_store_.clear();
+
+    {
+        LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+        dropped_blocks.swap(cached_blocks_);
+        dropped_probationary_lru.swap(probationary_lru_);
+        dropped_protected_lru.swap(protected_lru_);
+        probationary_bytes_ = 0;
+        protected_bytes_ = 0;
+        dirty_blocks_.clear();
+        reset_counter_++;
+
+        //add block with given id
+        next_free_block_id_ = root_block_uid;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mtx_read_ahead_);
+        streams_.clear();
+        read_ahead_queue_.clear();
+        read_ahead_queued_.clear();
+    }
+}
+
+
+uint64_t Cache::numHits() const {
+    LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+    return num_hits_;
+}
+
+
+uint64_t Cache::numMisses() const {
+    LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+    return num_misses_;
+}
+
+
+double Cache::hitRate() const {
+    LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+    if(num_hits_ + num_misses_ == 0) {
+        return 0.0;
     }
+    return static_cast<double>(num_hits_) / static_cast<double>(num_hits_ + num_misses_);
+}
+
+
+uint64_t Cache::numEvictions() const {
+    LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+    return num_evictions_;
+}
+
+
+uint64_t Cache::numEncodedBlockHits() const {
+    LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+    return num_encoded_block_hits_;
+}
+
+
+uint64_t Cache::numCachedBlocks() const {
+    LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+    return cached_blocks_.size();
+}
+
+
+uint64_t Cache::numDirtyBlocks() const {
+    LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+    return dirty_blocks_.size();
+}
+
+
+uint64_t Cache::numReadAheadBlocks() const {
+    LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+    return num_read_ahead_blocks_;
+}
+
+
+uint64_t Cache::numPendingReadAheadBlocks() const {
+    std::lock_guard<std::mutex> lock(mtx_read_ahead_);
+    return read_ahead_queued_.size() + (read_ahead_in_progress_ != 0 ? 1 : 0);
+}
 
-    //add block with given id
-    next_free_block_id_ = root_block_uid;
+
+uint64_t Cache::memoryUsage() const {
+    LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+    return probationary_bytes_ + protected_bytes_;
+}
+
+
+uint64_t Cache::maxCachedBlockSize() const {
+    return static_cast<uint64_t>(max_memory_bytes_ * max_block_share);
 }
 
 
 void Cache::cacheThread() {
     while(running_) {
+        {
+            std::unique_lock<std::mutex> lock(mtx_flush_signal_);
+            cv_flush_.wait_for(lock, std::chrono::milliseconds(flush_interval_ms), [this]() {
+                return flush_requested_ || !running_;
+            });
+            flush_requested_ = false;
+        }
 
+        if(running_) {
+            flush();
+        }
+    }
+}
+
+
+void Cache::readAheadThread() {
+    while(running_) {
+        block_uid_t uid;
         {
-            LOCK_MUTEX_WATCHDOG(mtx_cache_hd_transfer_);
-            std::shared_ptr<scn::BaseBlock> block_to_transfer = nullptr;
-            {
-                LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
-                if (cached_blocks_.size() > target_cache_size) {
-                    block_to_transfer = cached_blocks_.begin()->second;
-                }
+            std::unique_lock<std::mutex> lock(mtx_read_ahead_);
+            cv_read_ahead_.wait(lock, [this]() {
+                return !read_ahead_queue_.empty() || !running_;
+            });
+            if(!running_) {
+                break;
             }
-
-            if (block_to_transfer) {
-                switch (block_to_transfer->header.generic_header.block_type) {
-                    case BlockType::BaselineBlock: {
-                        auto block = std::static_pointer_cast<scn::BaselineBlock>(block_to_transfer);
-                        writeBlockToDisk(*block);
-                        break;
-                    }
-                    case BlockType::CollectionBlock: {
-                        auto block = std::static_pointer_cast<scn::CollectionBlock>(block_to_transfer);
-                        writeBlockToDisk(*block);
-                        break;
-                    }
-                    default:
-                        assert(false); //should never happen
-                        break;
-                }
+            uid = read_ahead_queue_.front();
+            read_ahead_queue_.pop_front();
+            if(read_ahead_queued_.erase(uid) == 0) {
+                continue; //already read on demand
             }
+            read_ahead_in_progress_ = uid;
+        }
+
+        bool cached;
+        uint64_t reset_counter;
+        {
+            LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+            cached = cached_blocks_.find(uid) != cached_blocks_.end();
+            reset_counter = reset_counter_;
+        }
 
-            if (block_to_transfer) {
+        if(!cached) {
+            auto data = block_store_.read(uid);
+            auto block = data ? deserializeBlock(*data) : nullptr;
+            if(block) {
+                cacheReadBlock(uid, block, data->size(), reset_counter, true);
                 LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
-                cached_blocks_.erase(block_to_transfer->header.block_uid);
+                num_read_ahead_blocks_++;
             }
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-
+        {
+            std::lock_guard<std::mutex> lock(mtx_read_ahead_);
+            read_ahead_in_progress_ = 0;
+        }
+        cv_read_ahead_done_.notify_all();
     }
-}
\ No newline at end of file
+}
@@ -19,52 +19,208 @@
 
 #include "scn/Common/Common.h"
 #include "BlockDefinitions.h"
+#include "BlockStore.h"
 #include <mutex>
+#include <condition_variable>
 #include <thread>
-#include <map>
+#include <atomic>
+#include <list>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include <set>
+#include <functional>
 
 namespace scn {
 
+    //keeps recently used blocks in memory and writes new blocks to the block store in the background
+    //memory is bounded by a byte budget (serialized block sizes); eviction uses a segmented LRU: blocks read once
+    //are dropped before blocks read again (probationary and protected segment)
+    //hot blocks (the newest blocks) and blocks not yet written to disk are never evicted
+    //blocks larger than a share of the budget (e.g. a baseline with many epochs) are only kept until they are written,
+    //else a single one would displace all other blocks
+    //sequential reads (e.g. a peer fetching the chain) are detected and the following blocks are read ahead
     class Cache {
     public:
 
-        explicit Cache(const std::string& folder_path);
+        explicit Cache(const std::string& folder_path, uint64_t max_memory_bytes = default_max_memory_bytes);
 
         virtual ~Cache();
 
         virtual std::shared_ptr<BaseBlock> getBlock(block_uid_t uid) const;
 
+        typedef std::function<std::string(const BaseBlock&)> encoder_t;
+
+        //block in an encoded form (e.g. a ready-framed network message), the encoder is called once and the result
+        //is kept with the cached block (and counts against the memory budget)
+        //the encoded form is not kept if the block and it together exceed maxCachedBlockSize(), such blocks are
+        //encoded on every request instead of being held twice
+        //NOTE: callers must always pass the same encoding, only one encoded form is kept per block
+        virtual std::shared_ptr<const std::string> getEncodedBlock(block_uid_t uid, const encoder_t& encoder) const;
+
         virtual block_uid_t addBlock(const BaselineBlock& block);
 
         virtual block_uid_t addBlock(const CollectionBlock& block);
 
         virtual void resetCache(uint64_t root_block_uid);
 
-        static std::shared_ptr<BaseBlock> getExternalBlockFromDisk(const std::string& folder_path, block_uid_t uid);
+        //writes all blocks that are not on disk yet (blocks until done)
+        virtual void flush();
+
+        //store: the blocks of folder_path, opened once by the caller (read-only, see BlockStore) and reused for
+        //all blocks of the folder
+        static std::shared_ptr<BaseBlock> getExternalBlockFromDisk(const std::string& folder_path, const BlockStore& store, block_uid_t uid);
+
+        virtual uint64_t numHits() const;
+
+        virtual uint64_t numMisses() const;
+
+        //hits / (hits + misses) since construction, 0 if there was no lookup yet
+        virtual double hitRate() const;
+
+        virtual uint64_t numEvictions() const;
+
+        virtual uint64_t numEncodedBlockHits() const;
+
+        //number of blocks in memory (including blocks not yet written to disk)
+        virtual uint64_t numCachedBlocks() const;
+
+        virtual uint64_t numDirtyBlocks() const;
+
+        //blocks loaded from disk by the read-ahead thread
+        virtual uint64_t numReadAheadBlocks() const;
+
+        //blocks the read-ahead thread still has to load (including the one it is loading)
+        virtual uint64_t numPendingReadAheadBlocks() const;
+
+        //serialized size of all blocks in memory that are already on disk
+        virtual uint64_t memoryUsage() const;
+
+        //largest block that is kept in memory once it is on disk
+        virtual uint64_t maxCachedBlockSize() const;
+
+        static const uint64_t default_max_memory_bytes = 128 * 1024 * 1024;
+
+        //the newest blocks are requested most often (by peers fetching the chain and by validation)
+        static const uint32_t num_hot_newest_blocks = 10;
 
     protected:
 
-        static const uint32_t target_cache_size = 10;
+        //new blocks are written as soon as this many are waiting, else on the next flush interval
+        static const uint32_t flush_batch_size = 16;
+
+        static const uint32_t flush_interval_ms = 500;
+
+        //a stream of reads is sequential once it has this many accesses with increasing uids
+        static const uint32_t min_sequential_accesses = 3;
+
+        //uids of requests in flight arrive slightly out of order (peers ask for up to 50 blocks at once)
+        static const uint32_t max_stream_gap = 8;
+
+        static const uint32_t max_num_streams = 8;
+
+        //blocks read ahead of the newest access of a stream
+        static const uint32_t read_ahead_blocks = 64;
+
+        //share of the budget for blocks that were requested more than once
+        static constexpr double protected_share = 0.8;
+
+        //share of the budget a single block may take
+        static constexpr double max_block_share = 0.25;
+
+        struct Entry {
+            std::shared_ptr<BaseBlock> block;
+            uint64_t size; //serialized size, 0 as long as the block is dirty
+            bool dirty;    //not yet written to disk
+            bool is_protected;
+            bool read_ahead; //read ahead and not requested yet
+            std::shared_ptr<const std::string> encoded_block; //see getEncodedBlock
+            std::list<block_uid_t>::iterator lru_position; //only valid if not dirty
+        };
+
+        struct Stream {
+            block_uid_t last_uid;
+            uint32_t num_accesses;
+            block_uid_t read_ahead_up_to;
+        };
 
         virtual void cacheThread();
 
-        virtual std::shared_ptr<BaseBlock> getBlockFromDisk(block_uid_t uid) const;
+        virtual void readAheadThread();
+
+        //tracks streams of increasing uids and queues the following blocks for the read-ahead thread
+        void detectSequentialAccess(block_uid_t uid) const;
+
+        //adds a block read from disk (unless the cache was reset after reading started)
+        void cacheReadBlock(block_uid_t uid, const std::shared_ptr<BaseBlock>& block, uint64_t size, uint64_t reset_counter, bool read_ahead) const;
+
+        //blocks were stored as one file per block ("<uid>.blk") before the block store, such files are never read
+        //from the own folder and are removed once (only the files that exist, not the whole uid range)
+        void removeLegacyBlockFiles();
 
-        virtual void writeBlockToDisk(const BaselineBlock& block);
+        //writes all dirty blocks with one store append
+        //NOTE: requires mtx_cache_hd_transfer_ to be locked
+        void flushDirtyBlocks();
 
-        virtual void writeBlockToDisk(const CollectionBlock& block);
+        //NOTE: requires mtx_cache_access_ to be locked
+        bool isHot(block_uid_t uid) const;
+
+        bool isCacheable(uint64_t size) const;
+
+        //moves a clean block to the front of its segment (promotes it to protected on a repeated access)
+        //NOTE: requires mtx_cache_access_ to be locked
+        void touch(block_uid_t uid, Entry& entry) const;
+
+        //evicts clean blocks until the budget is met (or only hot blocks are left)
+        //NOTE: requires mtx_cache_access_ to be locked
+        void evict() const;
+
+        template<class BLOCK>
+        block_uid_t addBlockToCache(const BLOCK& block);
+
+        //format of a stored block: block type (1 byte), block (cereal portable binary)
+        static std::shared_ptr<BaseBlock> deserializeBlock(const std::string& data);
+
+        template<class BLOCK>
+        static std::string serializeBlock(const BLOCK& block);
 
         const std::string folder_path_;
+        const uint64_t max_memory_bytes_;
+        BlockStore block_store_;
 
-        block_uid_t next_free_block_id_;
+        std::atomic<block_uid_t> next_free_block_id_;
 
         mutable std::mutex mtx_cache_access_;
-        std::map<block_uid_t, std::shared_ptr<BaseBlock>> cached_blocks_;
-        mutable std::mutex mtx_hd_access_;
+        mutable std::unordered_map<block_uid_t, Entry> cached_blocks_;
+        mutable std::list<block_uid_t> probationary_lru_; //most recently used first
+        mutable std::list<block_uid_t> protected_lru_;    //most recently used first
+        mutable uint64_t probationary_bytes_;
+        mutable uint64_t protected_bytes_;
+        std::deque<block_uid_t> dirty_blocks_; //in order of addition
+        uint64_t reset_counter_; //blocks read from disk before a reset must not be cached afterwards
+        mutable uint64_t num_hits_;
+        mutable uint64_t num_misses_;
+        mutable uint64_t num_evictions_;
+        mutable uint64_t num_encoded_block_hits_;
+        uint64_t num_read_ahead_blocks_;
+
         mutable std::mutex mtx_cache_hd_transfer_;
 
-        bool running_;
+        std::mutex mtx_flush_signal_;
+        std::condition_variable cv_flush_;
+        bool flush_requested_;
+
+        mutable std::mutex mtx_read_ahead_;
+        mutable std::condition_variable cv_read_ahead_;
+        mutable std::condition_variable cv_read_ahead_done_;
+        mutable std::vector<Stream> streams_; //least recently accessed first
+        mutable std::deque<block_uid_t> read_ahead_queue_;
+        mutable std::set<block_uid_t> read_ahead_queued_; //a demand read removes its uid here to take over
+        block_uid_t read_ahead_in_progress_;
+
+        std::atomic<bool> running_;
         std::thread cache_thread_;
+        std::thread read_ahead_thread_;
 
     };
 
@@ -0,0 +1,131 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "EpochHashSet.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+using namespace scn;
+
+const uint32_t EpochHashSet::empty_slot;
+const uint64_t EpochHashSet::min_num_slots;
+const uint32_t EpochHashSet::num_shard_bits;
+const uint64_t EpochHashSet::num_shards;
+
+
+EpochHashSet::EpochHashSet()
+:shards_()
+,size_(0) {
+    for(uint64_t i=0;i<num_shards;i++) {
+        shards_.push_back(std::make_shared<Shard>());
+    }
+}
+
+
+EpochHashSet::EpochHashSet(const std::vector<hash_t>& hashes)
+:EpochHashSet() {
+    insert(hashes);
+}
+
+
+EpochHashSet::~EpochHashSet() = default;
+
+
+bool EpochHashSet::contains(const hash_t& hash) const {
+    auto& shard = *shards_[getShardIndex(hash)];
+    const uint64_t mask = shard.slots.size() - 1;
+    auto slot_index = std::hash<hash_t>()(hash) & mask;
+    while(shard.slots[slot_index] != empty_slot) {
+        if(shard.hashes[shard.slots[slot_index] - 1] == hash) {
+            return true;
+        }
+        slot_index = (slot_index + 1) & mask;
+    }
+    return false;
+}
+
+
+void EpochHashSet::insert(const std::vector<hash_t>& hashes) {
+    for(auto& hash : hashes) {
+        getMutableShard(getShardIndex(hash)).insert(hash);
+    }
+    size_ += hashes.size();
+}
+
+
+uint32_t EpochHashSet::size() const {
+    return size_;
+}
+
+
+void EpochHashSet::mergeBatch(std::vector<hash_t>& sorted_hashes, std::vector<hash_t> batch) {
+    std::sort(batch.begin(), batch.end());
+    auto num_old_hashes = sorted_hashes.size();
+    sorted_hashes.insert(sorted_hashes.end(), batch.begin(), batch.end());
+    std::inplace_merge(sorted_hashes.begin(), sorted_hashes.begin() + num_old_hashes, sorted_hashes.end());
+}
+
+
+EpochHashSet::Shard::Shard()
+:hashes()
+,slots(min_num_slots, empty_slot) {
+
+}
+
+
+void EpochHashSet::Shard::insert(const hash_t& hash) {
+    hashes.push_back(hash);
+    //load factor <= 0.25, so probe sequences stay short
+    uint64_t num_slots = slots.size();
+    while(num_slots < 4 * hashes.size()) {
+        num_slots *= 2;
+    }
+    const uint64_t mask = num_slots - 1;
+    auto add_slot = [this, mask](uint32_t index) {
+        auto slot_index = std::hash<hash_t>()(hashes[index]) & mask;
+        while(slots[slot_index] != empty_slot) {
+            slot_index = (slot_index + 1) & mask;
+        }
+        slots[slot_index] = index + 1;
+    };
+    if(num_slots != slots.size()) {
+        slots.assign(num_slots, empty_slot);
+        for(uint32_t i=0;i<hashes.size();i++) {
+            add_slot(i);
+        }
+    } else {
+        add_slot(static_cast<uint32_t>(hashes.size() - 1));
+    }
+}
+
+
+uint64_t EpochHashSet::getShardIndex(const hash_t& hash) {
+    return std::hash<hash_t>()(hash) >> (std::numeric_limits<size_t>::digits - num_shard_bits);
+}
+
+
+EpochHashSet::Shard& EpochHashSet::getMutableShard(uint64_t shard_index) {
+    auto& shard = shards_[shard_index];
+    if(shard.use_count() > 1) {
+        shard = std::make_shared<Shard>(*shard);
+    } else {
+        //pairs with the release of the last other owner, its reads of the shard are done
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *shard;
+}
@@ -0,0 +1,78 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FULL_NODE_EPOCHHASHSET_H
+#define FULL_NODE_EPOCHHASHSET_H
+
+#include "scn/Common/Common.h"
+#include <vector>
+#include <memory>
+
+namespace scn {
+
+    //data value hashes of one epoch (at most CollectionBlock::max_num_creations) in flat open addressing shards
+    //for O(1) membership checks
+    //copies share the shards (copy on write, like WalletTable), inserting the hashes of a block only clones the
+    //shards they fall into
+    class EpochHashSet {
+    public:
+        EpochHashSet();
+
+        explicit EpochHashSet(const std::vector<hash_t>& hashes);
+
+        virtual ~EpochHashSet();
+
+        bool contains(const hash_t& hash) const;
+
+        //hashes must not be contained yet
+        void insert(const std::vector<hash_t>& hashes);
+
+        uint32_t size() const;
+
+        //sorts the batch and merges it into sorted_hashes - O(n + k log k) instead of sorting everything again
+        static void mergeBatch(std::vector<hash_t>& sorted_hashes, std::vector<hash_t> batch);
+
+        static const uint32_t num_shard_bits = 4;
+        static const uint64_t num_shards = 1ull << num_shard_bits;
+
+    protected:
+
+        struct Shard {
+            Shard();
+
+            void insert(const hash_t& hash);
+
+            std::vector<hash_t> hashes;
+            std::vector<uint32_t> slots; //index in hashes + 1, empty_slot if unused
+        };
+
+        //shards are selected by the upper bits of the hash, slots by the lower ones
+        static uint64_t getShardIndex(const hash_t& hash);
+
+        //clones the shard first if another set uses it as well
+        Shard& getMutableShard(uint64_t shard_index);
+
+        static const uint32_t empty_slot = 0;
+        static const uint64_t min_num_slots = 16; //per shard
+
+        std::vector<std::shared_ptr<Shard>> shards_;
+        uint32_t size_;
+    };
+
+}
+
+#endif //FULL_NODE_EPOCHHASHSET_H
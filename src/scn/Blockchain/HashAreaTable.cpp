@@ -0,0 +1,93 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "HashAreaTable.h"
+#include "scn/CryptoHelper/CryptoHelper.h"
+
+using namespace scn;
+
+
+const char* const HashAreaTable::expected_checksum = "6D55CE306C0E7E3F30B13BD0333B8A49FEB2F19287C5DF3C69D1D72BEFCEC03F";
+
+
+namespace {
+
+    boost::multiprecision::uint512_t nextMaxAllowedValue(const boost::multiprecision::uint512_t& value) {
+        return value *
+               boost::multiprecision::uint512_t(1000000000000000ul) /
+               boost::multiprecision::uint512_t(1001776032062287ul);
+    }
+
+}
+
+
+const HashAreaTable& HashAreaTable::getInstance() {
+    static const HashAreaTable instance;
+    return instance;
+}
+
+
+HashAreaTable::HashAreaTable() {
+    max_allowed_hashes_.reserve(first_empty_epoch + 1);
+    boost::multiprecision::uint512_t temp = std::numeric_limits<boost::multiprecision::uint256_t>::max();
+    for(epoch_t epoch=0;epoch<=first_empty_epoch;epoch++) {
+        max_allowed_hashes_.emplace_back(boost::multiprecision::uint256_t(temp));
+        temp = nextMaxAllowedValue(temp);
+    }
+    if(max_allowed_hashes_.back() != 0 || max_allowed_hashes_[first_empty_epoch - 1] == 0) {
+        LOG(FATAL) << "HashAreaTable: first epoch with empty hash area is not " << first_empty_epoch;
+    }
+    auto checksum = hash_helper::toString(calcChecksum());
+    if(checksum != expected_checksum) {
+        LOG(FATAL) << "HashAreaTable: checksum mismatch: " << checksum;
+    }
+}
+
+
+void HashAreaTable::getHashArea(const epoch_t& epoch, hash_t& max_allowed_hash, hash_t& min_allowed_hash) const {
+    if(epoch >= first_empty_epoch) {
+        max_allowed_hash = 0;
+        min_allowed_hash = 0;
+        return;
+    }
+    //lower bound is the upper bound of the next epoch (exclusive)
+    max_allowed_hash = max_allowed_hashes_[epoch];
+    min_allowed_hash = std::min(max_allowed_hashes_[epoch + 1] + 1, max_allowed_hash);
+}
+
+
+hash_t HashAreaTable::calcChecksum() const {
+    //hash of all entries as 32 byte arrays, one after another
+    std::vector<uint8_t> buffer(max_allowed_hashes_.size() * 32);
+    for(uint64_t i=0;i<max_allowed_hashes_.size();i++) {
+        hash_helper::toArray(max_allowed_hashes_[i], &buffer[i * 32]);
+    }
+    return CryptoHelper::calcHash(buffer.data(), buffer.size());
+}
+
+
+void HashAreaTable::calcHashArea(const epoch_t& epoch, hash_t& max_allowed_hash, hash_t& min_allowed_hash) {
+    boost::multiprecision::uint512_t temp = std::numeric_limits<boost::multiprecision::uint256_t>::max();
+    for(epoch_t i=0;i<epoch;i++)
+    {
+        temp = nextMaxAllowedValue(temp);
+    }
+    auto max_allowed_value = boost::multiprecision::uint256_t(temp);
+    auto min_allowed_value = std::min(boost::multiprecision::uint256_t(
+            nextMaxAllowedValue(boost::multiprecision::uint512_t(max_allowed_value))) + 1, max_allowed_value);
+    max_allowed_hash = hash_t(max_allowed_value);
+    min_allowed_hash = hash_t(min_allowed_value);
+}
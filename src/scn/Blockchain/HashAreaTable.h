@@ -0,0 +1,53 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FULL_NODE_HASHAREATABLE_H
+#define FULL_NODE_HASHAREATABLE_H
+
+#include "scn/Common/Common.h"
+#include <vector>
+
+namespace scn {
+
+    //allowed data value hash area of every epoch
+    //the upper bound shrinks by the factor 1000000000000000 / 1001776032062287 with every epoch, so the bound of
+    //epoch n needs n multiplications/divisions - the table does them once for all epochs on first use
+    class HashAreaTable {
+    public:
+        static const HashAreaTable& getInstance();
+
+        void getHashArea(const epoch_t& epoch, hash_t& max_allowed_hash, hash_t& min_allowed_hash) const;
+
+        //SHA-256 over the upper bounds of all epochs (32 bytes each, big endian)
+        hash_t calcChecksum() const;
+
+        //reference implementation without table (O(epoch))
+        static void calcHashArea(const epoch_t& epoch, hash_t& max_allowed_hash, hash_t& min_allowed_hash);
+
+        //upper bound of this and all following epochs is 0
+        static const epoch_t first_empty_epoch = 96756;
+
+        static const char* const expected_checksum;
+
+    protected:
+        HashAreaTable();
+
+        std::vector<hash_t> max_allowed_hashes_; //index: epoch, up to and including first_empty_epoch
+    };
+
+}
+
+#endif //FULL_NODE_HASHAREATABLE_H
@@ -0,0 +1,155 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "ParallelVerifier.h"
+#include "scn/Common/CpuAffinity.h"
+#include <algorithm>
+
+using namespace scn;
+
+
+const uint32_t ParallelVerifier::max_num_worker_threads;
+
+ParallelVerifier::ParallelVerifier(uint32_t num_worker_threads)
+:current_job_(nullptr)
+,job_generation_(0)
+,running_(true)
+,workers_() {
+    num_worker_threads = std::min(num_worker_threads, max_num_worker_threads);
+    workers_.reserve(num_worker_threads);
+    for(uint32_t i=0;i<num_worker_threads;i++) {
+        workers_.emplace_back(&ParallelVerifier::workerThread, this);
+    }
+}
+
+
+ParallelVerifier::~ParallelVerifier() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_job_access_);
+        running_ = false;
+    }
+    cv_job_available_.notify_all();
+    for(auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+
+uint32_t ParallelVerifier::verify(uint32_t num_checks, const std::function<bool(uint32_t)>& check) {
+    LOCK_MUTEX_WATCHDOG(mtx_verify_);
+
+    Job job;
+    job.num_checks = num_checks;
+    job.check = &check;
+    job.next_index = 0;
+    job.first_failed_index = num_checks;
+    job.num_active_workers = 0;
+
+    if(workers_.empty() || num_checks < min_checks_for_parallel_run) {
+        processJob(job);
+        return job.first_failed_index;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock_job(mtx_job_access_);
+        current_job_ = &job;
+        job_generation_++;
+    }
+    cv_job_available_.notify_all();
+
+    //calling thread takes part in the verification as well
+    processJob(job);
+
+    {
+        std::unique_lock<std::mutex> lock_job(mtx_job_access_);
+        current_job_ = nullptr;
+        cv_job_done_.wait(lock_job, [&job]() { return job.num_active_workers == 0; });
+    }
+
+    return job.first_failed_index;
+}
+
+
+uint32_t ParallelVerifier::numWorkerThreads() const {
+    return workers_.size();
+}
+
+
+uint32_t ParallelVerifier::defaultNumWorkerThreads() {
+    //the calling thread also verifies, so one core is already covered - miner cores are left to the miner
+    uint32_t num_cores = std::thread::hardware_concurrency();
+    uint32_t num_miner_cores = CpuAffinity::getMinerCores().size();
+    num_cores = num_miner_cores < num_cores ? num_cores - num_miner_cores : num_cores;
+    return num_cores > 1 ? std::min(num_cores - 1, max_num_worker_threads) : 0;
+}
+
+
+void ParallelVerifier::workerThread() {
+    CpuAffinity::isolateFromMinerCores();
+    uint64_t processed_generation = 0;
+    while(true) {
+        Job* job = nullptr;
+        {
+            std::unique_lock<std::mutex> lock_job(mtx_job_access_);
+            cv_job_available_.wait(lock_job, [&]() {
+                return !running_ || (current_job_ != nullptr && job_generation_ != processed_generation);
+            });
+            if(!running_) {
+                return;
+            }
+            processed_generation = job_generation_;
+            job = current_job_;
+            job->num_active_workers++;
+        }
+
+        processJob(*job);
+
+        {
+            std::lock_guard<std::mutex> lock_job(mtx_job_access_);
+            job->num_active_workers--;
+            if(job->num_active_workers == 0) {
+                cv_job_done_.notify_all();
+            }
+        }
+    }
+}
+
+
+void ParallelVerifier::processJob(Job& job) {
+    //indices are claimed in ascending order, so every index below the final first_failed_index is checked
+    //and the result equals the one of a sequential loop
+    while(true) {
+        uint32_t index = job.next_index.fetch_add(1);
+        if(index >= job.num_checks || index > job.first_failed_index) {
+            break;
+        }
+
+        bool passed;
+        try {
+            passed = (*job.check)(index);
+        } catch(const std::exception& e) {
+            LOG(ERROR) << "ParallelVerifier: check " << index << " threw exception: " << e.what();
+            passed = false;
+        }
+
+        if(!passed) {
+            uint32_t current_first_failed_index = job.first_failed_index;
+            while(index < current_first_failed_index &&
+                  !job.first_failed_index.compare_exchange_weak(current_first_failed_index, index)) {
+            }
+        }
+    }
+}
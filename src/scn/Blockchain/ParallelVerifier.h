@@ -0,0 +1,77 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FULL_NODE_PARALLELVERIFIER_H
+#define FULL_NODE_PARALLELVERIFIER_H
+
+#include "scn/Common/Common.h"
+#include <functional>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+namespace scn {
+
+    //runs independent checks on a fixed set of worker threads and stops early on the first failing check
+    class ParallelVerifier {
+    public:
+        explicit ParallelVerifier(uint32_t num_worker_threads = defaultNumWorkerThreads());
+
+        virtual ~ParallelVerifier();
+
+        //returns the lowest index for which check returned false (same as a sequential loop would) or num_checks if all passed
+        virtual uint32_t verify(uint32_t num_checks, const std::function<bool(uint32_t)>& check);
+
+        virtual uint32_t numWorkerThreads() const;
+
+        static uint32_t defaultNumWorkerThreads();
+
+        static const uint32_t max_num_worker_threads = 16;
+
+        //below this number of checks the calling thread verifies everything on its own
+        static const uint32_t min_checks_for_parallel_run = 4;
+
+    protected:
+
+        struct Job {
+            uint32_t num_checks;
+            const std::function<bool(uint32_t)>* check;
+            std::atomic<uint32_t> next_index;
+            std::atomic<uint32_t> first_failed_index;
+            uint32_t num_active_workers;
+        };
+
+        virtual void workerThread();
+
+        void processJob(Job& job);
+
+        std::mutex mtx_verify_;
+
+        std::mutex mtx_job_access_;
+        std::condition_variable cv_job_available_;
+        std::condition_variable cv_job_done_;
+        Job* current_job_;
+        uint64_t job_generation_;
+
+        bool running_;
+        std::vector<std::thread> workers_;
+    };
+
+}
+
+#endif //FULL_NODE_PARALLELVERIFIER_H
@@ -0,0 +1,228 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "SealedEpochStore.h"
+#include "scn/CryptoHelper/CryptoHelper.h"
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <cstring>
+#include <cassert>
+
+using namespace scn;
+
+static_assert(sizeof(hash_t) == 32, "hashes are stored without padding");
+
+const char SealedEpochStore::magic_[8] = {'S', 'C', 'N', 'E', 'P', 'O', 'C', 'H'};
+const uint64_t SealedEpochStore::version_;
+
+
+SealedEpochStore::SealedEpochStore(const std::string& file_path)
+:file_path_(file_path)
+,file_size_(0)
+,records_()
+,file_mapping_()
+,mapped_region_() {
+    open();
+}
+
+
+SealedEpochStore::~SealedEpochStore() = default;
+
+
+uint64_t SealedEpochStore::numEpochs() const {
+    return records_.size();
+}
+
+
+uint64_t SealedEpochStore::numHashes(epoch_t epoch) const {
+    return records_.at(epoch).num_hashes;
+}
+
+
+const hash_t* SealedEpochStore::getHashes(epoch_t epoch) const {
+    auto& record = records_.at(epoch);
+    if(!record.verified) {
+        if(!verifyEpoch(epoch)) {
+            LOG(FATAL) << "SealedEpochStore: checksum of epoch " << epoch << " in " << file_path_ << " invalid";
+        }
+        record.verified = true;
+    }
+    return getMappedHashes(epoch);
+}
+
+
+std::vector<hash_t> SealedEpochStore::getEpoch(epoch_t epoch) const {
+    auto hashes = getHashes(epoch);
+    return std::vector<hash_t>(hashes, hashes + numHashes(epoch));
+}
+
+
+bool SealedEpochStore::appendEpoch(const std::vector<hash_t>& hashes) {
+    return writeEpochs({&hashes});
+}
+
+
+void SealedEpochStore::truncate(uint64_t num_epochs) {
+    if(num_epochs >= records_.size()) {
+        return;
+    }
+    auto new_file_size = records_[num_epochs].offset - sizeof(RecordHeader);
+    records_.resize(num_epochs);
+    unmap();
+    resizeFile(new_file_size);
+    map();
+}
+
+
+bool SealedEpochStore::assign(const std::vector<std::vector<hash_t>>& epochs, uint64_t num_epochs) {
+    assert(num_epochs <= epochs.size());
+    uint64_t num_matching_epochs = 0;
+    while(num_matching_epochs < std::min<uint64_t>(records_.size(), num_epochs)) {
+        auto& epoch = epochs[num_matching_epochs];
+        if(numHashes(num_matching_epochs) != epoch.size() ||
+           std::memcmp(getMappedHashes(num_matching_epochs), epoch.data(), epoch.size() * sizeof(hash_t)) != 0) {
+            break;
+        }
+        //same content as the given epoch, the checksum does not have to be verified anymore
+        records_[num_matching_epochs].verified = true;
+        num_matching_epochs++;
+    }
+    truncate(num_matching_epochs);
+
+    std::vector<const std::vector<hash_t>*> epochs_to_write;
+    for(auto i = num_matching_epochs;i < num_epochs;i++) {
+        epochs_to_write.push_back(&epochs[i]);
+    }
+    return writeEpochs(epochs_to_write);
+}
+
+
+bool SealedEpochStore::verifyEpoch(epoch_t epoch) const {
+    return CryptoHelper::calcHash(getMappedHashes(epoch), numHashes(epoch) * sizeof(hash_t)) == getRecordHeader(epoch).checksum;
+}
+
+
+void SealedEpochStore::open() {
+    records_.clear();
+    try {
+        file_size_ = boost::filesystem::exists(file_path_) ? boost::filesystem::file_size(file_path_) : 0;
+        FileHeader file_header;
+        if(file_size_ >= sizeof(FileHeader)) {
+            std::ifstream ifs(file_path_, std::ifstream::binary);
+            ifs.read(reinterpret_cast<char*>(&file_header), sizeof(FileHeader));
+        }
+        if(file_size_ < sizeof(FileHeader) || std::memcmp(file_header.magic, magic_, sizeof(magic_)) != 0 ||
+           file_header.version != version_) {
+            //create new file
+            std::memset(&file_header, 0, sizeof(FileHeader));
+            std::memcpy(file_header.magic, magic_, sizeof(magic_));
+            file_header.version = version_;
+            std::ofstream ofs(file_path_, std::ofstream::binary | std::ofstream::trunc);
+            ofs.write(reinterpret_cast<const char*>(&file_header), sizeof(FileHeader));
+            ofs.close();
+            file_size_ = sizeof(FileHeader);
+        }
+        map();
+
+        //read record headers, everything behind the first incomplete record is dropped
+        //the checksums are verified on the first read of an epoch (or made unnecessary by assign)
+        uint64_t offset = sizeof(FileHeader);
+        while(offset + sizeof(RecordHeader) <= file_size_) {
+            auto& record_header = *reinterpret_cast<const RecordHeader*>(static_cast<const uint8_t*>(mapped_region_->get_address()) + offset);
+            if(record_header.num_hashes > (file_size_ - offset - sizeof(RecordHeader)) / sizeof(hash_t)) {
+                break;
+            }
+            records_.push_back({offset + sizeof(RecordHeader), record_header.num_hashes, false});
+            offset += sizeof(RecordHeader) + record_header.num_hashes * sizeof(hash_t);
+        }
+        if(offset != file_size_) {
+            unmap();
+            resizeFile(offset);
+            map();
+        }
+    } catch(const std::exception& e) {
+        LOG(ERROR) << "SealedEpochStore: could not open " << file_path_ << ": " << e.what();
+        throw;
+    }
+}
+
+
+void SealedEpochStore::map() {
+    file_mapping_.reset(new boost::interprocess::file_mapping(file_path_.c_str(), boost::interprocess::read_only));
+    mapped_region_.reset(new boost::interprocess::mapped_region(*file_mapping_, boost::interprocess::read_only, 0, file_size_));
+}
+
+
+void SealedEpochStore::unmap() {
+    mapped_region_.reset();
+    file_mapping_.reset();
+}
+
+
+void SealedEpochStore::resizeFile(uint64_t size) {
+    boost::filesystem::resize_file(file_path_, size);
+    file_size_ = size;
+}
+
+
+const SealedEpochStore::RecordHeader& SealedEpochStore::getRecordHeader(epoch_t epoch) const {
+    auto base_address = static_cast<const uint8_t*>(mapped_region_->get_address());
+    return *reinterpret_cast<const RecordHeader*>(base_address + records_.at(epoch).offset - sizeof(RecordHeader));
+}
+
+
+const hash_t* SealedEpochStore::getMappedHashes(epoch_t epoch) const {
+    auto base_address = static_cast<const uint8_t*>(mapped_region_->get_address());
+    return reinterpret_cast<const hash_t*>(base_address + records_.at(epoch).offset);
+}
+
+
+bool SealedEpochStore::writeEpochs(const std::vector<const std::vector<hash_t>*>& epochs) {
+    if(epochs.empty()) {
+        return true;
+    }
+    unmap();
+    bool write_ok;
+    {
+        std::ofstream ofs(file_path_, std::ofstream::binary | std::ofstream::in | std::ofstream::out);
+        ofs.seekp(file_size_);
+        for(auto epoch : epochs) {
+            RecordHeader record_header = RecordHeader();
+            record_header.num_hashes = epoch->size();
+            record_header.checksum = CryptoHelper::calcHash(epoch->data(), epoch->size() * sizeof(hash_t));
+            writeToFile(ofs, reinterpret_cast<const char*>(&record_header), sizeof(RecordHeader));
+            writeToFile(ofs, reinterpret_cast<const char*>(epoch->data()), epoch->size() * sizeof(hash_t));
+            records_.push_back({file_size_ + sizeof(RecordHeader), epoch->size(), true});
+            file_size_ += sizeof(RecordHeader) + epoch->size() * sizeof(hash_t);
+        }
+        ofs.flush();
+        write_ok = static_cast<bool>(ofs);
+    }
+    if(!write_ok) {
+        //keep only what really is in the file
+        LOG(ERROR) << "SealedEpochStore: could not write " << file_path_;
+        open();
+        return false;
+    }
+    map();
+    return true;
+}
+
+
+void SealedEpochStore::writeToFile(std::ofstream& ofs, const char* data, uint64_t size) {
+    ofs.write(data, size);
+}
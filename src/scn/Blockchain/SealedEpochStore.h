@@ -0,0 +1,120 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FULL_NODE_SEALEDEPOCHSTORE_H
+#define FULL_NODE_SEALEDEPOCHSTORE_H
+
+#include "scn/Common/Common.h"
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <fstream>
+#include <vector>
+#include <memory>
+
+namespace scn {
+
+    //data value hashes of completed epochs (they never change again) in one append-only, memory-mapped file
+    //only the live epoch has to be kept in RAM, sealed epochs are read from the mapping on demand
+    //file layout: file header, then per epoch a record header (number of hashes, SHA-256 of the hashes) followed
+    //by the hashes - every part is a multiple of 32 bytes, so hashes in the mapping are aligned
+    //checksums of records found on open are verified on their first read, so opening a store which is reset right
+    //away (see Blockchain::initEmptyChain) does not hash the whole file
+    //NOTE: the file is a local cache in native byte order, it is never transferred to other nodes
+    //NOTE: not thread safe
+    class SealedEpochStore {
+    public:
+        explicit SealedEpochStore(const std::string& file_path);
+
+        virtual ~SealedEpochStore();
+
+        uint64_t numEpochs() const;
+
+        uint64_t numHashes(epoch_t epoch) const;
+
+        //valid until the next call of a non const method, a corrupt epoch is fatal
+        const hash_t* getHashes(epoch_t epoch) const;
+
+        std::vector<hash_t> getEpoch(epoch_t epoch) const;
+
+        //appends epoch numEpochs()
+        //returns false if the file could not be written, then only the epochs which really are in the file are kept
+        bool appendEpoch(const std::vector<hash_t>& hashes);
+
+        //drops all epochs >= num_epochs
+        void truncate(uint64_t num_epochs);
+
+        //stores the first num_epochs epochs - keeps the longest prefix of already stored epochs which matches and
+        //appends the rest
+        //returns false if the file could not be written (see appendEpoch)
+        bool assign(const std::vector<std::vector<hash_t>>& epochs, uint64_t num_epochs);
+
+        //compares the stored SHA-256 of the epoch with its content
+        bool verifyEpoch(epoch_t epoch) const;
+
+    protected:
+
+        struct FileHeader {
+            char magic[8];
+            uint64_t version;
+            uint64_t reserved[2];
+        };
+
+        struct RecordHeader {
+            uint64_t num_hashes;
+            uint64_t reserved[3];
+            hash_t checksum;
+        };
+
+        struct Record {
+            uint64_t offset; //of the first hash in the file
+            uint64_t num_hashes;
+            mutable bool verified; //checksum compared with the content (or content written by this store)
+        };
+
+        //reads all record headers and drops an incomplete record at the end of the file
+        void open();
+
+        void map();
+
+        void unmap();
+
+        //appends the epochs to the file and maps it again once
+        bool writeEpochs(const std::vector<const std::vector<hash_t>*>& epochs);
+
+        void resizeFile(uint64_t size);
+
+        //all writes to the file go through here, errors are left in the state of ofs
+        virtual void writeToFile(std::ofstream& ofs, const char* data, uint64_t size);
+
+        const RecordHeader& getRecordHeader(epoch_t epoch) const;
+
+        //hashes of the epoch in the mapping, without verification
+        const hash_t* getMappedHashes(epoch_t epoch) const;
+
+        static const char magic_[8];
+        static const uint64_t version_ = 1;
+
+        const std::string file_path_;
+        uint64_t file_size_;
+        std::vector<Record> records_;
+        std::unique_ptr<boost::interprocess::file_mapping> file_mapping_;
+        std::unique_ptr<boost::interprocess::mapped_region> mapped_region_;
+    };
+
+}
+
+#endif //FULL_NODE_SEALEDEPOCHSTORE_H
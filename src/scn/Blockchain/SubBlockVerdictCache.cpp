@@ -0,0 +1,152 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "SubBlockVerdictCache.h"
+
+using namespace scn;
+
+
+namespace {
+
+    bool isEqual(const GenericHeader& lhs, const GenericHeader& rhs) {
+        return lhs.block_hash == rhs.block_hash &&
+               lhs.previous_block_hash == rhs.previous_block_hash &&
+               lhs.block_type == rhs.block_type;
+    }
+
+    bool isEqual(const TransactionSubBlock& lhs, const TransactionSubBlock& rhs) {
+        return isEqual(lhs.header.generic_header, rhs.header.generic_header) &&
+               lhs.fraction == rhs.fraction &&
+               lhs.pre_owner == rhs.pre_owner &&
+               lhs.post_owner == rhs.post_owner &&
+               lhs.signature == rhs.signature;
+    }
+
+    bool isEqual(const CreationSubBlock& lhs, const CreationSubBlock& rhs) {
+        return isEqual(lhs.header.generic_header, rhs.header.generic_header) &&
+               lhs.data_value == rhs.data_value &&
+               lhs.creator == rhs.creator &&
+               lhs.signature == rhs.signature;
+    }
+
+}
+
+
+SubBlockVerdictCache::SubBlockVerdictCache(uint32_t max_num_entries)
+:max_num_entries_(max_num_entries)
+,newest_block_hash_(0)
+,num_hits_(0)
+,num_misses_(0) {
+}
+
+
+SubBlockVerdictCache::~SubBlockVerdictCache() = default;
+
+
+bool SubBlockVerdictCache::isVerified(const TransactionSubBlock& sub_block, const hash_t& newest_block_hash) {
+    LOCK_MUTEX_WATCHDOG(mtx_access_);
+    if(bindToNewestBlock(newest_block_hash)) {
+        auto it = transactions_.find(key_t(sub_block.header.generic_header.block_hash,
+                                           sub_block.header.generic_header.previous_block_hash));
+        if(it != transactions_.end() && isEqual(it->second, sub_block)) {
+            num_hits_++;
+            return true;
+        }
+    }
+    num_misses_++;
+    return false;
+}
+
+
+bool SubBlockVerdictCache::isVerified(const CreationSubBlock& sub_block, const hash_t& newest_block_hash) {
+    LOCK_MUTEX_WATCHDOG(mtx_access_);
+    if(bindToNewestBlock(newest_block_hash)) {
+        auto it = creations_.find(key_t(sub_block.header.generic_header.block_hash,
+                                        sub_block.header.generic_header.previous_block_hash));
+        if(it != creations_.end() && isEqual(it->second, sub_block)) {
+            num_hits_++;
+            return true;
+        }
+    }
+    num_misses_++;
+    return false;
+}
+
+
+void SubBlockVerdictCache::setVerified(const TransactionSubBlock& sub_block, const hash_t& newest_block_hash) {
+    LOCK_MUTEX_WATCHDOG(mtx_access_);
+    bindToNewestBlock(newest_block_hash);
+    if(transactions_.size() + creations_.size() < max_num_entries_) {
+        transactions_[key_t(sub_block.header.generic_header.block_hash,
+                            sub_block.header.generic_header.previous_block_hash)] = sub_block;
+    }
+}
+
+
+void SubBlockVerdictCache::setVerified(const CreationSubBlock& sub_block, const hash_t& newest_block_hash) {
+    LOCK_MUTEX_WATCHDOG(mtx_access_);
+    bindToNewestBlock(newest_block_hash);
+    if(transactions_.size() + creations_.size() < max_num_entries_) {
+        creations_[key_t(sub_block.header.generic_header.block_hash,
+                         sub_block.header.generic_header.previous_block_hash)] = sub_block;
+    }
+}
+
+
+void SubBlockVerdictCache::invalidate() {
+    LOCK_MUTEX_WATCHDOG(mtx_access_);
+    transactions_.clear();
+    creations_.clear();
+    newest_block_hash_ = 0;
+}
+
+
+uint32_t SubBlockVerdictCache::size() const {
+    LOCK_MUTEX_WATCHDOG(mtx_access_);
+    return transactions_.size() + creations_.size();
+}
+
+
+uint64_t SubBlockVerdictCache::numHits() const {
+    LOCK_MUTEX_WATCHDOG(mtx_access_);
+    return num_hits_;
+}
+
+
+uint64_t SubBlockVerdictCache::numMisses() const {
+    LOCK_MUTEX_WATCHDOG(mtx_access_);
+    return num_misses_;
+}
+
+
+double SubBlockVerdictCache::hitRate() const {
+    LOCK_MUTEX_WATCHDOG(mtx_access_);
+    if(num_hits_ + num_misses_ == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(num_hits_) / static_cast<double>(num_hits_ + num_misses_);
+}
+
+
+bool SubBlockVerdictCache::bindToNewestBlock(const hash_t& newest_block_hash) {
+    if(newest_block_hash == newest_block_hash_) {
+        return true;
+    }
+    transactions_.clear();
+    creations_.clear();
+    newest_block_hash_ = newest_block_hash;
+    return false;
+}
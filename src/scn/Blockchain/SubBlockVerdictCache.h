@@ -0,0 +1,78 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FULL_NODE_SUBBLOCKVERDICTCACHE_H
+#define FULL_NODE_SUBBLOCKVERDICTCACHE_H
+
+#include "scn/Common/Common.h"
+#include "BlockDefinitions.h"
+#include <mutex>
+#include <map>
+
+namespace scn {
+
+    //remembers which sub-blocks already passed validation on top of the current newest block, so that
+    //candidate blocks propagated again and again during one cycle are not re-verified from scratch
+    //NOTE: only positive verdicts are stored and a hit requires the complete sub-block content to match
+    class SubBlockVerdictCache {
+    public:
+        explicit SubBlockVerdictCache(uint32_t max_num_entries = default_max_num_entries);
+
+        virtual ~SubBlockVerdictCache();
+
+        virtual bool isVerified(const TransactionSubBlock& sub_block, const hash_t& newest_block_hash);
+
+        virtual bool isVerified(const CreationSubBlock& sub_block, const hash_t& newest_block_hash);
+
+        virtual void setVerified(const TransactionSubBlock& sub_block, const hash_t& newest_block_hash);
+
+        virtual void setVerified(const CreationSubBlock& sub_block, const hash_t& newest_block_hash);
+
+        //drops all verdicts (called whenever the newest block in the chain changes)
+        virtual void invalidate();
+
+        virtual uint32_t size() const;
+
+        virtual uint64_t numHits() const;
+
+        virtual uint64_t numMisses() const;
+
+        //hits / (hits + misses) since construction, 0 if there was no lookup yet
+        virtual double hitRate() const;
+
+        //one cycle never contains more sub-blocks than this (see CollectionBlock limits)
+        static const uint32_t default_max_num_entries = 2 * (CollectionBlock::max_num_transactions + CollectionBlock::max_num_creations);
+
+    protected:
+
+        typedef std::pair<hash_t, hash_t> key_t; //sub-block hash, previous_block_hash
+
+        //returns false if the cache is bound to another newest block (and rebinds it to the given one)
+        bool bindToNewestBlock(const hash_t& newest_block_hash);
+
+        const uint32_t max_num_entries_;
+
+        mutable std::mutex mtx_access_;
+        hash_t newest_block_hash_;
+        std::map<key_t, TransactionSubBlock> transactions_;
+        std::map<key_t, CreationSubBlock> creations_;
+        uint64_t num_hits_;
+        uint64_t num_misses_;
+    };
+
+}
+
+#endif //FULL_NODE_SUBBLOCKVERDICTCACHE_H
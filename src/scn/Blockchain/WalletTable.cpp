@@ -0,0 +1,178 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "WalletTable.h"
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+using namespace scn;
+
+const uint32_t WalletTable::empty_slot;
+const uint64_t WalletTable::min_num_slots;
+const uint32_t WalletTable::num_shard_bits;
+const uint64_t WalletTable::num_shards;
+
+WalletTable::WalletTable()
+:shards_()
+,size_(0) {
+    clear();
+}
+
+
+WalletTable::~WalletTable() = default;
+
+
+uint64_t WalletTable::getBalance(const public_key_t& public_key) const {
+    auto& shard = *shards_[getShardIndex(public_key)];
+    auto slot = shard.slots[shard.findSlot(public_key)];
+    return slot == empty_slot ? 0 : shard.entries[slot - 1].balance;
+}
+
+
+bool WalletTable::contains(const public_key_t& public_key) const {
+    auto& shard = *shards_[getShardIndex(public_key)];
+    return shard.slots[shard.findSlot(public_key)] != empty_slot;
+}
+
+
+uint64_t& WalletTable::operator[](const public_key_t& public_key) {
+    auto& shard = getMutableShard(getShardIndex(public_key));
+    auto slot_index = shard.findSlot(public_key);
+    if(shard.slots[slot_index] != empty_slot) {
+        return shard.entries[shard.slots[slot_index] - 1].balance;
+    }
+
+    //keep the load factor <= 0.5
+    if(2 * (shard.entries.size() + 1) > shard.slots.size()) {
+        shard.rehash(2 * shard.slots.size());
+        slot_index = shard.findSlot(public_key);
+    }
+    shard.entries.push_back({public_key, 0});
+    shard.slots[slot_index] = static_cast<uint32_t>(shard.entries.size());
+    size_++;
+    return shard.entries.back().balance;
+}
+
+
+uint64_t WalletTable::size() const {
+    return size_;
+}
+
+
+void WalletTable::clear() {
+    //shards used by copies are left to them
+    shards_.clear();
+    for(uint64_t i=0;i<num_shards;i++) {
+        shards_.push_back(std::make_shared<Shard>());
+    }
+    size_ = 0;
+}
+
+
+void WalletTable::reserve(uint64_t num_wallets) {
+    //keys are spread evenly over the shards
+    auto num_wallets_per_shard = (num_wallets + num_shards - 1) / num_shards;
+    for(uint64_t i=0;i<num_shards;i++) {
+        uint64_t num_slots = shards_[i]->slots.size();
+        while(2 * num_wallets_per_shard > num_slots) {
+            num_slots *= 2;
+        }
+        if(num_slots != shards_[i]->slots.size()) {
+            auto& shard = getMutableShard(i);
+            shard.entries.reserve(num_wallets_per_shard);
+            shard.rehash(num_slots);
+        }
+    }
+}
+
+
+void WalletTable::assign(const std::map<public_key_t, uint64_t>& wallets) {
+    clear();
+    reserve(wallets.size());
+    for(auto& wallet : wallets) {
+        (*this)[wallet.first] = wallet.second;
+    }
+}
+
+
+std::map<public_key_t, uint64_t> WalletTable::toOrderedMap() const {
+    //sort once, then every insertion is at the end of the map (amortized O(1) with hint)
+    std::vector<const Entry*> sorted_entries;
+    sorted_entries.reserve(size_);
+    for(auto& shard : shards_) {
+        for(auto& entry : shard->entries) {
+            sorted_entries.push_back(&entry);
+        }
+    }
+    std::sort(sorted_entries.begin(), sorted_entries.end(), [](const Entry* lhs, const Entry* rhs) {
+        return lhs->public_key < rhs->public_key;
+    });
+
+    std::map<public_key_t, uint64_t> wallets;
+    for(auto entry : sorted_entries) {
+        wallets.emplace_hint(wallets.end(), entry->public_key, entry->balance);
+    }
+    return wallets;
+}
+
+
+WalletTable::Shard::Shard()
+:entries()
+,slots(min_num_slots, empty_slot) {
+
+}
+
+
+uint64_t WalletTable::Shard::findSlot(const public_key_t& public_key) const {
+    const uint64_t mask = slots.size() - 1;
+    auto slot_index = std::hash<public_key_t>()(public_key) & mask;
+    while(slots[slot_index] != empty_slot && entries[slots[slot_index] - 1].public_key != public_key) {
+        slot_index = (slot_index + 1) & mask;
+    }
+    return slot_index;
+}
+
+
+void WalletTable::Shard::rehash(uint64_t num_slots) {
+    slots.assign(num_slots, empty_slot);
+    const uint64_t mask = num_slots - 1;
+    for(uint32_t i=0;i<entries.size();i++) {
+        auto slot_index = std::hash<public_key_t>()(entries[i].public_key) & mask;
+        while(slots[slot_index] != empty_slot) {
+            slot_index = (slot_index + 1) & mask;
+        }
+        slots[slot_index] = i + 1;
+    }
+}
+
+
+uint64_t WalletTable::getShardIndex(const public_key_t& public_key) {
+    return std::hash<public_key_t>()(public_key) >> (std::numeric_limits<size_t>::digits - num_shard_bits);
+}
+
+
+WalletTable::Shard& WalletTable::getMutableShard(uint64_t shard_index) {
+    auto& shard = shards_[shard_index];
+    if(shard.use_count() > 1) {
+        shard = std::make_shared<Shard>(*shard);
+    } else {
+        //pairs with the release of the last other owner, its reads of the shard are done
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *shard;
+}
@@ -0,0 +1,97 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FULL_NODE_WALLETTABLE_H
+#define FULL_NODE_WALLETTABLE_H
+
+#include "scn/Common/Common.h"
+#include <vector>
+#include <map>
+#include <memory>
+
+namespace scn {
+
+    //balances of all wallets, indexed by the interned public key id (open addressing, linear probing)
+    //lookup and update are O(1) and do not compare public key strings, the ordered view needed for
+    //serialization (BaselineBlock::wallets) is produced on demand
+    //the table is split into shards that copies share (copy on write): copying a table only copies the shard
+    //pointers, a change clones the affected shard if another table still uses it
+    //NOTE: not thread safe, wallets are never removed (like entries of BaselineBlock::wallets)
+    //NOTE: a shared shard is never changed, so tables that are not changed anymore (e.g. published
+    //      std::shared_ptr<const WalletTable>) can be read while the table they were copied from is changed
+    class WalletTable {
+    public:
+        WalletTable();
+
+        virtual ~WalletTable();
+
+        //0 if the wallet does not exist
+        uint64_t getBalance(const public_key_t& public_key) const;
+
+        bool contains(const public_key_t& public_key) const;
+
+        //creates the wallet with balance 0 if it does not exist
+        uint64_t& operator[](const public_key_t& public_key);
+
+        uint64_t size() const;
+
+        void clear();
+
+        void reserve(uint64_t num_wallets);
+
+        void assign(const std::map<public_key_t, uint64_t>& wallets);
+
+        std::map<public_key_t, uint64_t> toOrderedMap() const;
+
+        static const uint32_t num_shard_bits = 6;
+        static const uint64_t num_shards = 1ull << num_shard_bits;
+
+    protected:
+
+        struct Entry {
+            public_key_t public_key; //keeps the key (and its id) alive
+            uint64_t balance;
+        };
+
+        struct Shard {
+            Shard();
+
+            //index into slots for the key, either an empty slot or the one referencing the key's entry
+            uint64_t findSlot(const public_key_t& public_key) const;
+
+            void rehash(uint64_t num_slots);
+
+            std::vector<Entry> entries;
+            std::vector<uint32_t> slots; //entry index + 1, empty_slot if unused
+        };
+
+        //shards are selected by the upper bits of the hash, slots by the lower ones
+        static uint64_t getShardIndex(const public_key_t& public_key);
+
+        //clones the shard first if another table uses it as well
+        Shard& getMutableShard(uint64_t shard_index);
+
+        static const uint32_t empty_slot = 0;
+        static const uint64_t min_num_slots = 16; //per shard
+
+        std::vector<std::shared_ptr<Shard>> shards_;
+        uint64_t size_;
+    };
+
+}
+
+#endif //FULL_NODE_WALLETTABLE_H
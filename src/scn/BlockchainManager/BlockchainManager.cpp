@@ -15,6 +15,7 @@
  */
 
 #include "BlockchainManager.h"
+#include "scn/Common/CpuAffinity.h"
 #include <functional>
 
 using namespace scn;
@@ -45,7 +46,10 @@ BlockchainManager::BlockchainManager(const public_key_t& our_public_key,
 , cycle_state_introduce_baseline_(*this)
 , current_state_(nullptr)
 , running_(true)
-, update_state_thread_(nullptr) {
+, update_state_thread_(nullptr)
+, num_idle_cycles_(0)
+, found_hash_queue_limit_(CollectionBlock::max_num_creations)
+, num_dropped_found_hashes_(0) {
     p2p_connector_.registerBlockCallbacks(std::bind(&BlockchainManager::baselineBlockReceivedCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3),
                                           std::bind(&BlockchainManager::collectionBlockReceivedCallback, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
     p2p_connector_.connect();
@@ -81,10 +85,30 @@ void BlockchainManager::collectionBlockReceivedCallback(const peer_id_t& peer_id
 
 void BlockchainManager::foundHashCallback(epoch_t epoch, const std::string& data) {
     LOCK_MUTEX_WATCHDOG(mtx_found_hash_queue_access_);
+    //values beyond the remaining creations of the epoch could never enter a block
+    if(found_hash_queue_.size() >= found_hash_queue_limit_) {
+        if(num_dropped_found_hashes_++ % 1000 == 0) {
+            LOG(INFO) << "Found hash queue full (" << found_hash_queue_limit_ << "), dropped " << num_dropped_found_hashes_ << " values";
+        }
+        return;
+    }
     found_hash_queue_.push(data);
 }
 
 
+void BlockchainManager::setFoundHashQueueLimit(uint32_t limit) {
+    LOCK_MUTEX_WATCHDOG(mtx_found_hash_queue_access_);
+    found_hash_queue_limit_ = limit;
+}
+
+
+uint32_t BlockchainManager::numRemainingCreations(const MiningState& mining_state, size_t num_pending_creations) {
+    const int64_t num_creations = static_cast<int64_t>(mining_state.num_minings_in_epoch) + static_cast<int64_t>(num_pending_creations);
+    const int64_t max_num_creations = static_cast<int64_t>(CollectionBlock::max_num_creations);
+    return num_creations < max_num_creations ? static_cast<uint32_t>(max_num_creations - num_creations) : 0;
+}
+
+
 void BlockchainManager::triggerTransaction(const public_key_t& receiver, uint64_t fraction) {
     LOCK_MUTEX_WATCHDOG(mtx_transaction_queue_access_);
     transaction_queue_.push(std::pair<const public_key_t,uint64_t>(receiver, fraction));
@@ -109,6 +133,17 @@ void BlockchainManager::resumeMiner() {
 }
 
 
+std::map<BlockchainManager::ConsensusPhase, BlockchainManager::ConsensusPhaseStats> BlockchainManager::getConsensusPhaseStats() const {
+    LOCK_MUTEX_WATCHDOG(mtx_consensus_phase_stats_access_);
+    return consensus_phase_stats_;
+}
+
+
+uint64_t BlockchainManager::numIdleCycles() const {
+    return num_idle_cycles_;
+}
+
+
 uint8_t BlockchainManager::percentBlockchainSynchronized() const {
     LOCK_MUTEX_WATCHDOG_REC(mtx_current_state_access_);
     if(current_state_ == &cycle_state_fetch_blockchain_) {
@@ -164,13 +199,13 @@ uint32_t BlockchainManager::setState(ICycleState& new_state) {
     {
         LOCK_MUTEX_WATCHDOG_REC(mtx_current_state_access_);
         if (&new_state != current_state_) {
-            if (current_state_ != nullptr) {
-                current_state_->onExit();
-            }
+            exitCurrentState();
 
             current_state_ = &new_state;
 
-            if (current_state_ != nullptr) {
+            if (current_state_ == &cycle_state_introduce_block_) {
+                runConsensusPhase(ConsensusPhase::IntroduceBlockStart, [this]() { current_state_->onEnter(); });
+            } else if (current_state_ != nullptr) {
                 current_state_->onEnter();
             }
         }
@@ -181,6 +216,32 @@ uint32_t BlockchainManager::setState(ICycleState& new_state) {
 }
 
 
+void BlockchainManager::exitCurrentState() {
+    if (current_state_ == &cycle_state_introduce_block_) {
+        runConsensusPhase(ConsensusPhase::IntroduceBlockEnd, [this]() { current_state_->onExit(); });
+    } else if (current_state_ != nullptr) {
+        current_state_->onExit();
+    }
+}
+
+
+void BlockchainManager::runConsensusPhase(ConsensusPhase phase, const std::function<void()>& function) {
+    miner_.enterConsensusPhase();
+    auto t0 = std::chrono::steady_clock::now();
+    function();
+    auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t0).count();
+    miner_.leaveConsensusPhase();
+
+    LOG(INFO) << "Consensus phase " << static_cast<uint32_t>(phase) << " took " << duration_us << " us";
+    LOCK_MUTEX_WATCHDOG(mtx_consensus_phase_stats_access_);
+    auto& stats = consensus_phase_stats_[phase];
+    stats.num_phases++;
+    stats.last_duration_us = duration_us;
+    stats.max_duration_us = std::max<uint64_t>(stats.max_duration_us, duration_us);
+    stats.total_duration_us += duration_us;
+}
+
+
 bool BlockchainManager::cycleUntil(blockchain_time_t target_time) {
     while(running_ && sync_timer_.now() < target_time) {
         bool do_sleep = true;
@@ -193,6 +254,7 @@ bool BlockchainManager::cycleUntil(blockchain_time_t target_time) {
 
         if (do_sleep) {
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            num_idle_cycles_++;
         }
     }
 
@@ -201,6 +263,7 @@ bool BlockchainManager::cycleUntil(blockchain_time_t target_time) {
 
 
 void BlockchainManager::updateStateThread() {
+    CpuAffinity::isolateFromMinerCores();
 
     if(initial_fetch_) {
         fetchBlockchain();
@@ -253,10 +316,8 @@ void BlockchainManager::updateStateThread() {
 
     {
         LOCK_MUTEX_WATCHDOG_REC(mtx_current_state_access_);
-        if(current_state_ != nullptr) {
-            current_state_->onExit();
-            current_state_ = nullptr;
-        }
+        exitCurrentState();
+        current_state_ = nullptr;
     }
 }
 
@@ -274,6 +335,7 @@ void BlockchainManager::fetchBlockchain() {
 
         if(do_sleep) {
             std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            num_idle_cycles_++;
         }
     }
 }
\ No newline at end of file
@@ -35,6 +35,7 @@
 #include "scn/CryptoHelper/CryptoHelper.h"
 #include <mutex>
 #include <thread>
+#include <atomic>
 #include <map>
 #include <queue>
 
@@ -42,6 +43,24 @@ namespace scn {
 
     class BlockchainManager {
     public:
+
+        //consensus critical parts of the cycle, the miner is throttled while they run
+        enum class ConsensusPhase : uint8_t {
+            IntroduceBlockStart = 1,
+            IntroduceBlockEnd   = 2,
+            ValidateBlock       = 3
+        };
+
+        struct ConsensusPhaseStats {
+            uint64_t num_phases;
+            uint64_t last_duration_us;
+            uint64_t max_duration_us;
+            uint64_t total_duration_us;
+
+            ConsensusPhaseStats()
+            :num_phases(0), last_duration_us(0), max_duration_us(0), total_duration_us(0) {}
+        };
+
         BlockchainManager(const public_key_t& our_public_key,
                 const private_key_t& our_private_key,
                 Blockchain& blockchain,
@@ -67,6 +86,12 @@ namespace scn {
 
         virtual ICycleState::State getCurrentState() const;
 
+        virtual std::map<ConsensusPhase, ConsensusPhaseStats> getConsensusPhaseStats() const;
+
+        //cycles in which the current state had nothing to do, counted after the following sleep
+        //(lets callers wait until a change, e.g. of the time, has been handled)
+        virtual uint64_t numIdleCycles() const;
+
         static bool isBaselineBlock(block_uid_t block_uid);
 
         static block_uid_t getNextBaselineBlock(block_uid_t block_uid);
@@ -75,6 +100,9 @@ namespace scn {
 
         static block_uid_t getBlockId(blockchain_time_t blockchain_time);
 
+        //creations left in the epoch of mining_state when num_pending_creations are not yet part of a block
+        static uint32_t numRemainingCreations(const MiningState& mining_state, size_t num_pending_creations = 0);
+
     protected:
 
         static SynchronizedTimer static_sync_timer_;
@@ -87,6 +115,15 @@ namespace scn {
 
         virtual uint32_t setState(ICycleState& new_state);
 
+        //the found hash queue never holds more values than creations are left in the current epoch
+        void setFoundHashQueueLimit(uint32_t limit);
+
+        //leaves the current state (if any), mtx_current_state_access_ has to be locked
+        void exitCurrentState();
+
+        //runs function with a throttled miner and records the duration
+        void runConsensusPhase(ConsensusPhase phase, const std::function<void()>& function);
+
         virtual bool cycleUntil(blockchain_time_t target_time);
 
         virtual void updateStateThread();
@@ -125,14 +162,20 @@ namespace scn {
 
         bool running_;
         std::unique_ptr<std::thread> update_state_thread_;
+        std::atomic<uint64_t> num_idle_cycles_;
 
         CollectionBlock new_block_;
 
         std::mutex mtx_found_hash_queue_access_;
         std::queue<std::string> found_hash_queue_;
+        uint32_t found_hash_queue_limit_;
+        uint64_t num_dropped_found_hashes_;
 
         std::mutex mtx_transaction_queue_access_;
         std::queue<std::pair<const public_key_t,uint64_t>> transaction_queue_;
+
+        mutable std::mutex mtx_consensus_phase_stats_access_;
+        std::map<ConsensusPhase, ConsensusPhaseStats> consensus_phase_stats_;
     };
 
 }
@@ -18,6 +18,7 @@
 #include "CycleStateCollect.h"
 #include "BlockchainManager.h"
 #include "scn/Blockchain/Blockchain.h"
+#include <unordered_set>
 
 using namespace scn;
 
@@ -42,6 +43,8 @@ void CycleStateCollect::onEnter() {
         base_.active_peers_collector_.restartListBuilding();
     }
     base_.active_peers_collector_.propagate();
+
+    base_.setFoundHashQueueLimit(numRemainingCreations(base_.blockchain_.getMiningState()));
 }
 
 
@@ -52,34 +55,19 @@ bool CycleStateCollect::onCycle() {
     auto newest_block_in_chain = base_.blockchain_.getNewestBlock();
     auto mining_state = base_.blockchain_.getMiningState();
     {
-        std::string creation_data_value;
+        //the whole queue is handled at once - it never holds more values than creations are left in the epoch
+        std::vector<std::string> creation_data_values;
         {
             LOCK_MUTEX_WATCHDOG(base_.mtx_found_hash_queue_access_);
-            if (!base_.found_hash_queue_.empty()) {
-                creation_data_value = base_.found_hash_queue_.front();
+            creation_data_values.reserve(base_.found_hash_queue_.size());
+            while(!base_.found_hash_queue_.empty()) {
+                creation_data_values.push_back(std::move(base_.found_hash_queue_.front()));
                 base_.found_hash_queue_.pop();
-                if(!base_.found_hash_queue_.empty()) {
-                    no_sleep = true;
-                }
             }
         }
-        if (creation_data_value.length() > 0) {
-            CreationSubBlock sub_block;
-            sub_block.header.generic_header.previous_block_hash = newest_block_in_chain->header.generic_header.block_hash;
-            sub_block.data_value = creation_data_value;
-            sub_block.creator = base_.our_public_key_;
-            base_.crypto_.fillSignature(sub_block);
-            CryptoHelper::fillHash(sub_block);
-            if (base_.blockchain_.validateSubBlock(sub_block)) {
-                base_.new_block_.creations[sub_block.header.generic_header.block_hash] = sub_block;
-                minings_in_cycle_++;
-                if(base_.new_block_.creations.size() > (CollectionBlock::max_num_creations - mining_state.num_minings_in_epoch)) {
-                    base_.new_block_.creations.erase(std::prev(base_.new_block_.creations.end()));
-                    minings_in_cycle_--;
-                }
-            } else {
-                LOG(ERROR) << "self check validateSubBlock creation failed!";
-            }
+        if (!creation_data_values.empty()) {
+            minings_in_cycle_ += addCreations(creation_data_values, newest_block_in_chain, mining_state);
+            base_.setFoundHashQueueLimit(numRemainingCreations(mining_state));
         }
     }
 
@@ -126,6 +114,62 @@ bool CycleStateCollect::onCycle() {
 }
 
 
+uint32_t CycleStateCollect::addCreations(std::vector<std::string>& data_values,
+                                         const std::shared_ptr<BaseBlock>& newest_block_in_chain,
+                                         const MiningState& mining_state) {
+    //dedupe before the expensive signing - against each other and against the creations of the new block
+    std::unordered_set<std::string> known_data_values;
+    for(auto& creation : base_.new_block_.creations) {
+        known_data_values.insert(creation.second.data_value);
+    }
+    const uint32_t num_remaining_creations = numRemainingCreations(mining_state);
+    std::vector<CreationSubBlock> sub_blocks;
+    sub_blocks.reserve(std::min<size_t>(data_values.size(), num_remaining_creations));
+    for(auto& data_value : data_values) {
+        if(sub_blocks.size() >= num_remaining_creations) {
+            break;
+        }
+        if(data_value.empty() || !known_data_values.insert(data_value).second) {
+            continue;
+        }
+        sub_blocks.emplace_back();
+        auto& sub_block = sub_blocks.back();
+        sub_block.header.generic_header.previous_block_hash = newest_block_in_chain->header.generic_header.block_hash;
+        sub_block.data_value = std::move(data_value);
+        sub_block.creator = base_.our_public_key_;
+    }
+
+    //signed serially, the one EC_KEY of crypto_ must not be used by several threads at once
+    for(auto& sub_block : sub_blocks) {
+        base_.crypto_.fillSignature(sub_block);
+        CryptoHelper::fillHash(sub_block);
+    }
+
+    std::vector<const CreationSubBlock*> sub_blocks_to_check;
+    sub_blocks_to_check.reserve(sub_blocks.size());
+    for(auto& sub_block : sub_blocks) {
+        sub_blocks_to_check.push_back(&sub_block);
+    }
+    auto verdicts = base_.blockchain_.validateSubBlocks(sub_blocks_to_check);
+
+    uint32_t num_added_creations = 0;
+    for(uint32_t i=0;i<sub_blocks.size();i++) {
+        if(verdicts[i]) {
+            base_.new_block_.creations[sub_blocks[i].header.generic_header.block_hash] = std::move(sub_blocks[i]);
+            num_added_creations++;
+        } else {
+            LOG(ERROR) << "self check validateSubBlock creation failed!";
+        }
+    }
+    return num_added_creations;
+}
+
+
+uint32_t CycleStateCollect::numRemainingCreations(const MiningState& mining_state) const {
+    return BlockchainManager::numRemainingCreations(mining_state, base_.new_block_.creations.size());
+}
+
+
 void CycleStateCollect::onExit() {
     LOG(INFO) << "Minings in this collect cycle: " << minings_in_cycle_;
     LOG(INFO) << "Max collect cycle duration: " << max_cycle_duration_ms_ << " ms";
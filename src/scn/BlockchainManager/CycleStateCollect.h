@@ -39,6 +39,15 @@ namespace scn {
         State getState() const override { return State::Collect; }
 
     protected:
+        //dedupes, signs, validates (as batch) and inserts the found data values into the new block
+        //returns the number of added creations
+        uint32_t addCreations(std::vector<std::string>& data_values,
+                              const std::shared_ptr<BaseBlock>& newest_block_in_chain,
+                              const MiningState& mining_state);
+
+        //remaining creations of the epoch which are not yet part of the new block
+        uint32_t numRemainingCreations(const MiningState& mining_state) const;
+
         BlockchainManager& base_;
         uint32_t minings_in_cycle_;
         uint32_t max_cycle_duration_ms_;
@@ -28,7 +28,8 @@ const std::array<uint32_t, 22> CycleStateIntroduceBlock::peers_necessary_for_gra
                                                                                           7,8};
 
 CycleStateIntroduceBlock::CycleStateIntroduceBlock(BlockchainManager& base)
-:base_(base) {
+:base_(base)
+,use_merkle_trees_(false) {
 
 }
 
@@ -48,8 +49,17 @@ void CycleStateIntroduceBlock::onEnter() {
     block_uid_t new_block_uid = base_.blockchain_.getNewestBlockId() + 1;
     base_.new_block_.header.generic_header.previous_block_hash = base_.blockchain_.getBlock(new_block_uid-1)->header.generic_header.block_hash;
     base_.new_block_.header.block_uid = new_block_uid;
-    base_.new_block_.header.generic_header.block_hash = 0;
-    CryptoHelper::fillHash(base_.new_block_);
+
+    use_merkle_trees_ = CryptoHelper::getCollectionBlockHashMode() == CryptoHelper::CollectionBlockHashMode::MerkleRoot;
+    transactions_tree_.clear();
+    creations_tree_.clear();
+    for(auto& transaction : base_.new_block_.transactions) {
+        addToMerkleTree(transactions_tree_, transaction.first);
+    }
+    for(auto& creation : base_.new_block_.creations) {
+        addToMerkleTree(creations_tree_, creation.first);
+    }
+    updateNewBlockHash();
 
     LOG(INFO) << "Propagate initial block: " << hash_helper::toString(base_.new_block_.header.generic_header.block_hash);
     base_.p2p_connector_.propagateBlock(base_.new_block_);
@@ -70,8 +80,7 @@ bool CycleStateIntroduceBlock::onCycle() {
 
 
 void CycleStateIntroduceBlock::onExit() {
-    base_.new_block_.header.generic_header.block_hash = 0;
-    CryptoHelper::fillHash(base_.new_block_);
+    updateNewBlockHash();
     base_.blockchain_.addBlock(base_.new_block_);
 
     auto mining_state = base_.blockchain_.getMiningState();
@@ -83,6 +92,8 @@ void CycleStateIntroduceBlock::onExit() {
         }
         base_.resumeMiner();
     }
+    //values found until the next collect state are limited by the creations left after the added block
+    base_.setFoundHashQueueLimit(BlockchainManager::numRemainingCreations(mining_state));
 
     LOG(INFO) << "New Block " << base_.new_block_.header.block_uid << ": " << hash_helper::toString(base_.new_block_.header.generic_header.block_hash);
     LOG(INFO) << "      highest_hash_of_last_epoch: " << hash_helper::toString(mining_state.highest_hash_of_last_epoch);
@@ -108,7 +119,14 @@ void CycleStateIntroduceBlock::blockReceivedCallback(const peer_id_t& peer_id, s
     } else {
         std::chrono::time_point<std::chrono::system_clock> t0, t1, t2, t3, t4, t5;
         t0 = std::chrono::system_clock::now();
-        bool block_valid = (processed_block_it != processed_blocks_.end()) ? processed_block_it->second : base_.blockchain_.validateBlock(*block);
+        bool block_valid = false;
+        if(processed_block_it != processed_blocks_.end()) {
+            block_valid = processed_block_it->second;
+        } else {
+            base_.runConsensusPhase(BlockchainManager::ConsensusPhase::ValidateBlock, [this, &block, &block_valid]() {
+                block_valid = base_.blockchain_.validateBlock(*block);
+            });
+        }
         processed_blocks_[block->header.generic_header.block_hash] = block_valid;
         if (block_valid) {
             t1 = std::chrono::system_clock::now();
@@ -121,7 +139,9 @@ void CycleStateIntroduceBlock::blockReceivedCallback(const peer_id_t& peer_id, s
                         transaction_sub_block_counter[element.first]++;
                         if(transaction_sub_block_counter[element.first] >= peers_necessary_for_granting_[std::min(static_cast<uint32_t>(peers_necessary_for_granting_.size())-1, num_propagations_in_current_cycle_)]) {
                             base_.new_block_.transactions[element.first] = element.second;
+                            addToMerkleTree(transactions_tree_, element.first);
                             if (base_.new_block_.transactions.size() > CollectionBlock::max_num_transactions) {
+                                removeFromMerkleTree(transactions_tree_, std::prev(base_.new_block_.transactions.end())->first);
                                 base_.new_block_.transactions.erase(std::prev(base_.new_block_.transactions.end()));
                             }
                             transaction_sub_block_counter.erase(element.first);
@@ -135,8 +155,10 @@ void CycleStateIntroduceBlock::blockReceivedCallback(const peer_id_t& peer_id, s
                         creation_sub_block_counter[element.first]++;
                         if(creation_sub_block_counter[element.first] >= peers_necessary_for_granting_[std::min(static_cast<uint32_t>(peers_necessary_for_granting_.size())-1, num_propagations_in_current_cycle_)]) {
                             base_.new_block_.creations[element.first] = element.second;
+                            addToMerkleTree(creations_tree_, element.first);
                             getRidOfDuplicates(base_.new_block_.creations, element.second.data_value);
                             if (base_.new_block_.creations.size() > (CollectionBlock::max_num_creations - mining_state.num_minings_in_epoch)) {
+                                removeFromMerkleTree(creations_tree_, std::prev(base_.new_block_.creations.end())->first);
                                 base_.new_block_.creations.erase(std::prev(base_.new_block_.creations.end()));
                             }
                             creation_sub_block_counter.erase(element.first);
@@ -144,8 +166,7 @@ void CycleStateIntroduceBlock::blockReceivedCallback(const peer_id_t& peer_id, s
                     }
                 }
                 t4 = std::chrono::system_clock::now();
-                base_.new_block_.header.generic_header.block_hash = 0;
-                CryptoHelper::fillHash(base_.new_block_);
+                updateNewBlockHash();
                 t5 = std::chrono::system_clock::now();
 
                 LOG(INFO) << "CycleStateIntroduceBlock::blockReceivedCallback durations t01:" <<
@@ -180,9 +201,36 @@ void CycleStateIntroduceBlock::getRidOfDuplicates(std::map<hash_t, CreationSubBl
         }
 
         if(erase) {
+            removeFromMerkleTree(creations_tree_, it->first);
             it = map_to_modify.erase(it);
         } else {
             it++;
         }
     }
+}
+
+
+void CycleStateIntroduceBlock::updateNewBlockHash() {
+    base_.new_block_.header.generic_header.block_hash = 0;
+    if(use_merkle_trees_) {
+        base_.new_block_.header.generic_header.block_hash = CryptoHelper::calcMerkleBlockHash(base_.new_block_,
+                                                                                              transactions_tree_.getRoot(),
+                                                                                              creations_tree_.getRoot());
+    } else {
+        CryptoHelper::fillHash(base_.new_block_);
+    }
+}
+
+
+void CycleStateIntroduceBlock::addToMerkleTree(MerkleTree& tree, const hash_t& sub_block_hash) {
+    if(use_merkle_trees_) {
+        tree.insert(sub_block_hash);
+    }
+}
+
+
+void CycleStateIntroduceBlock::removeFromMerkleTree(MerkleTree& tree, const hash_t& sub_block_hash) {
+    if(use_merkle_trees_) {
+        tree.erase(sub_block_hash);
+    }
 }
\ No newline at end of file
@@ -18,6 +18,7 @@
 #define FULL_NODE_CYCLESTATEINTRODUCEBLOCK_H
 
 #include "ICycleState.h"
+#include "scn/CryptoHelper/MerkleTree.h"
 #include <array>
 #include <map>
 #include <set>
@@ -49,6 +50,13 @@ namespace scn {
 
         void getRidOfDuplicates(std::map<hash_t, CreationSubBlock>& map_to_modify, const std::string& data_value_to_check);
 
+        //recalculates the hash of new_block_ (incrementally via the Merkle trees in MerkleRoot hash mode)
+        void updateNewBlockHash();
+
+        void addToMerkleTree(MerkleTree& tree, const hash_t& sub_block_hash);
+
+        void removeFromMerkleTree(MerkleTree& tree, const hash_t& sub_block_hash);
+
         BlockchainManager& base_;
         blockchain_time_t next_propagation_time_;
         uint32_t num_propagations_in_current_cycle_;
@@ -58,6 +66,11 @@ namespace scn {
         std::map<hash_t, uint32_t> creation_sub_block_counter;
         std::map<hash_t, uint32_t> transaction_sub_block_counter;
 
+        //keys of new_block_.transactions/creations, only maintained in MerkleRoot hash mode
+        bool use_merkle_trees_;
+        MerkleTree transactions_tree_;
+        MerkleTree creations_tree_;
+
         static const std::array<uint32_t, 22> peers_necessary_for_granting_;
     };
 
@@ -59,7 +59,7 @@ void OutOfSyncDetector::blockReceivedCallback(const peer_id_t& peer_id, const Co
         bool hash_in_sync_with_us = (block.header.generic_header.previous_block_hash == newest_block_hash_);
         peer_in_sync_map_[peer_id] = hash_in_sync_with_us;
         if(!hash_in_sync_with_us) {
-            LOG(INFO) << "Peer not in sync: " << peer_id << " - our previous hash: " << newest_block_hash_ << " - theirs: " << block.header.generic_header.previous_block_hash;
+            LOG(INFO) << "Peer not in sync: " << peer_id << " - our previous hash: " << hash_helper::toString(newest_block_hash_) << " - theirs: " << hash_helper::toString(block.header.generic_header.previous_block_hash);
         }
         uint32_t peers_out_of_sync = 0;
         uint32_t num_peers = peer_in_sync_map_.size();
@@ -22,8 +22,8 @@ using namespace scn;
 
 bool scn::hasBits(const hash_t& hash, uint8_t const* bits, uint32_t const len)
 {
-    uint32_t idx1 = static_cast<uint32_t>(hash);
-    uint32_t idx2 = static_cast<uint32_t>(hash >> 32);
+    uint32_t idx1 = static_cast<uint32_t>(hash.getWord(3));
+    uint32_t idx2 = static_cast<uint32_t>(hash.getWord(3) >> 32);
     idx1 %= static_cast<uint32_t>(len * 8);
     idx2 %= static_cast<uint32_t>(len * 8);
     return (bits[idx1 / 8] & (1 << (idx1 & 7))) != 0
@@ -32,8 +32,8 @@ bool scn::hasBits(const hash_t& hash, uint8_t const* bits, uint32_t const len)
 
 void scn::setBits(const hash_t& hash, uint8_t* bits, uint32_t const len)
 {
-    uint32_t idx1 = static_cast<uint32_t>(hash);
-    uint32_t idx2 = static_cast<uint32_t>(hash >> 32);
+    uint32_t idx1 = static_cast<uint32_t>(hash.getWord(3));
+    uint32_t idx2 = static_cast<uint32_t>(hash.getWord(3) >> 32);
     idx1 %= static_cast<uint32_t>(len * 8);
     idx2 %= static_cast<uint32_t>(len * 8);
     bits[idx1 / 8] |= (1 << (idx1 & 7));
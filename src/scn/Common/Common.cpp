@@ -19,22 +19,38 @@
 using namespace scn;
 
 std::string scn::hash_helper::toString(const hash_t& hash) {
-    return hash.str(0, std::ios_base::hex | std::ios_base::uppercase);
+    //upper case hex without leading zeros (same format as boost's str(0, hex | uppercase))
+    static const char digits[] = "0123456789ABCDEF";
+    char buffer[64];
+    for(auto i=0;i<hash_t::num_words;i++) {
+        auto word = hash.getWord(i);
+        for(auto j=0;j<16;j++) {
+            buffer[i * 16 + 15 - j] = digits[word & 0xF];
+            word >>= 4;
+        }
+    }
+    auto most_significant_bit = hash.getMostSignificantBit();
+    uint32_t num_digits = (most_significant_bit >= 0) ? most_significant_bit / 4 + 1 : 1;
+    return std::string(&buffer[sizeof(buffer) - num_digits], num_digits);
 }
 
 void scn::hash_helper::toArray(const hash_t& hash, uint8_t* array) {
-    hash_t temp = hash;
-    for(auto i=0;i<32;i++) {
-        array[32-1-i] = (uint8_t)temp;
-        temp >>= 8;
+    for(auto i=0;i<hash_t::num_words;i++) {
+        auto word = hash.getWord(i);
+        for(auto j=0;j<8;j++) {
+            array[i * 8 + 7 - j] = static_cast<uint8_t>(word);
+            word >>= 8;
+        }
     }
 }
 
 hash_t scn::hash_helper::fromArray(const uint8_t* array) {
-    hash_t ret = 0;
-    for(auto i=0;i<32;i++) {
-        ret <<=  8;
-        ret |= array[i];
+    uint64_t words[hash_t::num_words];
+    for(auto i=0;i<hash_t::num_words;i++) {
+        words[i] = 0;
+        for(auto j=0;j<8;j++) {
+            words[i] = (words[i] << 8) | array[i * 8 + j];
+        }
     }
-    return ret;
-}
\ No newline at end of file
+    return hash_t(words[0], words[1], words[2], words[3]);
+}
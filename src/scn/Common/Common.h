@@ -17,7 +17,7 @@
 #ifndef FULL_NODE_COMMON_H
 #define FULL_NODE_COMMON_H
 
-#include <boost/multiprecision/cpp_int.hpp>
+#include "Hash256.h"
 #include <cstdint>
 #include <glog/logging.h>
 #include <chrono>
@@ -25,7 +25,7 @@
 
 namespace scn {
 
-    typedef boost::multiprecision::uint256_t hash_t;
+    typedef Hash256 hash_t;
 
     typedef PublicKeyPEM public_key_t;
 
@@ -0,0 +1,139 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "CpuAffinity.h"
+#include <glog/logging.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace scn;
+
+std::mutex CpuAffinity::mtx_miner_cores_access_;
+std::vector<uint32_t> CpuAffinity::miner_cores_;
+
+
+bool CpuAffinity::parseCoreList(const std::string& core_list, std::vector<uint32_t>& cores) {
+    cores.clear();
+    std::stringstream stream(core_list);
+    std::string range;
+    while(std::getline(stream, range, ',')) {
+        range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+        if(range.empty()) {
+            continue;
+        }
+        auto dash_pos = range.find('-');
+        try {
+            size_t num_parsed = 0;
+            uint32_t first = std::stoul(range.substr(0, dash_pos), &num_parsed);
+            if(num_parsed != (dash_pos == std::string::npos ? range.length() : dash_pos)) {
+                return false;
+            }
+            uint32_t last = first;
+            if(dash_pos != std::string::npos) {
+                last = std::stoul(range.substr(dash_pos + 1), &num_parsed);
+                if(num_parsed != range.length() - dash_pos - 1 || last < first) {
+                    return false;
+                }
+            }
+            for(uint32_t core=first;core<=last;core++) {
+                cores.push_back(core);
+            }
+        } catch(const std::exception& e) {
+            return false;
+        }
+    }
+    std::sort(cores.begin(), cores.end());
+    cores.erase(std::unique(cores.begin(), cores.end()), cores.end());
+    return true;
+}
+
+std::vector<uint32_t> CpuAffinity::getCoresOfNumaNode(uint32_t numa_node) {
+    std::vector<uint32_t> cores;
+    std::ifstream cpulist_file("/sys/devices/system/node/node" + std::to_string(numa_node) + "/cpulist");
+    std::string cpulist;
+    if(!std::getline(cpulist_file, cpulist) || !parseCoreList(cpulist, cores)) {
+        cores.clear();
+    }
+    return cores;
+}
+
+uint32_t CpuAffinity::getNumCores() {
+    return std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+bool CpuAffinity::pinCurrentThread(const std::vector<uint32_t>& cores) {
+    const uint32_t num_cores = getNumCores();
+#ifdef _WIN32
+    DWORD_PTR mask = 0;
+    for(uint32_t core=0;core<num_cores && core<sizeof(DWORD_PTR)*8;core++) {
+        if(cores.empty() || std::binary_search(cores.begin(), cores.end(), core)) {
+            mask |= (static_cast<DWORD_PTR>(1) << core);
+        }
+    }
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for(uint32_t core=0;core<num_cores && core<CPU_SETSIZE;core++) {
+        if(cores.empty() || std::binary_search(cores.begin(), cores.end(), core)) {
+            CPU_SET(core, &cpu_set);
+        }
+    }
+    return CPU_COUNT(&cpu_set) > 0 && pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+#else
+    return false;
+#endif
+}
+
+void CpuAffinity::setMinerCores(const std::vector<uint32_t>& cores) {
+    std::lock_guard<std::mutex> lock(mtx_miner_cores_access_);
+    miner_cores_ = cores;
+    std::sort(miner_cores_.begin(), miner_cores_.end());
+}
+
+std::vector<uint32_t> CpuAffinity::getMinerCores() {
+    std::lock_guard<std::mutex> lock(mtx_miner_cores_access_);
+    return miner_cores_;
+}
+
+void CpuAffinity::isolateFromMinerCores() {
+    auto miner_cores = getMinerCores();
+    if(miner_cores.empty()) {
+        return;
+    }
+    std::vector<uint32_t> other_cores;
+    for(uint32_t core=0;core<getNumCores();core++) {
+        if(!std::binary_search(miner_cores.begin(), miner_cores.end(), core)) {
+            other_cores.push_back(core);
+        }
+    }
+    if(other_cores.empty()) {
+        LOG(WARNING) << "Miner cores cover all cores, consensus threads are not isolated";
+        return;
+    }
+    if(!pinCurrentThread(other_cores)) {
+        LOG(WARNING) << "Cannot isolate thread from miner cores";
+    }
+}
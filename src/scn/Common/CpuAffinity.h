@@ -0,0 +1,59 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FULL_NODE_CPUAFFINITY_H
+#define FULL_NODE_CPUAFFINITY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <mutex>
+
+namespace scn {
+
+    //pinning of threads to cores
+    //the miner cores are reserved for the mining threads, the consensus threads (state machine, block validation)
+    //keep away from them so that mining never delays a block
+    class CpuAffinity {
+    public:
+        //parses lists like "0-3,8,10-11" (format of the linux sysfs cpulist files), returns false on syntax errors
+        static bool parseCoreList(const std::string& core_list, std::vector<uint32_t>& cores);
+
+        //empty if the numa node does not exist or numa information is not available
+        static std::vector<uint32_t> getCoresOfNumaNode(uint32_t numa_node);
+
+        static uint32_t getNumCores();
+
+        //pins the calling thread to the given cores (all cores if empty), returns false if not supported
+        static bool pinCurrentThread(const std::vector<uint32_t>& cores);
+
+        //has to be set before the consensus and mining threads are started, threads only read it on startup
+        static void setMinerCores(const std::vector<uint32_t>& cores);
+
+        static std::vector<uint32_t> getMinerCores();
+
+        //pins the calling thread to all cores except the miner cores, nothing happens without miner cores or if
+        //the miner cores cover all cores
+        static void isolateFromMinerCores();
+
+    private:
+        static std::mutex mtx_miner_cores_access_;
+        static std::vector<uint32_t> miner_cores_;
+    };
+
+}
+
+#endif //FULL_NODE_CPUAFFINITY_H
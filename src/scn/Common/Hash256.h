@@ -0,0 +1,216 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FULL_NODE_HASH256_H
+#define FULL_NODE_HASH256_H
+
+#include <boost/multiprecision/cpp_int.hpp>
+#include <cstdint>
+#include <functional>
+#include <string>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#include <intrin.h>
+#endif
+
+namespace scn {
+
+    //256 bit unsigned value (SHA-256 digest) stored as four 64 bit words, most significant word first
+    //NOTE: apart from comparison and bit access only small increments are supported - for arithmetic convert to/from boost uint256_t
+    //NOTE: no over-alignment, hashes live in heap containers and nodes (no aligned loads on them)
+    class Hash256 {
+    public:
+        constexpr Hash256()
+        : words_{0, 0, 0, 0}
+        {}
+
+        //implicit, so that hashes can be initialized with and compared to small numbers (mostly 0)
+        constexpr Hash256(uint64_t value)
+        : words_{0, 0, 0, value}
+        {}
+
+        constexpr Hash256(uint64_t word_0, uint64_t word_1, uint64_t word_2, uint64_t word_3)
+        : words_{word_0, word_1, word_2, word_3}
+        {}
+
+        explicit Hash256(const boost::multiprecision::uint256_t& value)
+        : words_{static_cast<uint64_t>(value >> 192),
+                 static_cast<uint64_t>(value >> 128),
+                 static_cast<uint64_t>(value >> 64),
+                 static_cast<uint64_t>(value)}
+        {}
+
+        //accepts everything boost's uint256_t accepts (e.g. "0x" prefixed hex numbers)
+        explicit Hash256(const std::string& value)
+        : Hash256(boost::multiprecision::uint256_t(value))
+        {}
+
+        boost::multiprecision::uint256_t toUint256() const {
+            boost::multiprecision::uint256_t value = words_[0];
+            for(auto i=1;i<num_words;i++) {
+                value <<= 64;
+                value |= words_[i];
+            }
+            return value;
+        }
+
+        //index 0 is the most significant word
+        constexpr uint64_t getWord(uint32_t index) const {
+            return words_[index];
+        }
+
+        uint64_t* words() {
+            return words_;
+        }
+
+        const uint64_t* words() const {
+            return words_;
+        }
+
+        //bit 0 is the least significant bit
+        constexpr bool getBit(uint32_t bit) const {
+            return (words_[num_words - 1 - bit / 64] >> (bit % 64)) & 1;
+        }
+
+        //-1 if value is 0
+        int32_t getMostSignificantBit() const {
+            for(auto i=0;i<num_words;i++) {
+                if(words_[i] != 0) {
+                    return (num_words - 1 - i) * 64 + mostSignificantBitOfWord(words_[i]);
+                }
+            }
+            return -1;
+        }
+
+        //word must not be 0
+        static int32_t mostSignificantBitOfWord(uint64_t word) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+            unsigned long index;
+            _BitScanReverse64(&index, word);
+            return static_cast<int32_t>(index);
+#elif defined(__GNUC__)
+            return 63 - __builtin_clzll(word);
+#else
+            int32_t index = 0;
+            while(word >>= 1) {
+                index++;
+            }
+            return index;
+#endif
+        }
+
+        constexpr Hash256 operator^(const Hash256& rhs) const {
+            return Hash256(words_[0] ^ rhs.words_[0], words_[1] ^ rhs.words_[1],
+                           words_[2] ^ rhs.words_[2], words_[3] ^ rhs.words_[3]);
+        }
+
+        //addition/subtraction of small numbers (wraps around like uint256_t)
+        Hash256 operator+(uint64_t rhs) const {
+            Hash256 result(*this);
+            for(auto i=num_words-1;i>=0;i--) {
+                result.words_[i] += rhs;
+                if(result.words_[i] >= rhs) {
+                    break;
+                }
+                rhs = 1; //carry
+            }
+            return result;
+        }
+
+        Hash256 operator-(uint64_t rhs) const {
+            Hash256 result(*this);
+            for(auto i=num_words-1;i>=0;i--) {
+                auto word = result.words_[i];
+                result.words_[i] -= rhs;
+                if(word >= rhs) {
+                    break;
+                }
+                rhs = 1; //borrow
+            }
+            return result;
+        }
+
+        Hash256& operator++() {
+            return *this = *this + 1;
+        }
+
+        Hash256 operator++(int) {
+            Hash256 previous(*this);
+            ++*this;
+            return previous;
+        }
+
+        Hash256& operator--() {
+            return *this = *this - 1;
+        }
+
+        Hash256 operator--(int) {
+            Hash256 previous(*this);
+            --*this;
+            return previous;
+        }
+
+        static constexpr Hash256 max() {
+            return Hash256(UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX);
+        }
+
+        friend constexpr bool operator==(const Hash256& lhs, const Hash256& rhs) {
+            return lhs.words_[0] == rhs.words_[0] && lhs.words_[1] == rhs.words_[1] &&
+                   lhs.words_[2] == rhs.words_[2] && lhs.words_[3] == rhs.words_[3];
+        }
+
+        friend constexpr bool operator!=(const Hash256& lhs, const Hash256& rhs) {
+            return !(lhs == rhs);
+        }
+
+        friend constexpr bool operator<(const Hash256& lhs, const Hash256& rhs) {
+            return lhs.words_[0] != rhs.words_[0] ? lhs.words_[0] < rhs.words_[0] :
+                   lhs.words_[1] != rhs.words_[1] ? lhs.words_[1] < rhs.words_[1] :
+                   lhs.words_[2] != rhs.words_[2] ? lhs.words_[2] < rhs.words_[2] :
+                   lhs.words_[3] < rhs.words_[3];
+        }
+
+        friend constexpr bool operator>(const Hash256& lhs, const Hash256& rhs) {
+            return rhs < lhs;
+        }
+
+        friend constexpr bool operator<=(const Hash256& lhs, const Hash256& rhs) {
+            return !(rhs < lhs);
+        }
+
+        friend constexpr bool operator>=(const Hash256& lhs, const Hash256& rhs) {
+            return !(lhs < rhs);
+        }
+
+        static const int num_words = 4;
+
+    private:
+        uint64_t words_[num_words];
+    };
+
+}
+
+namespace std {
+
+    template<>
+    struct hash<scn::Hash256> {
+        size_t operator()(const scn::Hash256& hash) const {
+            return static_cast<size_t>(hash.getWord(3)); //bits of a digest are uniformly distributed
+        }
+    };
+
+}
+
+#endif //FULL_NODE_HASH256_H
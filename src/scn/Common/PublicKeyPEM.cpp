@@ -15,11 +15,67 @@
  */
 
 #include "PublicKeyPEM.h"
+#include "Common.h"
 #include <sstream>
 #include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
 
 using namespace scn;
 
+
+//one entry per distinct short string, removed when the last handle is gone (so invalid keys received from peers
+//do not accumulate)
+class PublicKeyPEM::InternTable {
+public:
+    std::shared_ptr<const InternedKey> intern(const std::string& short_string) {
+        LOCK_MUTEX_WATCHDOG(mtx_access_);
+        auto& entry = keys_[short_string];
+        auto key = entry.lock();
+        if(key) {
+            return key;
+        }
+
+        uint32_t id;
+        if(free_ids_.empty()) {
+            id = next_id_++;
+        } else {
+            id = free_ids_.back();
+            free_ids_.pop_back();
+        }
+        key = std::shared_ptr<const InternedKey>(new InternedKey{short_string, id}, [this](const InternedKey* expired_key) {
+            release(expired_key);
+        });
+        entry = key;
+        return key;
+    }
+
+    uint32_t size() const {
+        LOCK_MUTEX_WATCHDOG(mtx_access_);
+        return keys_.size();
+    }
+
+protected:
+    void release(const InternedKey* expired_key) {
+        {
+            LOCK_MUTEX_WATCHDOG(mtx_access_);
+            auto it = keys_.find(expired_key->short_string);
+            //the string may have been interned again in the meantime (with another id)
+            if(it != keys_.end() && it->second.expired()) {
+                keys_.erase(it);
+            }
+            free_ids_.push_back(expired_key->id);
+        }
+        delete expired_key;
+    }
+
+    mutable std::mutex mtx_access_;
+    std::unordered_map<std::string, std::weak_ptr<const InternedKey>> keys_;
+    std::vector<uint32_t> free_ids_;
+    uint32_t next_id_ = 1; //0 is the empty key
+};
+
 const std::string PublicKeyPEM::prefix_ = "-----BEGIN PUBLIC KEY-----\n";
 const std::string PublicKeyPEM::postfix_ = "\n-----END PUBLIC KEY-----";
 
@@ -37,7 +93,7 @@ PublicKeyPEM::PublicKeyPEM(const std::string& public_key_string) {
 
 
 PublicKeyPEM::PublicKeyPEM()
-:short_string_() {
+:key_() {
 
 }
 
@@ -46,38 +102,65 @@ PublicKeyPEM::~PublicKeyPEM() = default;
 
 
 void PublicKeyPEM::initFromString(const std::string &public_key_string) {
-    //read part between prefix and postfix to minimum_string_
+    //read part between prefix and postfix to short_string
     auto start_index = public_key_string.find(prefix_);
     auto end_index = public_key_string.find(postfix_);
     if(start_index == std::string::npos || end_index == std::string::npos) {
-        short_string_ = "";
+        key_ = nullptr;
         return;
     }
     start_index += prefix_.length();
     if(start_index > end_index) {
-        short_string_ = "";
+        key_ = nullptr;
         return;
     }
-    short_string_ = public_key_string.substr(start_index, end_index-start_index+1);
+    auto short_string = public_key_string.substr(start_index, end_index-start_index+1);
 
     //remove blanks, tabs, line breaks
-    short_string_.erase(std::remove(short_string_.begin(), short_string_.end(), ' '), short_string_.end());
-    short_string_.erase(std::remove(short_string_.begin(), short_string_.end(), '\t'), short_string_.end());
-    short_string_.erase(std::remove(short_string_.begin(), short_string_.end(), '\n'), short_string_.end());
-    short_string_.erase(std::remove(short_string_.begin(), short_string_.end(), '\r'), short_string_.end());
+    short_string.erase(std::remove(short_string.begin(), short_string.end(), ' '), short_string.end());
+    short_string.erase(std::remove(short_string.begin(), short_string.end(), '\t'), short_string.end());
+    short_string.erase(std::remove(short_string.begin(), short_string.end(), '\n'), short_string.end());
+    short_string.erase(std::remove(short_string.begin(), short_string.end(), '\r'), short_string.end());
+    key_ = intern(short_string);
 }
 
 
 std::string PublicKeyPEM::getAsFullString() const {
-    return prefix_ + short_string_ + postfix_;
+    return prefix_ + getAsShortString() + postfix_;
 }
 
 
-std::string PublicKeyPEM::getAsShortString() const {
-    return short_string_;
+const std::string& PublicKeyPEM::getAsShortString() const {
+    static const std::string empty_string;
+    return key_ ? key_->short_string : empty_string;
 }
 
 
 bool PublicKeyPEM::isEmpty() const {
-    return short_string_.length() == 0;
+    return !key_;
+}
+
+
+uint32_t PublicKeyPEM::getId() const {
+    return key_ ? key_->id : 0;
+}
+
+
+uint32_t PublicKeyPEM::numInternedKeys() {
+    return getInternTable().size();
+}
+
+
+std::shared_ptr<const PublicKeyPEM::InternedKey> PublicKeyPEM::intern(const std::string& short_string) {
+    if(short_string.empty()) {
+        return nullptr;
+    }
+    return getInternTable().intern(short_string);
+}
+
+
+PublicKeyPEM::InternTable& PublicKeyPEM::getInternTable() {
+    //never destroyed, keys in static objects may outlive any static table
+    static auto intern_table = new InternTable();
+    return *intern_table;
 }
\ No newline at end of file
@@ -19,9 +19,13 @@
 
 #include <string>
 #include <fstream>
+#include <memory>
 
 namespace scn {
 
+    //public key in PEM format, only the part between prefix and postfix is stored (short string)
+    //every distinct short string exists once per process (interned), a key is a handle to it: copies share the
+    //string and equality and hashing only compare the 32 bit id of the handle
     class PublicKeyPEM {
     public:
         explicit PublicKeyPEM(const std::ifstream &public_key_file_stream);
@@ -34,47 +38,84 @@ namespace scn {
 
         std::string getAsFullString() const;
 
-        std::string getAsShortString() const;
+        const std::string& getAsShortString() const;
 
         bool isEmpty() const;
 
+        //unique among all keys alive in this process, 0 for the empty key
+        //NOTE: ids are reused after all handles of a key are gone, never persist them
+        uint32_t getId() const;
+
+        //number of distinct keys alive in this process
+        static uint32_t numInternedKeys();
+
+        template<class Archive>
+        void save(Archive& ar) const {
+            ar & getAsShortString();
+        }
+
         template<class Archive>
-        void ser(Archive& ar) {
-            ar & short_string_;
+        void load(Archive& ar) {
+            std::string short_string;
+            ar & short_string;
+            key_ = intern(short_string);
         }
 
     protected:
+        struct InternedKey {
+            std::string short_string;
+            uint32_t id;
+        };
+
+        class InternTable;
+
         static const std::string prefix_;
         static const std::string postfix_;
 
-        std::string short_string_;
+        std::shared_ptr<const InternedKey> key_; //nullptr for the empty key
 
         void initFromString(const std::string &public_key_string);
+
+        static std::shared_ptr<const InternedKey> intern(const std::string& short_string);
+
+        static InternTable& getInternTable();
     };
 
     inline bool operator==(const PublicKeyPEM& lhs, const PublicKeyPEM& rhs) {
-        return lhs.getAsShortString() == rhs.getAsShortString();
+        return lhs.getId() == rhs.getId();
     }
 
     inline bool operator!=(const PublicKeyPEM& lhs, const PublicKeyPEM& rhs){
         return !(lhs == rhs);
     }
 
+    //NOTE: ordering stays lexicographic by short string, it defines the serialized order of wallet maps
     inline bool operator<(const PublicKeyPEM& lhs, const PublicKeyPEM& rhs) {
-        return lhs.getAsShortString() < rhs.getAsShortString();
+        return lhs != rhs && lhs.getAsShortString() < rhs.getAsShortString();
     }
 
     inline bool operator>(const PublicKeyPEM& lhs, const PublicKeyPEM& rhs) {
-        return lhs.getAsShortString() > rhs.getAsShortString();
+        return rhs < lhs;
     }
 
     inline bool operator<=(const PublicKeyPEM& lhs, const PublicKeyPEM& rhs) {
-        return lhs.getAsShortString() <= rhs.getAsShortString();
+        return !(rhs < lhs);
     }
 
     inline bool operator>=(const PublicKeyPEM& lhs, const PublicKeyPEM& rhs) {
-        return lhs.getAsShortString() >= rhs.getAsShortString();
+        return !(lhs < rhs);
     }
 }
 
+namespace std {
+
+    template<>
+    struct hash<scn::PublicKeyPEM> {
+        size_t operator()(const scn::PublicKeyPEM& public_key) const {
+            return static_cast<size_t>(public_key.getId()) * 0x9E3779B97F4A7C15ull; //spread consecutive ids
+        }
+    };
+
+}
+
 #endif //FULL_NODE_PUBLICKEYPEM_H
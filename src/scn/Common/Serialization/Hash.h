@@ -18,27 +18,41 @@
 #define FULL_NODE_HASH_H
 
 #include "scn/Common/Common.h"
+#include <cereal/cereal.hpp>
 
 namespace cereal {
 
-    //serialization of boost multiprecision type
-    template<class Archive>
+    //serialization of hash type - four 64 bit words, most significant word first
+    //binary archives write all words at once (same bytes as four single words, incl. endianness handling)
+    template<class Archive,
+             traits::DisableIf<traits::is_text_archive<Archive>::value> = traits::sfinae>
     void save(Archive &archive,
               scn::hash_t const &m) {
-        for (auto i = 3; i >= 0; i--) {
-            archive << (uint64_t) (m >> (i * 64));
+        archive(binary_data(m.words(), sizeof(uint64_t) * scn::hash_t::num_words));
+    }
+
+    template<class Archive,
+             traits::DisableIf<traits::is_text_archive<Archive>::value> = traits::sfinae>
+    void load(Archive &archive,
+              scn::hash_t &m) {
+        archive(binary_data(m.words(), sizeof(uint64_t) * scn::hash_t::num_words));
+    }
+
+    template<class Archive,
+             traits::EnableIf<traits::is_text_archive<Archive>::value> = traits::sfinae>
+    void save(Archive &archive,
+              scn::hash_t const &m) {
+        for (auto i = 0; i < scn::hash_t::num_words; i++) {
+            archive << m.getWord(i);
         }
     }
 
-    template<class Archive>
+    template<class Archive,
+             traits::EnableIf<traits::is_text_archive<Archive>::value> = traits::sfinae>
     void load(Archive &archive,
               scn::hash_t &m) {
-        m = 0;
-        for (auto i = 0; i < 4; i++) {
-            m = (m << 64);
-            uint64_t buffer;
-            archive >> buffer;
-            m += buffer;
+        for (auto i = 0; i < scn::hash_t::num_words; i++) {
+            archive >> m.words()[i];
         }
     }
 
@@ -27,6 +27,9 @@
 
 using namespace scn;
 
+PublicKeyCache CryptoHelper::public_key_cache_;
+CryptoHelper::CollectionBlockHashMode CryptoHelper::collection_block_hash_mode_ = CryptoHelper::CollectionBlockHashMode::Serialized;
+
 CryptoHelper::CryptoHelper(const private_key_t& private_key) {
     private_ec_ = createPrivateEC(private_key);
     if(private_ec_ == nullptr) {
@@ -70,6 +73,78 @@ hash_t CryptoHelper::calcHash(const void* data, uint32_t length) {
     return hash_helper::fromArray(hash);
 }
 
+std::vector<hash_t> CryptoHelper::calcHashBatch(const std::vector<const std::string*>& data) {
+    return MultiBufferHash::calcHashes(data);
+}
+
+void CryptoHelper::fillHash(CollectionBlock& block) {
+    if(collection_block_hash_mode_ == CollectionBlockHashMode::Serialized) {
+        fillHash<CollectionBlock>(block);
+        return;
+    }
+    assert(block.header.generic_header.block_hash == 0);
+    std::vector<hash_t> transaction_hashes, creation_hashes;
+    transaction_hashes.reserve(block.transactions.size());
+    creation_hashes.reserve(block.creations.size());
+    for(auto& transaction : block.transactions) {
+        transaction_hashes.push_back(transaction.first);
+    }
+    for(auto& creation : block.creations) {
+        creation_hashes.push_back(creation.first);
+    }
+    block.header.generic_header.block_hash = calcMerkleBlockHash(block,
+                                                                 MerkleTree::calcRoot(transaction_hashes),
+                                                                 MerkleTree::calcRoot(creation_hashes));
+}
+
+bool CryptoHelper::verifyHash(const CollectionBlock& block) {
+    if(collection_block_hash_mode_ == CollectionBlockHashMode::Serialized) {
+        return verifyHash<CollectionBlock>(block);
+    }
+    //only the map keys are part of the Merkle roots, so they have to match the (separately verified) sub block hashes
+    std::vector<hash_t> transaction_hashes, creation_hashes;
+    transaction_hashes.reserve(block.transactions.size());
+    creation_hashes.reserve(block.creations.size());
+    for(auto& transaction : block.transactions) {
+        if(transaction.first != transaction.second.header.generic_header.block_hash) {
+            return false;
+        }
+        transaction_hashes.push_back(transaction.first);
+    }
+    for(auto& creation : block.creations) {
+        if(creation.first != creation.second.header.generic_header.block_hash) {
+            return false;
+        }
+        creation_hashes.push_back(creation.first);
+    }
+    return block.header.generic_header.block_hash == calcMerkleBlockHash(block,
+                                                                         MerkleTree::calcRoot(transaction_hashes),
+                                                                         MerkleTree::calcRoot(creation_hashes));
+}
+
+void CryptoHelper::setCollectionBlockHashMode(CollectionBlockHashMode mode) {
+    collection_block_hash_mode_ = mode;
+}
+
+CryptoHelper::CollectionBlockHashMode CryptoHelper::getCollectionBlockHashMode() {
+    return collection_block_hash_mode_;
+}
+
+hash_t CryptoHelper::calcMerkleBlockHash(const CollectionBlock& block, const hash_t& transactions_root, const hash_t& creations_root) {
+    HashStreamBuf hash_buf;
+    std::ostream hash_stream(&hash_buf);
+    {
+        cereal::PortableBinaryOutputArchive oa(hash_stream);
+        hash_buf.substituteNextBytes(std::string(serialized_hash_size, '\0'));
+        oa << static_cast<const BaseBlock&>(block);
+    }
+    uint8_t roots[2 * serialized_hash_size];
+    hash_helper::toArray(transactions_root, &roots[0]);
+    hash_helper::toArray(creations_root, &roots[serialized_hash_size]);
+    hash_stream.write(reinterpret_cast<const char*>(roots), sizeof(roots));
+    return hash_buf.digestHash();
+}
+
 signature_t CryptoHelper::calcSignature(const std::string &data) {
     EVP_MD_CTX *ctx = EVP_MD_CTX_create();
     EVP_PKEY *private_key = EVP_PKEY_new();
@@ -103,42 +178,59 @@ signature_t CryptoHelper::calcSignature(const std::string &data) {
 
 bool CryptoHelper::verifySignature(const std::string &data, const signature_t &signature, const public_key_t& public_key) {
     std::string signature_raw = decode64(signature);
-    EC_KEY* public_ec = createPublicEC(public_key);
-    if(public_ec == nullptr) {
+    auto public_key_int = public_key_cache_.getKey(public_key);
+    if(public_key_int == nullptr) {
         return false;
     }
 
-    EVP_MD_CTX *ctx = EVP_MD_CTX_create();
-    EVP_PKEY *public_key_int = EVP_PKEY_new();
-    EVP_PKEY_assign_EC_KEY(public_key_int, public_ec);
-    if (EVP_DigestVerifyInit(ctx, nullptr, EVP_sha256(), nullptr, public_key_int) <= 0) {
-        EC_KEY_free(public_ec);
-        EVP_MD_CTX_destroy(ctx);
+    //digest contexts are reused per thread instead of being allocated for every signature
+    static thread_local std::unique_ptr<EVP_MD_CTX, void(*)(EVP_MD_CTX*)> thread_ctx(EVP_MD_CTX_new(), EVP_MD_CTX_free);
+    EVP_MD_CTX *ctx = thread_ctx.get();
+    if (ctx == nullptr) {
+        return false;
+    }
+    EVP_MD_CTX_reset(ctx);
+    if (EVP_DigestVerifyInit(ctx, nullptr, EVP_sha256(), nullptr, public_key_int.get()) <= 0) {
         return false;
     }
     if (EVP_DigestVerifyUpdate(ctx, data.c_str(), data.length()) <= 0) {
-        EC_KEY_free(public_ec);
-        EVP_MD_CTX_destroy(ctx);
         return false;
     }
     int AuthStatus = EVP_DigestVerifyFinal(ctx, reinterpret_cast<const unsigned char*>(signature_raw.c_str()), signature_raw.length());
-    if (AuthStatus == 1) {
-        EC_KEY_free(public_ec);
-        EVP_MD_CTX_destroy(ctx);
-        return true;
-    } else {
-        EC_KEY_free(public_ec);
-        EVP_MD_CTX_destroy(ctx);
+    return AuthStatus == 1;
+}
+
+
+bool CryptoHelper::verifySignatureOfDigest(const uint8_t* digest, const signature_t& signature, const public_key_t& public_key) {
+    std::string signature_raw = decode64(signature);
+    auto public_key_int = public_key_cache_.getKey(public_key);
+    if(public_key_int == nullptr) {
+        return false;
+    }
+
+    std::unique_ptr<EVP_PKEY_CTX, void(*)(EVP_PKEY_CTX*)> ctx(EVP_PKEY_CTX_new(public_key_int.get(), nullptr), EVP_PKEY_CTX_free);
+    if (ctx == nullptr) {
         return false;
     }
+    if (EVP_PKEY_verify_init(ctx.get()) <= 0) {
+        return false;
+    }
+    if (EVP_PKEY_CTX_set_signature_md(ctx.get(), EVP_sha256()) <= 0) {
+        return false;
+    }
+    int AuthStatus = EVP_PKEY_verify(ctx.get(), reinterpret_cast<const unsigned char*>(signature_raw.c_str()), signature_raw.length(),
+                                     digest, SHA256_DIGEST_LENGTH);
+    return AuthStatus == 1;
 }
 
 
 bool CryptoHelper::isPublicKeyValid(const public_key_t& public_key) {
-    EC_KEY* key = createPublicEC(public_key);
-    bool valid = (key != nullptr);
-    EC_KEY_free(key);
-    return valid;
+    return public_key_cache_.getKey(public_key) != nullptr;
+}
+
+
+PublicKeyCache& CryptoHelper::getPublicKeyCache() {
+    return public_key_cache_;
 }
 
 
@@ -150,20 +242,6 @@ bool CryptoHelper::isPrivateKeyValid(const private_key_t& private_key) {
 }
 
 
-EC_KEY *CryptoHelper::createPublicEC(const public_key_t &public_key) {
-    EC_KEY *ec_key = nullptr;
-    BIO *keybio;
-    auto public_key_string = public_key.getAsFullString();
-    keybio = BIO_new_mem_buf((void *)public_key_string.c_str(), public_key_string.length());
-    if (keybio == nullptr) {
-        return nullptr;
-    }
-    ec_key = PEM_read_bio_EC_PUBKEY(keybio, &ec_key, nullptr, nullptr);
-    BIO_free(keybio);
-    return ec_key;
-}
-
-
 EC_KEY *CryptoHelper::createPrivateEC(const private_key_t &private_key) {
     EC_KEY *ec_key = nullptr;
     BIO *keybio = BIO_new_mem_buf((void *) private_key.c_str(), private_key.length());
@@ -20,6 +20,9 @@
 #include "scn/Common/Common.h"
 #include "scn/Blockchain/BlockDefinitions.h"
 #include "HashStreamBuf.h"
+#include "PublicKeyCache.h"
+#include "MultiBufferHash.h"
+#include "MerkleTree.h"
 #include <cereal/archives/portable_binary.hpp>
 #include <openssl/ecdsa.h>
 #include <openssl/sha.h>
@@ -40,12 +43,33 @@ namespace scn {
 
         static hash_t calcHash(const void* data, uint32_t length);
 
+        //hashes many short messages at once (multi buffer SIMD if supported by the CPU)
+        static std::vector<hash_t> calcHashBatch(const std::vector<const std::string*>& data);
+
         template<class BLOCK>
         static void fillHash(BLOCK& block);
 
         template<class BLOCK>
         static bool verifyHash(const BLOCK& block);
 
+        //collection blocks are hashed according to getCollectionBlockHashMode()
+        static void fillHash(CollectionBlock& block);
+
+        static bool verifyHash(const CollectionBlock& block);
+
+        enum class CollectionBlockHashMode : uint8_t {
+            Serialized = 0, //hash of the complete serialized block
+            MerkleRoot = 1  //hash of the serialized header and the Merkle roots of transaction and creation hashes
+        };
+
+        //NOTE: has to be the same on all nodes of a network
+        static void setCollectionBlockHashMode(CollectionBlockHashMode mode);
+
+        static CollectionBlockHashMode getCollectionBlockHashMode();
+
+        //block hash in MerkleRoot mode, roots are MerkleTree roots over the keys of transactions and creations
+        static hash_t calcMerkleBlockHash(const CollectionBlock& block, const hash_t& transactions_root, const hash_t& creations_root);
+
         virtual signature_t calcSignature(const std::string& data);
 
         static bool verifySignature(const std::string& data, const signature_t& signature, const public_key_t& public_key);
@@ -56,10 +80,15 @@ namespace scn {
         template<class BLOCK>
         static bool verifySignature(const BLOCK& block, const public_key_t& public_key);
 
+        //digest has to be the SHA-256 digest (32 bytes) of the signed data
+        static bool verifySignatureOfDigest(const uint8_t* digest, const signature_t& signature, const public_key_t& public_key);
+
         static bool isPublicKeyValid(const public_key_t& public_key);
 
         static bool isPrivateKeyValid(const private_key_t& private_key);
 
+        static PublicKeyCache& getPublicKeyCache();
+
         class Hash {
         public:
             Hash();
@@ -69,8 +98,10 @@ namespace scn {
             SHA256_CTX context_;
         };
 
+        static const uint32_t serialized_hash_size = 32;
+        static const uint32_t serialized_string_size_tag_size = sizeof(uint64_t);
+
     private:
-        static EC_KEY* createPublicEC(const public_key_t& public_key);
         static EC_KEY* createPrivateEC(const private_key_t& private_key);
 
         static size_t calcDecodeLength(const std::string &val);
@@ -78,6 +109,10 @@ namespace scn {
         static std::string encode64(const std::string &val);
 
         EC_KEY* private_ec_;
+
+        static PublicKeyCache public_key_cache_;
+
+        static CollectionBlockHashMode collection_block_hash_mode_;
     };
 
     template<class BLOCK>
@@ -90,15 +125,15 @@ namespace scn {
         block.header.generic_header.block_hash = hash_buf.digestHash();
     }
 
-    //todo: avoid copying block
+    //block_hash is the first serialized field of every block, so it is substituted by zero while streaming
+    //instead of hashing a copy of the block
     template<class BLOCK>
     bool CryptoHelper::verifyHash(const BLOCK& block) {
-        BLOCK block_copy = block;
-        block_copy.header.generic_header.block_hash = 0;
         HashStreamBuf hash_buf;
         std::ostream hash_stream(&hash_buf);
         cereal::PortableBinaryOutputArchive oa(hash_stream);
-        oa << block_copy;
+        hash_buf.substituteNextBytes(std::string(serialized_hash_size, '\0'));
+        oa << block;
         return block.header.generic_header.block_hash == hash_buf.digestHash();
     }
 
@@ -112,15 +147,20 @@ namespace scn {
         block.signature = calcSignature(oss.str());
     }
 
+    //block_hash is the first and signature the last serialized field of every sub block, so both are
+    //substituted by their empty values while streaming - the signed data is never built in memory
     template<class BLOCK>
     bool CryptoHelper::verifySignature(const BLOCK& block, const public_key_t& public_key) {
-        BLOCK block_copy = block;
-        block_copy.header.generic_header.block_hash = 0;
-        block_copy.signature = "";
-        std::stringstream oss;
-        cereal::PortableBinaryOutputArchive oa(oss);
-        oa << block_copy;
-        return verifySignature(oss.str(), block.signature, public_key);
+        HashStreamBuf hash_buf;
+        hash_buf.substituteTrailingBytes(serialized_string_size_tag_size + block.signature.length(),
+                                         std::string(serialized_string_size_tag_size, '\0'));
+        std::ostream hash_stream(&hash_buf);
+        cereal::PortableBinaryOutputArchive oa(hash_stream);
+        hash_buf.substituteNextBytes(std::string(serialized_hash_size, '\0'));
+        oa << block;
+        uint8_t digest[SHA256_DIGEST_LENGTH];
+        hash_buf.digestArray(digest);
+        return verifySignatureOfDigest(digest, block.signature, public_key);
     }
 }
 
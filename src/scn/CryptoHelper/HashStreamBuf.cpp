@@ -15,12 +15,18 @@
  */
 
 #include "HashStreamBuf.h"
+#include <cstring>
 
 using namespace scn;
 
 
 HashStreamBuf::HashStreamBuf(uint32_t buffer_size)
-:buffer_(buffer_size + 1) {
+:buffer_(buffer_size + 1)
+,num_bytes_hashed_(0)
+,next_substitute_offset_(0)
+,next_substitute_()
+,num_trailing_bytes_(0)
+,trailing_substitute_() {
     char* base = &buffer_.front();
     setp (base, base + buffer_.size() - 1);
 
@@ -34,19 +40,68 @@ HashStreamBuf::~HashStreamBuf() {
 
 
 hash_t HashStreamBuf::digestHash() {
-    (void)flushBuffer();
     unsigned char hash[SHA256_DIGEST_LENGTH];
-    SHA256_Final(hash, &sha256_);
-    hash_t ret = hash_helper::fromArray(hash);
+    digestArray(hash);
+    return hash_helper::fromArray(hash);
+}
+
+
+void HashStreamBuf::digestArray(uint8_t* array) {
+    (void)flushBuffer(true);
+    SHA256_Final(array, &sha256_);
     SHA256_Init(&sha256_);
-    return ret;
+    num_bytes_hashed_ = 0;
+    next_substitute_offset_ = 0;
+    next_substitute_.clear();
+    num_trailing_bytes_ = 0;
+    trailing_substitute_.clear();
 }
 
 
-bool HashStreamBuf::flushBuffer() {
+void HashStreamBuf::substituteNextBytes(const std::string& substitute) {
+    next_substitute_offset_ = num_bytes_hashed_ + (pptr() - pbase());
+    next_substitute_ = substitute;
+}
+
+
+void HashStreamBuf::substituteTrailingBytes(uint32_t num_bytes, const std::string& substitute) {
+    num_trailing_bytes_ = num_bytes;
+    trailing_substitute_ = substitute;
+    //trailing bytes are held back in the buffer, so it has to provide some room beyond them
+    if(buffer_.size() <= 2 * num_bytes + 1) {
+        auto num_pending = pptr() - pbase();
+        buffer_.resize(2 * num_bytes + 2);
+        char* base = &buffer_.front();
+        setp (base, base + buffer_.size() - 1);
+        pbump(num_pending);
+    }
+}
+
+
+bool HashStreamBuf::flushBuffer(bool final) {
     int num = pptr() - pbase();
-    SHA256_Update(&sha256_, &buffer_.front(), num);
-    pbump (-num);
+    //hold back the bytes which might be the trailing bytes to substitute
+    int num_to_hash = std::max(num - static_cast<int>(num_trailing_bytes_), 0);
+    uint64_t substitute_begin = std::max(next_substitute_offset_, num_bytes_hashed_);
+    uint64_t substitute_end = std::min(next_substitute_offset_ + next_substitute_.length(), num_bytes_hashed_ + num_to_hash);
+    if(substitute_begin < substitute_end) {
+        std::memcpy(pbase() + (substitute_begin - num_bytes_hashed_),
+                    next_substitute_.data() + (substitute_begin - next_substitute_offset_),
+                    substitute_end - substitute_begin);
+    }
+    SHA256_Update(&sha256_, pbase(), num_to_hash);
+    num_bytes_hashed_ += num_to_hash;
+    if(final) {
+        //the held back bytes are dropped and replaced by the substitute
+        if(num_trailing_bytes_ > 0) {
+            SHA256_Update(&sha256_, trailing_substitute_.data(), trailing_substitute_.length());
+            num_bytes_hashed_ += trailing_substitute_.length();
+        }
+        pbump(-num);
+    } else {
+        std::memmove(pbase(), pbase() + num_to_hash, num - num_to_hash);
+        pbump(-num_to_hash);
+    }
     return num;
 }
 
@@ -32,9 +32,17 @@ namespace scn {
 
         hash_t digestHash();
 
+        void digestArray(uint8_t* array);
+
+        //the next bytes written to the stream are hashed as substitute instead
+        void substituteNextBytes(const std::string& substitute);
+
+        //the last num_bytes written to the stream are hashed as substitute instead
+        void substituteTrailingBytes(uint32_t num_bytes, const std::string& substitute);
+
     protected:
 
-        bool flushBuffer();
+        bool flushBuffer(bool final = false);
 
         int_type overflow (int_type c) override;
 
@@ -42,6 +50,12 @@ namespace scn {
 
         std::vector<char> buffer_;
         SHA256_CTX sha256_;
+
+        uint64_t num_bytes_hashed_;
+        uint64_t next_substitute_offset_;
+        std::string next_substitute_;
+        uint32_t num_trailing_bytes_;
+        std::string trailing_substitute_;
     };
 
 }
@@ -0,0 +1,230 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MerkleTree.h"
+#include <openssl/sha.h>
+#include <algorithm>
+
+using namespace scn;
+
+
+MerkleTree::MerkleTree()
+:root_()
+,size_(0) {
+}
+
+
+MerkleTree::~MerkleTree() = default;
+
+
+bool MerkleTree::insert(const hash_t& leaf) {
+    if(!root_) {
+        root_ = createLeafNode(leaf);
+        size_++;
+        return true;
+    }
+
+    //find the leaf which shares the longest prefix with the new one
+    Node* node = root_.get();
+    while(node->crit_bit >= 0) {
+        node = node->child[getBit(leaf, node->crit_bit)].get();
+    }
+    auto crit_bit = getCritBit(leaf, node->leaf);
+    if(crit_bit < 0) {
+        return false;
+    }
+
+    insert(root_, leaf, crit_bit);
+    size_++;
+    return true;
+}
+
+
+bool MerkleTree::erase(const hash_t& leaf) {
+    if(!erase(root_, leaf)) {
+        return false;
+    }
+    size_--;
+    return true;
+}
+
+
+bool MerkleTree::contains(const hash_t& leaf) const {
+    Node* node = root_.get();
+    if(node == nullptr) {
+        return false;
+    }
+    while(node->crit_bit >= 0) {
+        node = node->child[getBit(leaf, node->crit_bit)].get();
+    }
+    return node->leaf == leaf;
+}
+
+
+void MerkleTree::clear() {
+    root_.reset();
+    size_ = 0;
+}
+
+
+uint32_t MerkleTree::size() const {
+    return size_;
+}
+
+
+hash_t MerkleTree::getRoot() const {
+    return root_ ? root_->hash : hash_t(0);
+}
+
+
+bool MerkleTree::getProof(const hash_t& leaf, MerkleProof& proof) const {
+    proof.steps.clear();
+    Node* node = root_.get();
+    if(node == nullptr) {
+        return false;
+    }
+    while(node->crit_bit >= 0) {
+        auto direction = getBit(leaf, node->crit_bit);
+        proof.steps.push_back({node->child[!direction]->hash, direction});
+        node = node->child[direction].get();
+    }
+    if(node->leaf != leaf) {
+        proof.steps.clear();
+        return false;
+    }
+    std::reverse(proof.steps.begin(), proof.steps.end());
+    return true;
+}
+
+
+bool MerkleTree::verifyProof(const hash_t& leaf, const MerkleProof& proof, const hash_t& root) {
+    hash_t hash = calcLeafHash(leaf);
+    for(auto& step : proof.steps) {
+        hash = step.sibling_is_left ? calcInnerHash(step.sibling_hash, hash) : calcInnerHash(hash, step.sibling_hash);
+    }
+    return hash == root;
+}
+
+
+hash_t MerkleTree::calcRoot(const std::vector<hash_t>& sorted_leaves) {
+    if(sorted_leaves.empty()) {
+        return 0;
+    }
+    return calcRoot(sorted_leaves.begin(), sorted_leaves.end());
+}
+
+
+std::unique_ptr<MerkleTree::Node> MerkleTree::createLeafNode(const hash_t& leaf) {
+    std::unique_ptr<Node> node(new Node());
+    node->leaf = leaf;
+    node->crit_bit = -1;
+    node->hash = calcLeafHash(leaf);
+    return node;
+}
+
+
+void MerkleTree::updateInnerNodeHash(Node& node) {
+    node.hash = calcInnerHash(node.child[0]->hash, node.child[1]->hash);
+}
+
+
+hash_t MerkleTree::calcLeafHash(const hash_t& leaf) {
+    uint8_t data[1 + 32];
+    data[0] = 0x00;
+    hash_helper::toArray(leaf, &data[1]);
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    SHA256(data, sizeof(data), digest);
+    return hash_helper::fromArray(digest);
+}
+
+
+hash_t MerkleTree::calcInnerHash(const hash_t& left, const hash_t& right) {
+    uint8_t data[1 + 32 + 32];
+    data[0] = 0x01;
+    hash_helper::toArray(left, &data[1]);
+    hash_helper::toArray(right, &data[1 + 32]);
+    uint8_t digest[SHA256_DIGEST_LENGTH];
+    SHA256(data, sizeof(data), digest);
+    return hash_helper::fromArray(digest);
+}
+
+
+hash_t MerkleTree::calcRoot(std::vector<hash_t>::const_iterator begin, std::vector<hash_t>::const_iterator end) {
+    if(std::next(begin) == end) {
+        return calcLeafHash(*begin);
+    }
+    //leaves are sorted, so the highest differing bit of the range is the one between first and last leaf
+    auto crit_bit = getCritBit(*begin, *std::prev(end));
+    auto split = std::find_if(begin, end, [crit_bit](const hash_t& leaf) { return getBit(leaf, crit_bit); });
+    return calcInnerHash(calcRoot(begin, split), calcRoot(split, end));
+}
+
+
+bool MerkleTree::getBit(const hash_t& hash, int32_t bit) {
+    return hash.getBit(bit);
+}
+
+
+int32_t MerkleTree::getCritBit(const hash_t& lhs, const hash_t& rhs) {
+    return (lhs ^ rhs).getMostSignificantBit();
+}
+
+
+void MerkleTree::insert(std::unique_ptr<Node>& node, const hash_t& leaf, int32_t crit_bit) {
+    //crit bits decrease along every path, the new inner node goes above the first node with a lower one
+    if(node->crit_bit < crit_bit) {
+        std::unique_ptr<Node> inner(new Node());
+        inner->crit_bit = crit_bit;
+        auto direction = getBit(leaf, crit_bit);
+        inner->child[direction] = createLeafNode(leaf);
+        inner->child[!direction] = std::move(node);
+        updateInnerNodeHash(*inner);
+        node = std::move(inner);
+        return;
+    }
+    insert(node->child[getBit(leaf, node->crit_bit)], leaf, crit_bit);
+    updateInnerNodeHash(*node);
+}
+
+
+bool MerkleTree::erase(std::unique_ptr<Node>& node, const hash_t& leaf) {
+    if(!node) {
+        return false;
+    }
+    if(node->crit_bit < 0) {
+        if(node->leaf != leaf) {
+            return false;
+        }
+        node.reset();
+        return true;
+    }
+    auto direction = getBit(leaf, node->crit_bit);
+    auto& child = node->child[direction];
+    if(child->crit_bit < 0) {
+        if(child->leaf != leaf) {
+            return false;
+        }
+        //the sibling takes the place of this inner node
+        std::unique_ptr<Node> sibling = std::move(node->child[!direction]);
+        node = std::move(sibling);
+        return true;
+    }
+    if(!erase(child, leaf)) {
+        return false;
+    }
+    updateInnerNodeHash(*node);
+    return true;
+}
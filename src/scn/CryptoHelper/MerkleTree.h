@@ -0,0 +1,109 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FULL_NODE_MERKLETREE_H
+#define FULL_NODE_MERKLETREE_H
+
+#include "scn/Common/Common.h"
+#include <memory>
+#include <vector>
+
+namespace scn {
+
+    //sibling hashes from a leaf up to the root
+    struct MerkleProof {
+        struct Step {
+            hash_t sibling_hash;
+            bool sibling_is_left;
+        };
+
+        std::vector<Step> steps; //first step is the sibling of the leaf
+    };
+
+    //Merkle tree over a set of hashes, kept as crit-bit tree (binary trie without empty subtrees)
+    //- the shape only depends on the set of leaves, so the root is the same no matter in which order leaves were added
+    //- an in-order walk visits the leaves sorted ascending
+    //- adding or removing a leaf rehashes only the nodes on its path (O(log n) for uniformly distributed hashes)
+    //leaf node hash:  SHA-256(0x00 | leaf)
+    //inner node hash: SHA-256(0x01 | left child hash | right child hash)
+    //root of an empty tree: 0
+    class MerkleTree {
+    public:
+        MerkleTree();
+
+        virtual ~MerkleTree();
+
+        MerkleTree(const MerkleTree&) = delete;
+
+        MerkleTree& operator=(const MerkleTree&) = delete;
+
+        //returns false if leaf was already part of the tree
+        virtual bool insert(const hash_t& leaf);
+
+        //returns false if leaf was not part of the tree
+        virtual bool erase(const hash_t& leaf);
+
+        virtual bool contains(const hash_t& leaf) const;
+
+        virtual void clear();
+
+        virtual uint32_t size() const;
+
+        virtual hash_t getRoot() const;
+
+        //returns false if leaf is not part of the tree
+        virtual bool getProof(const hash_t& leaf, MerkleProof& proof) const;
+
+        static bool verifyProof(const hash_t& leaf, const MerkleProof& proof, const hash_t& root);
+
+        //root of a tree with the given leaves without building the tree (leaves have to be sorted ascending and unique)
+        static hash_t calcRoot(const std::vector<hash_t>& sorted_leaves);
+
+    protected:
+
+        struct Node {
+            hash_t hash;
+            hash_t leaf;        //only valid for leaf nodes
+            int32_t crit_bit;   //bit which decides between child[0] and child[1], -1 for leaf nodes
+            std::unique_ptr<Node> child[2];
+        };
+
+        static std::unique_ptr<Node> createLeafNode(const hash_t& leaf);
+
+        static void updateInnerNodeHash(Node& node);
+
+        static hash_t calcLeafHash(const hash_t& leaf);
+
+        static hash_t calcInnerHash(const hash_t& left, const hash_t& right);
+
+        static hash_t calcRoot(std::vector<hash_t>::const_iterator begin, std::vector<hash_t>::const_iterator end);
+
+        static bool getBit(const hash_t& hash, int32_t bit);
+
+        //most significant bit in which both hashes differ, -1 if they are equal
+        static int32_t getCritBit(const hash_t& lhs, const hash_t& rhs);
+
+        static void insert(std::unique_ptr<Node>& node, const hash_t& leaf, int32_t crit_bit);
+
+        static bool erase(std::unique_ptr<Node>& node, const hash_t& leaf);
+
+        std::unique_ptr<Node> root_;
+        uint32_t size_;
+    };
+
+}
+
+#endif //FULL_NODE_MERKLETREE_H
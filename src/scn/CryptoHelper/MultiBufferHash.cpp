@@ -0,0 +1,195 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "MultiBufferHash.h"
+#include "MultiBufferHashLanes.h"
+#include <openssl/sha.h>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+using namespace scn;
+
+MultiBufferHash::Implementation MultiBufferHash::implementation_ = MultiBufferHash::detectImplementation();
+
+
+std::vector<hash_t> MultiBufferHash::calcHashes(const std::vector<const std::string*>& data) {
+    std::vector<hash_t> hashes;
+    hashes.reserve(data.size());
+
+    uint32_t num_lanes = getNumLanes();
+
+    if(num_lanes == 1) {
+        unsigned char digest[SHA256_DIGEST_LENGTH];
+        for(auto element : data) {
+            SHA256(reinterpret_cast<const unsigned char*>(element->data()), element->length(), digest);
+            hashes.push_back(hash_helper::fromArray(digest));
+        }
+        return hashes;
+    }
+
+    std::vector<const uint8_t*> messages(num_lanes);
+    std::vector<uint64_t> lengths(num_lanes);
+    std::vector<uint8_t> digests(num_lanes * SHA256_DIGEST_LENGTH);
+    for(size_t offset=0;offset<data.size();offset+=num_lanes) {
+        uint32_t num_messages = std::min(static_cast<size_t>(num_lanes), data.size() - offset);
+        for(uint32_t i=0;i<num_messages;i++) {
+            messages[i] = reinterpret_cast<const uint8_t*>(data[offset + i]->data());
+            lengths[i] = data[offset + i]->length();
+        }
+        if(implementation_ == Implementation::Avx512) {
+            multi_buffer_hash_lanes::hashLanesAvx512(messages.data(), lengths.data(), num_messages, digests.data());
+        } else {
+            multi_buffer_hash_lanes::hashLanesAvx2(messages.data(), lengths.data(), num_messages, digests.data());
+        }
+        for(uint32_t i=0;i<num_messages;i++) {
+            hashes.push_back(hash_helper::fromArray(&digests[i * SHA256_DIGEST_LENGTH]));
+        }
+    }
+    return hashes;
+}
+
+
+std::vector<hash_t> MultiBufferHash::calcHashes(const std::vector<std::string>& data) {
+    std::vector<const std::string*> data_pointers;
+    data_pointers.reserve(data.size());
+    for(auto& element : data) {
+        data_pointers.push_back(&element);
+    }
+    return calcHashes(data_pointers);
+}
+
+
+MultiBufferHash::Midstate MultiBufferHash::calcMidstate(const std::string& prefix) {
+    Midstate midstate;
+    midstate.num_bytes = prefix.length() - prefix.length() % SHA256_CBLOCK;
+    SHA256_CTX context;
+    SHA256_Init(&context);
+    SHA256_Update(&context, prefix.data(), midstate.num_bytes);
+    for(uint32_t i=0;i<8;i++) {
+        midstate.state[i] = context.h[i];
+    }
+    return midstate;
+}
+
+
+uint32_t MultiBufferHash::getNumLanes() {
+    switch(implementation_) {
+        case Implementation::Avx2:
+            return multi_buffer_hash_lanes::num_lanes_avx2;
+        case Implementation::Avx512:
+            return multi_buffer_hash_lanes::num_lanes_avx512;
+        case Implementation::Scalar:
+        default:
+            return 1;
+    }
+}
+
+
+void MultiBufferHash::calcHashesFromMidstate(const Midstate& midstate,
+                                             const uint8_t* const* messages,
+                                             const uint64_t* lengths,
+                                             uint32_t num_messages,
+                                             uint8_t* digests) {
+    switch(implementation_) {
+        case Implementation::Avx2:
+            multi_buffer_hash_lanes::hashLanesFromMidstateAvx2(midstate.state, midstate.num_bytes, messages, lengths, num_messages, digests);
+            break;
+        case Implementation::Avx512:
+            multi_buffer_hash_lanes::hashLanesFromMidstateAvx512(midstate.state, midstate.num_bytes, messages, lengths, num_messages, digests);
+            break;
+        case Implementation::Scalar:
+        default:
+            for(uint32_t i=0;i<num_messages;i++) {
+                SHA256_CTX context;
+                SHA256_Init(&context);
+                for(uint32_t j=0;j<8;j++) {
+                    context.h[j] = midstate.state[j];
+                }
+                context.Nl = static_cast<SHA_LONG>(midstate.num_bytes << 3);
+                context.Nh = static_cast<SHA_LONG>(midstate.num_bytes >> 29);
+                SHA256_Update(&context, messages[i], lengths[i]);
+                SHA256_Final(digests + i * SHA256_DIGEST_LENGTH, &context);
+            }
+            break;
+    }
+}
+
+
+MultiBufferHash::Implementation MultiBufferHash::getImplementation() {
+    return implementation_;
+}
+
+
+void MultiBufferHash::setImplementation(Implementation implementation) {
+    implementation_ = isSupported(implementation) ? implementation : Implementation::Scalar;
+}
+
+
+bool MultiBufferHash::isSupported(Implementation implementation) {
+    switch(implementation) {
+        case Implementation::Scalar:
+            return true;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        case Implementation::Avx2:
+            __builtin_cpu_init();
+            return multi_buffer_hash_lanes::isCompiledAvx2() && __builtin_cpu_supports("avx2");
+        case Implementation::Avx512:
+            __builtin_cpu_init();
+            return multi_buffer_hash_lanes::isCompiledAvx512() && __builtin_cpu_supports("avx512f");
+#endif
+        default:
+            return false;
+    }
+}
+
+
+bool MultiBufferHash::hasShaExtensions() {
+    //CPUID leaf 7, sub-leaf 0: EBX bit 29
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    unsigned int eax, ebx, ecx, edx;
+    if(!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return false;
+    }
+    return (ebx >> 29) & 1;
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int registers[4];
+    __cpuid(registers, 0);
+    if(registers[0] < 7) {
+        return false;
+    }
+    __cpuidex(registers, 7, 0);
+    return (registers[1] >> 29) & 1;
+#else
+    return false;
+#endif
+}
+
+
+MultiBufferHash::Implementation MultiBufferHash::detectImplementation() {
+    //OpenSSL with SHA-NI (one message at a time) beats the 8 AVX2 lanes, only AVX-512 is faster
+    if(isSupported(Implementation::Avx512)) {
+        return Implementation::Avx512;
+    } else if(hasShaExtensions()) {
+        return Implementation::Scalar;
+    } else if(isSupported(Implementation::Avx2)) {
+        return Implementation::Avx2;
+    } else {
+        return Implementation::Scalar;
+    }
+}
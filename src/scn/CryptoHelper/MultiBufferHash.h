@@ -0,0 +1,78 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FULL_NODE_MULTIBUFFERHASH_H
+#define FULL_NODE_MULTIBUFFERHASH_H
+
+#include "scn/Common/Common.h"
+#include <vector>
+#include <string>
+
+namespace scn {
+
+    //SHA-256 of many short independent messages at once
+    class MultiBufferHash {
+    public:
+
+        enum class Implementation : uint8_t {
+            Scalar = 0, //OpenSSL one message after the other (uses SHA-NI if the CPU supports it)
+            Avx2   = 1, //8 messages in parallel
+            Avx512 = 2  //16 messages in parallel
+        };
+
+        static std::vector<hash_t> calcHashes(const std::vector<const std::string*>& data);
+
+        static std::vector<hash_t> calcHashes(const std::vector<std::string>& data);
+
+        //SHA-256 state after the complete 64 byte blocks of a common prefix
+        struct Midstate {
+            uint32_t state[8];
+            uint64_t num_bytes; //number of prefix bytes contained in state (multiple of 64)
+        };
+
+        //NOTE: the remaining prefix.substr(num_bytes) has to be put in front of every message
+        static Midstate calcMidstate(const std::string& prefix);
+
+        //number of messages calcHashesFromMidstate hashes at once with the current implementation
+        static uint32_t getNumLanes();
+
+        //hashes up to getNumLanes() messages which continue the prefix of midstate, digests are written as 32 byte blocks one after another
+        static void calcHashesFromMidstate(const Midstate& midstate,
+                                           const uint8_t* const* messages,
+                                           const uint64_t* lengths,
+                                           uint32_t num_messages,
+                                           uint8_t* digests);
+
+        static Implementation getImplementation();
+
+        //for tests and benchmarks - falls back to Scalar if the implementation is not supported
+        static void setImplementation(Implementation implementation);
+
+        static bool isSupported(Implementation implementation);
+
+        //CPU has the SHA extensions (SHA-NI), which OpenSSL uses for the scalar implementation
+        static bool hasShaExtensions();
+
+    protected:
+
+        static Implementation detectImplementation();
+
+        static Implementation implementation_;
+    };
+
+}
+
+#endif //FULL_NODE_MULTIBUFFERHASH_H
@@ -0,0 +1,65 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//NOTE: This file is compiled with AVX2 enabled. It is only called after a runtime check of the CPU features.
+
+#include "MultiBufferHashLanes.h"
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+#define SCN_LANES 8
+#define SCN_VEC __m256i
+#define SCN_VADD(a, b) _mm256_add_epi32(a, b)
+#define SCN_VXOR(a, b) _mm256_xor_si256(a, b)
+#define SCN_VAND(a, b) _mm256_and_si256(a, b)
+#define SCN_VOR(a, b) _mm256_or_si256(a, b)
+#define SCN_VANDNOT(a, b) _mm256_andnot_si256(a, b)
+#define SCN_VSRL(a, n) _mm256_srli_epi32(a, n)
+#define SCN_VROTR(a, n) _mm256_or_si256(_mm256_srli_epi32(a, n), _mm256_slli_epi32(a, 32 - (n)))
+#define SCN_VSET1(x) _mm256_set1_epi32(static_cast<int>(x))
+#define SCN_VLOAD(p) _mm256_load_si256(reinterpret_cast<const __m256i*>(p))
+#define SCN_VSTORE(p, v) _mm256_store_si256(reinterpret_cast<__m256i*>(p), v)
+
+#include "MultiBufferHashKernel.h"
+
+bool scn::multi_buffer_hash_lanes::isCompiledAvx2() {
+    return true;
+}
+
+void scn::multi_buffer_hash_lanes::hashLanesAvx2(const uint8_t* const* messages, const uint64_t* lengths, uint32_t num_messages, uint8_t* digests) {
+    hashLanes(sha256_init, 0, messages, lengths, num_messages, digests);
+}
+
+void scn::multi_buffer_hash_lanes::hashLanesFromMidstateAvx2(const uint32_t* midstate, uint64_t num_prefix_bytes,
+                                                            const uint8_t* const* messages, const uint64_t* lengths, uint32_t num_messages, uint8_t* digests) {
+    hashLanes(midstate, num_prefix_bytes, messages, lengths, num_messages, digests);
+}
+
+#else
+
+bool scn::multi_buffer_hash_lanes::isCompiledAvx2() {
+    return false;
+}
+
+void scn::multi_buffer_hash_lanes::hashLanesAvx2(const uint8_t* const*, const uint64_t*, uint32_t, uint8_t*) {
+}
+
+void scn::multi_buffer_hash_lanes::hashLanesFromMidstateAvx2(const uint32_t*, uint64_t, const uint8_t* const*, const uint64_t*, uint32_t, uint8_t*) {
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//NOTE: This file is compiled with AVX-512 enabled. It is only called after a runtime check of the CPU features.
+
+#include "MultiBufferHashLanes.h"
+
+#if defined(__AVX512F__)
+
+#include <immintrin.h>
+
+#define SCN_LANES 16
+#define SCN_VEC __m512i
+#define SCN_VADD(a, b) _mm512_add_epi32(a, b)
+#define SCN_VXOR(a, b) _mm512_xor_si512(a, b)
+#define SCN_VAND(a, b) _mm512_and_si512(a, b)
+#define SCN_VOR(a, b) _mm512_or_si512(a, b)
+#define SCN_VANDNOT(a, b) _mm512_andnot_si512(a, b)
+#define SCN_VSRL(a, n) _mm512_srli_epi32(a, n)
+#define SCN_VROTR(a, n) _mm512_ror_epi32(a, n)
+#define SCN_VSET1(x) _mm512_set1_epi32(static_cast<int>(x))
+#define SCN_VLOAD(p) _mm512_load_si512(reinterpret_cast<const __m512i*>(p))
+#define SCN_VSTORE(p, v) _mm512_store_si512(reinterpret_cast<__m512i*>(p), v)
+
+#include "MultiBufferHashKernel.h"
+
+bool scn::multi_buffer_hash_lanes::isCompiledAvx512() {
+    return true;
+}
+
+void scn::multi_buffer_hash_lanes::hashLanesAvx512(const uint8_t* const* messages, const uint64_t* lengths, uint32_t num_messages, uint8_t* digests) {
+    hashLanes(sha256_init, 0, messages, lengths, num_messages, digests);
+}
+
+void scn::multi_buffer_hash_lanes::hashLanesFromMidstateAvx512(const uint32_t* midstate, uint64_t num_prefix_bytes,
+                                                              const uint8_t* const* messages, const uint64_t* lengths, uint32_t num_messages, uint8_t* digests) {
+    hashLanes(midstate, num_prefix_bytes, messages, lengths, num_messages, digests);
+}
+
+#else
+
+bool scn::multi_buffer_hash_lanes::isCompiledAvx512() {
+    return false;
+}
+
+void scn::multi_buffer_hash_lanes::hashLanesAvx512(const uint8_t* const*, const uint64_t*, uint32_t, uint8_t*) {
+}
+
+void scn::multi_buffer_hash_lanes::hashLanesFromMidstateAvx512(const uint32_t*, uint64_t, const uint8_t* const*, const uint64_t*, uint32_t, uint8_t*) {
+}
+
+#endif
@@ -0,0 +1,157 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+//NOTE: no include guard - this multi-lane SHA-256 kernel is included once per instruction set.
+//      The including file has to define SCN_LANES, SCN_VEC and the SCN_V* operations before.
+
+namespace {
+
+    const uint32_t sha256_k[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    const uint32_t sha256_init[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    inline uint32_t readBigEndian32(const uint8_t* p) {
+        uint32_t value;
+        __builtin_memcpy(&value, p, sizeof(value));
+        return __builtin_bswap32(value);
+    }
+
+    inline void writeBigEndian32(uint8_t* p, uint32_t value) {
+        p[0] = static_cast<uint8_t>(value >> 24);
+        p[1] = static_cast<uint8_t>(value >> 16);
+        p[2] = static_cast<uint8_t>(value >> 8);
+        p[3] = static_cast<uint8_t>(value);
+    }
+
+    //builds the block with the given index of the padded message (length_offset: number of bytes hashed before the message)
+    inline void fillPaddedBlock(const uint8_t* message, uint64_t length, uint64_t length_offset, uint64_t block_index, uint64_t num_blocks, uint8_t* block) {
+        const uint64_t block_begin = block_index * 64;
+        const uint64_t num_message_bytes = length > block_begin ? (length - block_begin < 64 ? length - block_begin : 64) : 0;
+        if(num_message_bytes > 0) {
+            __builtin_memcpy(block, message + block_begin, num_message_bytes);
+        }
+        __builtin_memset(block + num_message_bytes, 0, 64 - num_message_bytes);
+        if(num_message_bytes < 64 && block_begin + num_message_bytes == length) {
+            block[num_message_bytes] = 0x80;
+        }
+        if(block_index == num_blocks - 1) {
+            const uint64_t length_bits = (length_offset + length) * 8;
+            for(uint32_t i=0;i<8;i++) {
+                block[56 + i] = static_cast<uint8_t>(length_bits >> (56 - 8 * i));
+            }
+        }
+    }
+
+    inline SCN_VEC sigma0(SCN_VEC x) { return SCN_VXOR(SCN_VXOR(SCN_VROTR(x, 7), SCN_VROTR(x, 18)), SCN_VSRL(x, 3)); }
+    inline SCN_VEC sigma1(SCN_VEC x) { return SCN_VXOR(SCN_VXOR(SCN_VROTR(x, 17), SCN_VROTR(x, 19)), SCN_VSRL(x, 10)); }
+    inline SCN_VEC bigSigma0(SCN_VEC x) { return SCN_VXOR(SCN_VXOR(SCN_VROTR(x, 2), SCN_VROTR(x, 13)), SCN_VROTR(x, 22)); }
+    inline SCN_VEC bigSigma1(SCN_VEC x) { return SCN_VXOR(SCN_VXOR(SCN_VROTR(x, 6), SCN_VROTR(x, 11)), SCN_VROTR(x, 25)); }
+    inline SCN_VEC choose(SCN_VEC e, SCN_VEC f, SCN_VEC g) { return SCN_VXOR(SCN_VAND(e, f), SCN_VANDNOT(e, g)); }
+    inline SCN_VEC majority(SCN_VEC a, SCN_VEC b, SCN_VEC c) { return SCN_VOR(SCN_VAND(a, b), SCN_VAND(c, SCN_VOR(a, b))); }
+
+    //initial_state: state after hashing the first length_offset bytes (multiple of 64) or sha256_init if length_offset is 0
+    void hashLanes(const uint32_t* initial_state, uint64_t length_offset,
+                   const uint8_t* const* messages, const uint64_t* lengths, uint32_t num_messages, uint8_t* digests) {
+        alignas(64) uint32_t words[16][SCN_LANES];
+        alignas(64) uint32_t lane_mask[SCN_LANES];
+        alignas(64) uint32_t state_out[8][SCN_LANES];
+        uint8_t block[64];
+
+        uint64_t num_blocks[SCN_LANES];
+        uint64_t max_num_blocks = 0;
+        for(uint32_t lane=0;lane<SCN_LANES;lane++) {
+            num_blocks[lane] = lane < num_messages ? (lengths[lane] + 8) / 64 + 1 : 0;
+            max_num_blocks = num_blocks[lane] > max_num_blocks ? num_blocks[lane] : max_num_blocks;
+        }
+
+        SCN_VEC state[8];
+        for(uint32_t i=0;i<8;i++) {
+            state[i] = SCN_VSET1(initial_state[i]);
+        }
+
+        for(uint64_t block_index=0;block_index<max_num_blocks;block_index++) {
+            //transpose the message blocks into one word vector per round input (lanes which are done get a dummy block)
+            for(uint32_t lane=0;lane<SCN_LANES;lane++) {
+                const uint8_t* block_data = block;
+                if(block_index < num_blocks[lane]) {
+                    if((block_index + 1) * 64 <= lengths[lane]) {
+                        block_data = messages[lane] + block_index * 64; //no padding inside this block
+                    } else {
+                        fillPaddedBlock(messages[lane], lengths[lane], length_offset, block_index, num_blocks[lane], block);
+                    }
+                    lane_mask[lane] = 0xffffffff;
+                } else {
+                    __builtin_memset(block, 0, 64);
+                    lane_mask[lane] = 0;
+                }
+                for(uint32_t i=0;i<16;i++) {
+                    words[i][lane] = readBigEndian32(block_data + 4 * i);
+                }
+            }
+
+            SCN_VEC w[16];
+            for(uint32_t i=0;i<16;i++) {
+                w[i] = SCN_VLOAD(words[i]);
+            }
+
+            SCN_VEC a = state[0], b = state[1], c = state[2], d = state[3];
+            SCN_VEC e = state[4], f = state[5], g = state[6], h = state[7];
+            for(uint32_t t=0;t<64;t++) {
+                if(t >= 16) {
+                    w[t & 15] = SCN_VADD(SCN_VADD(sigma1(w[(t - 2) & 15]), w[(t - 7) & 15]),
+                                         SCN_VADD(sigma0(w[(t - 15) & 15]), w[t & 15]));
+                }
+                SCN_VEC t1 = SCN_VADD(SCN_VADD(SCN_VADD(h, bigSigma1(e)), SCN_VADD(choose(e, f, g), SCN_VSET1(sha256_k[t]))), w[t & 15]);
+                SCN_VEC t2 = SCN_VADD(bigSigma0(a), majority(a, b, c));
+                h = g;
+                g = f;
+                f = e;
+                e = SCN_VADD(d, t1);
+                d = c;
+                c = b;
+                b = a;
+                a = SCN_VADD(t1, t2);
+            }
+
+            const SCN_VEC mask = SCN_VLOAD(lane_mask);
+            const SCN_VEC working[8] = {a, b, c, d, e, f, g, h};
+            for(uint32_t i=0;i<8;i++) {
+                state[i] = SCN_VOR(SCN_VAND(mask, SCN_VADD(state[i], working[i])), SCN_VANDNOT(mask, state[i]));
+            }
+        }
+
+        for(uint32_t i=0;i<8;i++) {
+            SCN_VSTORE(state_out[i], state[i]);
+        }
+        for(uint32_t lane=0;lane<num_messages;lane++) {
+            for(uint32_t i=0;i<8;i++) {
+                writeBigEndian32(digests + lane * 32 + i * 4, state_out[i][lane]);
+            }
+        }
+    }
+
+}
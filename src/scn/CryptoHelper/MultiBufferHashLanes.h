@@ -0,0 +1,50 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FULL_NODE_MULTIBUFFERHASHLANES_H
+#define FULL_NODE_MULTIBUFFERHASHLANES_H
+
+#include <cstdint>
+
+//NOTE: This header is included by translation units compiled with special instruction set flags,
+//      so it must not pull in any code which could be instantiated there (no std containers/strings).
+
+namespace scn {
+
+    namespace multi_buffer_hash_lanes {
+
+        static const uint32_t num_lanes_avx2 = 8;
+        static const uint32_t num_lanes_avx512 = 16;
+
+        //false if the translation unit was built without the required instruction set
+        bool isCompiledAvx2();
+        bool isCompiledAvx512();
+
+        //hashes up to num_lanes_xxx messages at once, digests are written as 32 byte blocks one after another
+        void hashLanesAvx2(const uint8_t* const* messages, const uint64_t* lengths, uint32_t num_messages, uint8_t* digests);
+        void hashLanesAvx512(const uint8_t* const* messages, const uint64_t* lengths, uint32_t num_messages, uint8_t* digests);
+
+        //same, but all messages continue a common prefix of num_prefix_bytes (multiple of 64) which resulted in midstate
+        void hashLanesFromMidstateAvx2(const uint32_t* midstate, uint64_t num_prefix_bytes,
+                                       const uint8_t* const* messages, const uint64_t* lengths, uint32_t num_messages, uint8_t* digests);
+        void hashLanesFromMidstateAvx512(const uint32_t* midstate, uint64_t num_prefix_bytes,
+                                         const uint8_t* const* messages, const uint64_t* lengths, uint32_t num_messages, uint8_t* digests);
+
+    }
+
+}
+
+#endif //FULL_NODE_MULTIBUFFERHASHLANES_H
@@ -0,0 +1,116 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "PublicKeyCache.h"
+#include <openssl/ec.h>
+#include <openssl/pem.h>
+#include <openssl/bio.h>
+
+using namespace scn;
+
+
+PublicKeyCache::PublicKeyCache(uint32_t max_num_entries)
+:max_num_entries_(std::max(max_num_entries, 1u))
+,lru_list_()
+,entries_()
+,num_hits_(0)
+,num_misses_(0) {
+
+}
+
+
+PublicKeyCache::~PublicKeyCache() = default;
+
+
+std::shared_ptr<EVP_PKEY> PublicKeyCache::getKey(const public_key_t& public_key) {
+    {
+        LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+        auto it = entries_.find(public_key);
+        if(it != entries_.end()) {
+            lru_list_.splice(lru_list_.begin(), lru_list_, it->second);
+            num_hits_++;
+            return it->second->second;
+        }
+    }
+
+    //parse outside of the lock, so other threads are not blocked by a slow PEM parse
+    num_misses_++;
+    auto key = parseKey(public_key);
+
+    {
+        LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+        auto it = entries_.find(public_key);
+        if(it != entries_.end()) {
+            //another thread was faster
+            lru_list_.splice(lru_list_.begin(), lru_list_, it->second);
+            return it->second->second;
+        }
+        lru_list_.emplace_front(public_key, key);
+        entries_[public_key] = lru_list_.begin();
+        while(entries_.size() > max_num_entries_) {
+            entries_.erase(lru_list_.back().first);
+            lru_list_.pop_back();
+        }
+    }
+    return key;
+}
+
+
+void PublicKeyCache::clear() {
+    LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+    entries_.clear();
+    lru_list_.clear();
+    num_hits_ = 0;
+    num_misses_ = 0;
+}
+
+
+uint32_t PublicKeyCache::size() const {
+    LOCK_MUTEX_WATCHDOG(mtx_cache_access_);
+    return entries_.size();
+}
+
+
+uint64_t PublicKeyCache::numHits() const {
+    return num_hits_;
+}
+
+
+uint64_t PublicKeyCache::numMisses() const {
+    return num_misses_;
+}
+
+
+std::shared_ptr<EVP_PKEY> PublicKeyCache::parseKey(const public_key_t& public_key) {
+    auto public_key_string = public_key.getAsFullString();
+    BIO* keybio = BIO_new_mem_buf((void *)public_key_string.c_str(), public_key_string.length());
+    if (keybio == nullptr) {
+        return nullptr;
+    }
+    EC_KEY* ec_key = PEM_read_bio_EC_PUBKEY(keybio, nullptr, nullptr, nullptr);
+    BIO_free(keybio);
+    if (ec_key == nullptr) {
+        return nullptr;
+    }
+
+    EVP_PKEY* key = EVP_PKEY_new();
+    if (key == nullptr || EVP_PKEY_assign_EC_KEY(key, ec_key) != 1) {
+        EVP_PKEY_free(key);
+        EC_KEY_free(ec_key);
+        return nullptr;
+    }
+    return std::shared_ptr<EVP_PKEY>(key, EVP_PKEY_free);
+}
@@ -0,0 +1,68 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FULL_NODE_PUBLICKEYCACHE_H
+#define FULL_NODE_PUBLICKEYCACHE_H
+
+#include "scn/Common/Common.h"
+#include <openssl/evp.h>
+#include <unordered_map>
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <memory>
+
+namespace scn {
+
+    //keeps parsed public keys, so PEM parsing is done only once per wallet instead of once per signature check
+    class PublicKeyCache {
+    public:
+        explicit PublicKeyCache(uint32_t max_num_entries = default_max_num_entries);
+
+        virtual ~PublicKeyCache();
+
+        //returns nullptr if the public key is invalid (invalid keys are cached as well)
+        virtual std::shared_ptr<EVP_PKEY> getKey(const public_key_t& public_key);
+
+        virtual void clear();
+
+        virtual uint32_t size() const;
+
+        virtual uint64_t numHits() const;
+
+        virtual uint64_t numMisses() const;
+
+        static const uint32_t default_max_num_entries = 65536;
+
+    protected:
+
+        typedef std::list<std::pair<public_key_t, std::shared_ptr<EVP_PKEY>>> lru_list_t;
+
+        static std::shared_ptr<EVP_PKEY> parseKey(const public_key_t& public_key);
+
+        const uint32_t max_num_entries_;
+
+        mutable std::mutex mtx_cache_access_;
+        lru_list_t lru_list_; //most recently used entry at the front
+        std::unordered_map<public_key_t, lru_list_t::iterator> entries_;
+
+        std::atomic<uint64_t> num_hits_;
+        std::atomic<uint64_t> num_misses_;
+    };
+
+}
+
+#endif //FULL_NODE_PUBLICKEYCACHE_H
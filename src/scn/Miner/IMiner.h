@@ -41,6 +41,12 @@ namespace scn {
         virtual epoch_t getEpoch() const = 0;
 
         virtual uint64_t numChecksPerSecond() const = 0;
+
+        //the node enters/leaves a consensus critical phase (block introduction, baseline), the miner may shed load
+        //in between - phases may overlap, every enter is followed by exactly one leave
+        virtual void enterConsensusPhase() = 0;
+
+        virtual void leaveConsensusPhase() = 0;
     };
 
 }
@@ -0,0 +1,196 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "MinerClient.h"
+#include "MiningLoop.h"
+#include <chrono>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+using namespace scn;
+using boost::asio::ip::tcp;
+
+
+MinerClient::MinerClient(const std::string& host, uint16_t port, uint32_t num_worker_threads)
+:host_(host)
+,port_(port)
+,num_worker_threads_(num_worker_threads)
+,running_(false)
+,workers_()
+,num_found_values_(0)
+,stats_check_counter_(0)
+,stats_check_counter_per_sec_(0) {
+
+}
+
+MinerClient::~MinerClient() {
+    stop();
+}
+
+void MinerClient::start() {
+    if(isRunning()) {
+        return;
+    }
+    running_ = true;
+    for(uint32_t i=0;i<num_worker_threads_;i++) {
+        workers_.emplace_back(&MinerClient::workerThread, this, i);
+    }
+    stats_thread_ = std::make_shared<std::thread>(&MinerClient::statsThread, this);
+}
+
+void MinerClient::stop() {
+    running_ = false;
+    for(auto& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+    if(stats_thread_ && stats_thread_->joinable()) {
+        stats_thread_->join();
+    }
+}
+
+bool MinerClient::isRunning() const {
+    return running_;
+}
+
+uint64_t MinerClient::numChecksPerSecond() const {
+    return stats_check_counter_per_sec_;
+}
+
+uint64_t MinerClient::numFoundValues() const {
+    return num_found_values_;
+}
+
+void MinerClient::workerThread(uint32_t thread_id) {
+#ifdef _WIN32
+    SetThreadPriority(GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+#else
+    struct sched_param p;
+    p.sched_priority = 0;
+    pthread_setschedparam(pthread_self(), SCHED_IDLE, &p);
+#endif
+
+    uint64_t num_requested_values = initial_work_unit_size;
+    uint64_t num_checked_values = 0;
+    while(running_) {
+        boost::asio::io_context io_context;
+        tcp::socket socket(io_context);
+        boost::system::error_code ec;
+        tcp::resolver resolver(io_context);
+        auto endpoints = resolver.resolve(host_, std::to_string(port_), ec);
+        if(!ec) {
+            boost::asio::connect(socket, endpoints, ec);
+        }
+        if(ec) {
+            LOG(ERROR) << "Miner " << thread_id << " cannot connect to " << host_ << ":" << port_ << ": " << ec.message();
+            sleepWhileRunning(reconnect_delay_ms);
+            continue;
+        }
+        socket.set_option(tcp::no_delay(true), ec);
+
+        while(running_) {
+            miner_protocol::RequestWork request;
+            request.version = miner_protocol::protocol_version;
+            request.num_checked_values = num_checked_values;
+            request.num_requested_values = num_requested_values;
+            miner_protocol::MessageType type;
+            std::string payload;
+            if(!miner_protocol::writeMessage(socket, miner_protocol::MessageType::RequestWork, request) ||
+               !miner_protocol::readMessage(socket, type, payload)) {
+                break;
+            }
+            num_checked_values = 0;
+
+            if(type == miner_protocol::MessageType::NoWork) {
+                miner_protocol::NoWork no_work;
+                if(!miner_protocol::parseMessage(payload, no_work)) {
+                    break;
+                }
+                sleepWhileRunning(no_work.retry_after_ms);
+                continue;
+            }
+
+            miner_protocol::AssignWork work;
+            if(type != miner_protocol::MessageType::AssignWork || !miner_protocol::parseMessage(payload, work)) {
+                LOG(ERROR) << "Unexpected miner protocol message type " << static_cast<uint32_t>(type);
+                break;
+            }
+
+            auto start_time = std::chrono::steady_clock::now();
+            if(!mineWorkUnit(socket, work, num_checked_values)) {
+                break;
+            }
+            auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+            if(duration_us > 0 && num_checked_values == work.num_counter_values) {
+                num_requested_values = std::max<uint64_t>(num_checked_values * target_work_unit_duration_ms * 1000 / duration_us,
+                                                          miner_protocol::counter_value_granularity);
+            }
+        }
+
+        socket.close(ec);
+        if(running_) {
+            LOG(ERROR) << "Miner " << thread_id << " lost connection to " << host_ << ":" << port_;
+            sleepWhileRunning(reconnect_delay_ms);
+        }
+    }
+}
+
+bool MinerClient::mineWorkUnit(tcp::socket& socket, const miner_protocol::AssignWork& work, uint64_t& num_checked_values) {
+    MiningLoop mining_loop(work.prefix, work.min_allowed_value, work.max_allowed_value, work.first_counter_value);
+    bool connection_ok = true;
+    const std::function<void(const std::string&)> found_callback = [&](const std::string& data_value) {
+        miner_protocol::FoundValue found_value;
+        found_value.work_id = work.work_id;
+        found_value.data_value = data_value;
+        connection_ok = connection_ok && miner_protocol::writeMessage(socket, miner_protocol::MessageType::FoundValue, found_value);
+        num_found_values_++;
+    };
+    //counter ranges are multiples of counter_value_granularity, the batches fit exactly
+    while(running_ && connection_ok && num_checked_values < work.num_counter_values) {
+        auto num_checked_batch = mining_loop.checkNextBatch(found_callback);
+        num_checked_values += num_checked_batch;
+        stats_check_counter_ += num_checked_batch;
+    }
+    return connection_ok;
+}
+
+void MinerClient::sleepWhileRunning(uint32_t duration_ms) {
+    const uint32_t step_ms = 50;
+    for(uint32_t slept_ms=0;slept_ms<duration_ms && running_;slept_ms+=step_ms) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(std::min(step_ms, duration_ms - slept_ms)));
+    }
+}
+
+void MinerClient::statsThread() {
+    const uint32_t cycle_time_ms = 1000;
+    auto next_cycle_time = std::chrono::system_clock::now();
+    uint64_t last_stats_check_counter = stats_check_counter_;
+    while(running_) {
+        uint64_t current_stats_check_counter = stats_check_counter_;
+        stats_check_counter_per_sec_ = (current_stats_check_counter - last_stats_check_counter) * 1000 / cycle_time_ms;
+        last_stats_check_counter = current_stats_check_counter;
+        for(uint32_t i=0;i<10;i++) {
+            next_cycle_time += std::chrono::milliseconds(cycle_time_ms/10);
+            std::this_thread::sleep_until(next_cycle_time);
+            if(!running_) {
+                break;
+            }
+        }
+    }
+    stats_check_counter_per_sec_ = 0;
+}
@@ -0,0 +1,80 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FULL_NODE_MINERCLIENT_H
+#define FULL_NODE_MINERCLIENT_H
+
+#include "MinerProtocol.h"
+#include <thread>
+#include <atomic>
+#include <vector>
+
+namespace scn {
+
+    //standalone miner: every worker thread asks a MinerServer for work units over its own connection and reports
+    //the found values back
+    class MinerClient {
+    public:
+        MinerClient(const std::string& host, uint16_t port, uint32_t num_worker_threads);
+        virtual ~MinerClient();
+
+        virtual void start();
+
+        virtual void stop();
+
+        virtual bool isRunning() const;
+
+        virtual uint64_t numChecksPerSecond() const;
+
+        virtual uint64_t numFoundValues() const;
+
+        //size of the first work unit, later ones are sized to take about target_work_unit_duration_ms
+        static const uint64_t initial_work_unit_size = 1 << 16;
+
+        //short work units keep the time spent on outdated work after an epoch change low
+        static const uint32_t target_work_unit_duration_ms = 250;
+
+        static const uint32_t reconnect_delay_ms = 1000;
+
+    protected:
+
+        virtual void workerThread(uint32_t thread_id);
+
+        virtual void statsThread();
+
+        //returns false if the connection is broken
+        bool mineWorkUnit(boost::asio::ip::tcp::socket& socket, const miner_protocol::AssignWork& work,
+                          uint64_t& num_checked_values);
+
+        //sleeps in short steps, returns early if the client is stopped
+        void sleepWhileRunning(uint32_t duration_ms);
+
+        std::string host_;
+        uint16_t port_;
+        uint32_t num_worker_threads_;
+
+        std::atomic<bool> running_;
+        std::vector<std::thread> workers_;
+        std::shared_ptr<std::thread> stats_thread_;
+
+        std::atomic<uint64_t> num_found_values_;
+        std::atomic<uint64_t> stats_check_counter_;
+        std::atomic<uint64_t> stats_check_counter_per_sec_;
+    };
+
+}
+
+#endif //FULL_NODE_MINERCLIENT_H
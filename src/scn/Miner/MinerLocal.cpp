@@ -17,6 +17,8 @@
 #include "MinerLocal.h"
 #include "scn/CryptoHelper/CryptoHelper.h"
 #include "scn/Blockchain/Blockchain.h"
+#include "MiningLoop.h"
+#include "scn/Common/CpuAffinity.h"
 #include <chrono>
 #include <random>
 #ifdef _WIN32
@@ -26,19 +28,41 @@
 using namespace scn;
 
 
+const uint32_t MinerLocal::default_consensus_phase_throttle_percent;
+
 MinerLocal::MinerLocal(uint32_t num_worker_threads)
 :running_(false)
+,shutdown_(false)
+,work_()
+,generation_(0)
+,num_busy_workers_(0)
+,epoch_(0)
+,consensus_phase_depth_(0)
+,consensus_phase_throttle_percent_(default_consensus_phase_throttle_percent)
+,num_throttled_workers_(0)
+,host_id_(std::random_device()())
+,work_nonce_generator_(std::random_device()())
 ,num_worker_threads_(num_worker_threads)
 ,workers_()
 ,stats_check_counter_(0)
-,stats_check_counter_per_sec_(0)
-,previous_epoch_highest_hash_(0)
-,epoch_(0) {
+,stats_check_counter_per_sec_(0) {
 
 }
 
 MinerLocal::~MinerLocal() {
-    stop();
+    {
+        std::unique_lock<std::mutex> lock_work(mtx_work_access_);
+        shutdown_ = true;
+        num_worker_threads_ = 0;
+        publishWork(nullptr);
+    }
+    for(auto& worker : workers_)
+    {
+        worker.join();
+    }
+    if(stats_thread_ && stats_thread_->joinable()) {
+        stats_thread_->join();
+    }
 }
 
 void MinerLocal::start(const hash_t& previous_epoch_highest_hash,
@@ -46,48 +70,28 @@ void MinerLocal::start(const hash_t& previous_epoch_highest_hash,
                        const epoch_t epoch,
                        std::function<void(epoch_t, const std::string &)> found_value_callback) {
     LOG(INFO) << "Mining epoch " << epoch;
-    if(isRunning())
-    {
-        stop();
-    }
 
-    //init variables
-    stats_check_counter_ = 0;
-    stats_check_counter_per_sec_ = 0;
-    previous_epoch_highest_hash_ = previous_epoch_highest_hash;
-    owner_public_key_ = owner_public_key;
-    epoch_ = epoch;
-    found_value_callback_ = found_value_callback;
-    running_ = true;
-
-    //init hash areas
-    Blockchain::getHashArea(epoch, max_allowed_value_, min_allowed_value_);
-
-    //start worker threads
-    workers_.reserve(num_worker_threads_);
-    for(uint32_t i=0;i<num_worker_threads_;i++)
-    {
-        workers_.emplace_back(&MinerLocal::miningThread, this, i);
-    }
+    auto work = std::make_shared<Work>();
+    work->previous_epoch_highest_hash = previous_epoch_highest_hash;
+    work->owner_public_key = owner_public_key;
+    work->epoch = epoch;
+    work->found_value_callback = found_value_callback;
+    Blockchain::getHashArea(epoch, work->max_allowed_value, work->min_allowed_value);
 
-    //start stats thread
-    stats_thread_ = std::make_shared<std::thread>(&MinerLocal::statsThread, this);
+    //busy workers switch to the new work after their current batch, there is no need to wait for them
+    std::unique_lock<std::mutex> lock_work(mtx_work_access_);
+    work->work_nonce = work_nonce_generator_();
+    epoch_ = epoch;
+    publishWork(work);
+    spawnWorkerThreads();
 }
 
 void MinerLocal::stop(){
-    running_ = false;
-
-    if(stats_thread_ && stats_thread_->joinable()) {
-        stats_thread_->join();
-    }
-    for(auto& worker : workers_)
-    {
-        try {
-            worker.join();
-        } catch(const std::system_error& e){
-
-        }
-    }
+    //no found value callback of the old work must be running after stop returned
+    std::unique_lock<std::mutex> lock_work(mtx_work_access_);
+    publishWork(nullptr);
+    cv_worker_idle_.wait(lock_work, [this]() { return num_busy_workers_ == 0; });
+    stats_check_counter_per_sec_ = 0;
 }
 
 bool MinerLocal::isRunning() const{
@@ -99,9 +103,23 @@ uint32_t MinerLocal::numWorkerThreads() const{
 }
 
 void MinerLocal::changeNumWorkerThreads(uint32_t num_worker_threads) {
-    stop();
-    num_worker_threads_ = num_worker_threads;
-    start(previous_epoch_highest_hash_, owner_public_key_, epoch_, found_value_callback_);
+    //the remaining workers keep on mining their current work
+    std::vector<std::thread> retired_workers;
+    {
+        std::unique_lock<std::mutex> lock_work(mtx_work_access_);
+        num_worker_threads_ = num_worker_threads;
+        while(workers_.size() > num_worker_threads) {
+            retired_workers.push_back(std::move(workers_.back()));
+            workers_.pop_back();
+        }
+        if(running_) {
+            spawnWorkerThreads();
+        }
+    }
+    cv_work_available_.notify_all();
+    for(auto& worker : retired_workers) {
+        worker.join();
+    }
 }
 
 epoch_t MinerLocal::getEpoch() const{
@@ -112,6 +130,88 @@ uint64_t MinerLocal::numChecksPerSecond() const {
     return stats_check_counter_per_sec_;
 }
 
+uint64_t MinerLocal::getGeneration() const {
+    return generation_;
+}
+
+void MinerLocal::enterConsensusPhase() {
+    consensus_phase_depth_++;
+}
+
+void MinerLocal::leaveConsensusPhase() {
+    {
+        std::unique_lock<std::mutex> lock_work(mtx_work_access_);
+        if(consensus_phase_depth_ > 0) {
+            consensus_phase_depth_--;
+        }
+    }
+    cv_work_available_.notify_all();
+}
+
+bool MinerLocal::isInConsensusPhase() const {
+    return consensus_phase_depth_ > 0;
+}
+
+void MinerLocal::setConsensusPhaseThrottle(uint32_t percent) {
+    {
+        std::unique_lock<std::mutex> lock_work(mtx_work_access_);
+        consensus_phase_throttle_percent_ = std::min(percent, 100u);
+    }
+    cv_work_available_.notify_all();
+}
+
+uint32_t MinerLocal::getConsensusPhaseThrottle() const {
+    return consensus_phase_throttle_percent_;
+}
+
+uint32_t MinerLocal::numThrottledWorkers() const {
+    return num_throttled_workers_;
+}
+
+void MinerLocal::setHostId(uint32_t host_id) {
+    host_id_ = host_id;
+}
+
+uint32_t MinerLocal::getHostId() const {
+    return host_id_;
+}
+
+void MinerLocal::publishWork(const std::shared_ptr<const Work>& work) {
+    work_ = work;
+    running_ = (work != nullptr);
+    generation_++;
+    cv_work_available_.notify_all();
+}
+
+void MinerLocal::spawnWorkerThreads() {
+    workers_.reserve(num_worker_threads_);
+    for(uint32_t i=workers_.size();i<num_worker_threads_;i++)
+    {
+        workers_.emplace_back(&MinerLocal::miningThread, this, i);
+    }
+    if(!stats_thread_) {
+        stats_thread_ = std::make_shared<std::thread>(&MinerLocal::statsThread, this);
+    }
+}
+
+bool MinerLocal::isThrottled(uint32_t thread_id) const {
+    if(consensus_phase_depth_ == 0) {
+        return false;
+    }
+    //shedding rounds up (e.g. one of three workers keeps on mining with 50%), but never pauses the last worker
+    const uint32_t num_active_workers = std::max(1u, num_worker_threads_ * (100 - consensus_phase_throttle_percent_) / 100);
+    return thread_id >= num_active_workers;
+}
+
+void MinerLocal::waitWhileThrottled(uint32_t thread_id, uint64_t generation) {
+    std::unique_lock<std::mutex> lock_work(mtx_work_access_);
+    num_throttled_workers_++;
+    cv_work_available_.wait(lock_work, [&]() {
+        return !isThrottled(thread_id) || generation_ != generation || thread_id >= num_worker_threads_;
+    });
+    num_throttled_workers_--;
+}
+
 void MinerLocal::miningThread(uint32_t thread_id)
 {
 #ifdef _WIN32
@@ -121,30 +221,52 @@ void MinerLocal::miningThread(uint32_t thread_id)
     p.sched_priority = 0;
     pthread_setschedparam(pthread_self(), SCHED_IDLE, &p);
 #endif
-
-    uint32_t random_value = 0;
-    {
-        std::default_random_engine generator(time(nullptr) + (thread_id * 12345));
-        std::uniform_int_distribution<uint32_t> distribution(0, 1000000000);
-        random_value = distribution(generator);
+    //one worker per miner core, more workers than cores share them round robin
+    auto miner_cores = CpuAffinity::getMinerCores();
+    if(!miner_cores.empty() && !CpuAffinity::pinCurrentThread({miner_cores[thread_id % miner_cores.size()]})) {
+        LOG(WARNING) << "Cannot pin mining thread " << thread_id << " to core " << miner_cores[thread_id % miner_cores.size()];
     }
-    std::string random_prefix = std::to_string(random_value);
-    std::string prefix = hash_helper::toString(previous_epoch_highest_hash_) + "_" +
-            owner_public_key_.getAsShortString() + "_" + random_prefix + "_";
-    CryptoHelper::Hash hash_object_common;
-    hash_object_common.update(prefix);
-
-    boost::multiprecision::uint1024_t value = 0;
-    while(running_) {
-        CryptoHelper::Hash hash_object_cycle = hash_object_common;
-        auto payload = value.str(0, std::ios_base::hex | std::ios_base::uppercase);
-        hash_object_cycle.update(payload);
-        auto hash = hash_object_cycle.finalize();
-        stats_check_counter_++;
-        if (hash >= min_allowed_value_ && hash <= max_allowed_value_) {
-            found_value_callback_(epoch_, prefix + payload);
+
+    std::shared_ptr<const Work> work;
+    uint64_t generation = 0;
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock_work(mtx_work_access_);
+            if(work) {
+                work.reset();
+                num_busy_workers_--;
+                cv_worker_idle_.notify_all();
+            }
+            cv_work_available_.wait(lock_work, [&]() {
+                return thread_id >= num_worker_threads_ || (work_ != nullptr && generation_ != generation);
+            });
+            if(thread_id >= num_worker_threads_) {
+                break;
+            }
+            work = work_;
+            generation = generation_;
+            num_busy_workers_++;
+        }
+
+        std::string prefix = hash_helper::toString(work->previous_epoch_highest_hash) + "_" +
+                work->owner_public_key.getAsShortString() + "_" + std::to_string(host_id_) + "_" +
+                std::to_string(work->work_nonce) + "_";
+
+        MiningLoop mining_loop(prefix, work->min_allowed_value, work->max_allowed_value,
+                               static_cast<uint64_t>(thread_id) << thread_counter_range_bits);
+        const Work& current_work = *work;
+        const std::function<void(const std::string&)> found_callback = [&current_work](const std::string& data_value) {
+            current_work.found_value_callback(current_work.epoch, data_value);
+        };
+        //the generation is checked after every batch, a change of work takes effect within microseconds
+        while(generation_.load(std::memory_order_relaxed) == generation && thread_id < num_worker_threads_) {
+            if(isThrottled(thread_id)) {
+                //the mining loop keeps its counters, the work continues where it paused
+                waitWhileThrottled(thread_id, generation);
+                continue;
+            }
+            stats_check_counter_ += mining_loop.checkNextBatch(found_callback);
         }
-        value++;
     }
 }
 
@@ -153,7 +275,7 @@ void MinerLocal::statsThread()
     const uint32_t cycle_time_ms = 1000;
     auto next_cycle_time = std::chrono::system_clock::now();
     uint64_t last_stats_check_counter = stats_check_counter_;
-    while(running_) {
+    while(!shutdown_) {
         uint64_t current_stats_check_counter = stats_check_counter_;
 
         if(current_stats_check_counter < last_stats_check_counter) {
@@ -166,7 +288,7 @@ void MinerLocal::statsThread()
         for(uint32_t i=0;i<10;i++) {
             next_cycle_time += std::chrono::milliseconds(cycle_time_ms/10);
             std::this_thread::sleep_until(next_cycle_time);
-            if(!running_) {
+            if(shutdown_) {
                 break;
             }
         }
@@ -20,11 +20,17 @@
 #include "IMiner.h"
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <atomic>
-#include <boost/multiprecision/cpp_int.hpp>
+#include <random>
 
 namespace scn {
 
+    //the worker threads live as long as the miner, start and stop only publish new work (or none) to them
+    //data values are prefix + host id + work nonce + counter, every worker thread mines its own counter range, so neither
+    //threads nor hosts (with different host ids) check a value twice
+    //the work nonce is drawn on every start, so a restart on the same epoch (e.g. after a new baseline) does not check
+    //the values of the previous start again
     class MinerLocal : public IMiner {
     public:
         explicit MinerLocal(uint32_t num_worker_threads);
@@ -47,27 +53,84 @@ namespace scn {
 
         uint64_t numChecksPerSecond() const override;
 
+        void enterConsensusPhase() override;
+
+        void leaveConsensusPhase() override;
+
+        virtual bool isInConsensusPhase() const;
+
+        //share of the worker threads which pause during consensus phases (0: no throttling), at least one worker keeps on mining
+        virtual void setConsensusPhaseThrottle(uint32_t percent);
+
+        virtual uint32_t getConsensusPhaseThrottle() const;
+
+        //number of workers currently paused by a consensus phase
+        virtual uint32_t numThrottledWorkers() const;
+
+        static const uint32_t default_consensus_phase_throttle_percent = 25;
+
+        //number of work changes so far, every start and stop increments it
+        virtual uint64_t getGeneration() const;
+
+        //random by default (full_node_cli: MINER_HOST_ID), takes effect with the next start
+        virtual void setHostId(uint32_t host_id);
+
+        virtual uint32_t getHostId() const;
+
+        //worker thread i mines the counter values [i << thread_counter_range_bits, (i+1) << thread_counter_range_bits)
+        static const uint32_t thread_counter_range_bits = 48;
+
     protected:
 
+        struct Work {
+            hash_t previous_epoch_highest_hash;
+            public_key_t owner_public_key;
+            epoch_t epoch;
+            std::function<void(epoch_t,const std::string&)> found_value_callback;
+            hash_t min_allowed_value;
+            hash_t max_allowed_value;
+            uint32_t work_nonce;
+        };
+
+        //publishes the work (nullptr pauses the workers), mtx_work_access_ has to be locked
+        void publishWork(const std::shared_ptr<const Work>& work);
+
+        //starts missing worker threads, mtx_work_access_ has to be locked
+        void spawnWorkerThreads();
+
+        //during consensus phases the workers with the highest thread ids pause
+        bool isThrottled(uint32_t thread_id) const;
+
+        //blocks until the worker is not throttled anymore or the work changes
+        void waitWhileThrottled(uint32_t thread_id, uint64_t generation);
+
         virtual void miningThread(uint32_t thread_id);
 
         virtual void statsThread();
 
         std::atomic<bool> running_;
-
-        uint32_t num_worker_threads_;
+        std::atomic<bool> shutdown_;
+
+        std::mutex mtx_work_access_;
+        std::condition_variable cv_work_available_;
+        std::condition_variable cv_worker_idle_;
+        std::shared_ptr<const Work> work_;
+        std::atomic<uint64_t> generation_;
+        uint32_t num_busy_workers_;
+        std::atomic<epoch_t> epoch_;
+
+        std::atomic<uint32_t> consensus_phase_depth_;
+        std::atomic<uint32_t> consensus_phase_throttle_percent_;
+        std::atomic<uint32_t> num_throttled_workers_;
+
+        std::atomic<uint32_t> host_id_;
+        std::mt19937 work_nonce_generator_; //mtx_work_access_ has to be locked
+        std::atomic<uint32_t> num_worker_threads_;
         std::vector<std::thread> workers_;
 
         std::atomic<uint64_t> stats_check_counter_;
         std::atomic<uint64_t> stats_check_counter_per_sec_;
         std::shared_ptr<std::thread> stats_thread_;
-
-        hash_t previous_epoch_highest_hash_;
-        public_key_t owner_public_key_;
-        epoch_t epoch_;
-        std::function<void(epoch_t,const std::string&)> found_value_callback_;
-        hash_t min_allowed_value_;
-        hash_t max_allowed_value_;
     };
 
 }
@@ -0,0 +1,62 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "MinerProtocol.h"
+
+using namespace scn;
+
+
+std::string miner_protocol::frameMessage(MessageType type, const std::string& payload) {
+    const uint32_t length = payload.length();
+    std::string message = {static_cast<char>(length >> 24), static_cast<char>(length >> 16),
+                           static_cast<char>(length >> 8), static_cast<char>(length),
+                           static_cast<char>(type)};
+    message.append(payload);
+    return message;
+}
+
+bool miner_protocol::parseHeader(const uint8_t (&header)[header_length], MessageType& type, uint32_t& length) {
+    length = (static_cast<uint32_t>(header[0]) << 24) | (static_cast<uint32_t>(header[1]) << 16) |
+             (static_cast<uint32_t>(header[2]) << 8) | static_cast<uint32_t>(header[3]);
+    if(length > max_message_length) {
+        LOG(ERROR) << "Miner protocol message too long (" << length << " bytes)";
+        return false;
+    }
+    type = static_cast<MessageType>(header[4]);
+    return true;
+}
+
+bool miner_protocol::writeMessage(boost::asio::ip::tcp::socket& socket, MessageType type, const std::string& payload) {
+    boost::system::error_code ec;
+    boost::asio::write(socket, boost::asio::buffer(frameMessage(type, payload)), ec);
+    return !ec;
+}
+
+bool miner_protocol::readMessage(boost::asio::ip::tcp::socket& socket, MessageType& type, std::string& payload) {
+    uint8_t header[header_length];
+    boost::system::error_code ec;
+    boost::asio::read(socket, boost::asio::buffer(header), ec);
+    uint32_t length;
+    if(ec || !parseHeader(header, type, length)) {
+        return false;
+    }
+    payload.resize(length);
+    if(length > 0) {
+        boost::asio::read(socket, boost::asio::buffer(&payload[0], length), ec);
+    }
+    return !ec;
+}
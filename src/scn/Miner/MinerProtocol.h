@@ -0,0 +1,152 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FULL_NODE_MINERPROTOCOL_H
+#define FULL_NODE_MINERPROTOCOL_H
+
+#include "scn/Common/Common.h"
+#include "scn/Common/Serialization/Hash.h"
+#include <cereal/archives/portable_binary.hpp>
+#include <cereal/types/string.hpp>
+#include <boost/asio.hpp>
+#include <sstream>
+
+namespace scn {
+
+    //protocol between a MinerServer (full node) and remote MinerClients (standalone miners)
+    //every message is framed as: 4 byte payload length (big endian), 1 byte message type, portable binary payload
+    //the client asks for work, mines the assigned counter range and reports every found data value
+    namespace miner_protocol {
+
+        static const uint32_t protocol_version = 1;
+
+        //larger messages are treated as protocol violation
+        static const uint32_t max_message_length = 4096;
+
+        static const uint32_t header_length = 5;
+
+        //counter ranges are multiples of this value, so every hash lane configuration mines complete ranges
+        static const uint64_t counter_value_granularity = 64;
+
+        enum class MessageType : uint8_t {
+            RequestWork = 1,
+            AssignWork = 2,
+            NoWork = 3,
+            FoundValue = 4
+        };
+
+        struct RequestWork {
+            uint32_t version;
+            //counter values checked since the last request (for the checks per second statistic)
+            uint64_t num_checked_values;
+            uint64_t num_requested_values;
+
+            template<class Archive>
+            void ser(Archive& ar) {
+                ar & version;
+                ar & num_checked_values;
+                ar & num_requested_values;
+            }
+        };
+
+        //a work unit: data values prefix + counter (upper case hex) for all counter values of the range
+        struct AssignWork {
+            uint64_t work_id;
+            epoch_t epoch;
+            std::string prefix;
+            hash_t min_allowed_value;
+            hash_t max_allowed_value;
+            uint64_t first_counter_value;
+            uint64_t num_counter_values;
+
+            template<class Archive>
+            void ser(Archive& ar) {
+                ar & work_id;
+                ar & epoch;
+                ar & prefix;
+                ar & min_allowed_value;
+                ar & max_allowed_value;
+                ar & first_counter_value;
+                ar & num_counter_values;
+            }
+        };
+
+        struct NoWork {
+            //time after which the client asks again
+            uint32_t retry_after_ms;
+
+            template<class Archive>
+            void ser(Archive& ar) {
+                ar & retry_after_ms;
+            }
+        };
+
+        struct FoundValue {
+            uint64_t work_id;
+            std::string data_value;
+
+            template<class Archive>
+            void ser(Archive& ar) {
+                ar & work_id;
+                ar & data_value;
+            }
+        };
+
+        //header and payload of a message as they are sent
+        std::string frameMessage(MessageType type, const std::string& payload);
+
+        //returns false if the header violates the framing
+        bool parseHeader(const uint8_t (&header)[header_length], MessageType& type, uint32_t& length);
+
+        //returns false if the connection is broken
+        bool writeMessage(boost::asio::ip::tcp::socket& socket, MessageType type, const std::string& payload);
+
+        //returns false if the connection is broken or the peer violates the framing
+        bool readMessage(boost::asio::ip::tcp::socket& socket, MessageType& type, std::string& payload);
+
+        template<class T>
+        std::string serializeMessage(T& message) {
+            std::ostringstream oss;
+            {
+                cereal::PortableBinaryOutputArchive oa(oss);
+                oa(message);
+            }
+            return oss.str();
+        }
+
+        template<class T>
+        bool writeMessage(boost::asio::ip::tcp::socket& socket, MessageType type, T& message) {
+            return writeMessage(socket, type, serializeMessage(message));
+        }
+
+        template<class T>
+        bool parseMessage(const std::string& payload, T& message) {
+            try {
+                std::istringstream iss(payload);
+                cereal::PortableBinaryInputArchive ia(iss);
+                ia(message);
+            } catch (const std::exception& e) {
+                LOG(ERROR) << "Invalid miner protocol message: " << e.what();
+                return false;
+            }
+            return true;
+        }
+
+    }
+
+}
+
+#endif //FULL_NODE_MINERPROTOCOL_H
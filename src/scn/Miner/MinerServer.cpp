@@ -0,0 +1,319 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "MinerServer.h"
+#include "scn/CryptoHelper/CryptoHelper.h"
+#include "scn/Blockchain/Blockchain.h"
+#include <chrono>
+
+using namespace scn;
+using boost::asio::ip::tcp;
+
+const char* const MinerServer::default_listen_address = "127.0.0.1";
+const uint32_t MinerServer::default_max_num_connections;
+const uint32_t MinerServer::accept_retry_ms;
+
+
+MinerServer::MinerServer(uint16_t port, IMiner* local_miner, const std::string& listen_address, uint32_t max_num_connections)
+:local_miner_(local_miner)
+,max_num_connections_(max_num_connections)
+,io_context_()
+,acceptor_(io_context_, tcp::endpoint(boost::asio::ip::make_address(listen_address), port))
+,accept_retry_timer_(io_context_)
+,shutdown_(false)
+,running_(false)
+,work_id_(0)
+,epoch_(0)
+,next_counter_value_(0)
+,generator_(time(nullptr))
+,stats_check_counter_(0)
+,stats_check_counter_per_sec_(0) {
+    LOG(INFO) << "Miner server listening on " << getListenAddress() << " port " << getPort();
+    startAccept();
+    io_thread_ = std::make_shared<std::thread>(&MinerServer::ioThread, this);
+    stats_thread_ = std::make_shared<std::thread>(&MinerServer::statsThread, this);
+}
+
+MinerServer::~MinerServer() {
+    stop();
+    shutdown_ = true;
+    //sockets are closed on the io thread, pending operations are aborted then and the io thread runs out of work
+    boost::asio::post(io_context_, [this]() {
+        boost::system::error_code ec;
+        acceptor_.close(ec);
+        accept_retry_timer_.cancel();
+        LOCK_MUTEX_WATCHDOG(mtx_connections_access_);
+        for(auto& connection : connections_) {
+            connection->socket.close(ec);
+        }
+    });
+    io_thread_->join();
+    stats_thread_->join();
+}
+
+MinerServer::Connection::Connection(boost::asio::io_context& io_context)
+:socket(io_context)
+,remote_endpoint()
+,header()
+,payload()
+,reply() {
+
+}
+
+void MinerServer::start(const hash_t& previous_epoch_highest_hash,
+                        const public_key_t& owner_public_key,
+                        const epoch_t epoch,
+                        std::function<void(epoch_t, const std::string &)> found_value_callback) {
+    LOG(INFO) << "Serving epoch " << epoch << " to remote miners";
+    {
+        LOCK_MUTEX_WATCHDOG(mtx_work_access_);
+        //the random part separates the counter ranges of this node from the ones of other nodes with the same key
+        std::uniform_int_distribution<uint32_t> distribution(0, 1000000000);
+        prefix_ = hash_helper::toString(previous_epoch_highest_hash) + "_" +
+                owner_public_key.getAsShortString() + "_" + std::to_string(distribution(generator_)) + "_";
+        epoch_ = epoch;
+        Blockchain::getHashArea(epoch, max_allowed_value_, min_allowed_value_);
+        next_counter_value_ = 0;
+        found_value_callback_ = found_value_callback;
+        work_id_++;
+        running_ = true;
+    }
+    if(local_miner_) {
+        local_miner_->start(previous_epoch_highest_hash, owner_public_key, epoch, found_value_callback);
+    }
+}
+
+void MinerServer::stop() {
+    {
+        //found values are handled while holding the mutex - no callback is running after this block
+        LOCK_MUTEX_WATCHDOG(mtx_work_access_);
+        running_ = false;
+        work_id_++;
+    }
+    if(local_miner_) {
+        local_miner_->stop();
+    }
+}
+
+bool MinerServer::isRunning() const {
+    return running_;
+}
+
+epoch_t MinerServer::getEpoch() const {
+    LOCK_MUTEX_WATCHDOG(mtx_work_access_);
+    return epoch_;
+}
+
+uint64_t MinerServer::numChecksPerSecond() const {
+    return stats_check_counter_per_sec_ + (local_miner_ ? local_miner_->numChecksPerSecond() : 0);
+}
+
+void MinerServer::enterConsensusPhase() {
+    if(local_miner_) {
+        local_miner_->enterConsensusPhase();
+    }
+}
+
+void MinerServer::leaveConsensusPhase() {
+    if(local_miner_) {
+        local_miner_->leaveConsensusPhase();
+    }
+}
+
+uint16_t MinerServer::getPort() const {
+    return acceptor_.local_endpoint().port();
+}
+
+std::string MinerServer::getListenAddress() const {
+    return acceptor_.local_endpoint().address().to_string();
+}
+
+uint32_t MinerServer::numConnectedMiners() const {
+    LOCK_MUTEX_WATCHDOG(mtx_connections_access_);
+    return connections_.size();
+}
+
+void MinerServer::ioThread() {
+    io_context_.run();
+}
+
+void MinerServer::startAccept() {
+    auto connection = std::make_shared<Connection>(io_context_);
+    acceptor_.async_accept(connection->socket, [this, connection](const boost::system::error_code& ec) {
+        if(shutdown_) {
+            return;
+        }
+        if(ec) {
+            LOG(ERROR) << "Miner server accept failed: " << ec.message();
+            accept_retry_timer_.expires_after(std::chrono::milliseconds(accept_retry_ms));
+            accept_retry_timer_.async_wait([this](const boost::system::error_code& ec) {
+                if(!ec && !shutdown_) {
+                    startAccept();
+                }
+            });
+            return;
+        }
+        startAccept();
+
+        boost::system::error_code option_ec;
+        connection->socket.set_option(tcp::no_delay(true), option_ec);
+        connection->remote_endpoint = connection->socket.remote_endpoint(option_ec);
+        {
+            LOCK_MUTEX_WATCHDOG(mtx_connections_access_);
+            if(connections_.size() >= max_num_connections_) {
+                LOG(WARNING) << "Miner server: rejecting connection from " << connection->remote_endpoint <<
+                             ", limit of " << max_num_connections_ << " connections reached";
+                connection->socket.close(option_ec);
+                return;
+            }
+            connections_.insert(connection);
+        }
+        LOG(INFO) << "Remote miner connected: " << connection->remote_endpoint;
+        startRead(connection);
+    });
+}
+
+void MinerServer::startRead(const std::shared_ptr<Connection>& connection) {
+    boost::asio::async_read(connection->socket, boost::asio::buffer(connection->header),
+                            [this, connection](const boost::system::error_code& ec, std::size_t) {
+        miner_protocol::MessageType type;
+        uint32_t length;
+        if(ec || !miner_protocol::parseHeader(connection->header, type, length)) {
+            closeConnection(connection);
+            return;
+        }
+        connection->payload.resize(length);
+        boost::asio::async_read(connection->socket, boost::asio::buffer(&connection->payload[0], length),
+                                [this, connection, type](const boost::system::error_code& ec, std::size_t) {
+            if(ec) {
+                closeConnection(connection);
+                return;
+            }
+            handleMessage(connection, type);
+        });
+    });
+}
+
+void MinerServer::handleMessage(const std::shared_ptr<Connection>& connection, miner_protocol::MessageType type) {
+    if(type == miner_protocol::MessageType::RequestWork) {
+        if(!handleRequestWork(connection->payload, connection->reply)) {
+            closeConnection(connection);
+            return;
+        }
+        boost::asio::async_write(connection->socket, boost::asio::buffer(connection->reply),
+                                 [this, connection](const boost::system::error_code& ec, std::size_t) {
+            if(ec) {
+                closeConnection(connection);
+                return;
+            }
+            startRead(connection);
+        });
+    } else if(type == miner_protocol::MessageType::FoundValue) {
+        handleFoundValue(connection->payload);
+        startRead(connection);
+    } else {
+        LOG(ERROR) << "Unexpected miner protocol message type " << static_cast<uint32_t>(type);
+        closeConnection(connection);
+    }
+}
+
+void MinerServer::closeConnection(const std::shared_ptr<Connection>& connection) {
+    boost::system::error_code ec;
+    connection->socket.close(ec);
+    LOG(INFO) << "Remote miner disconnected: " << connection->remote_endpoint;
+    LOCK_MUTEX_WATCHDOG(mtx_connections_access_);
+    connections_.erase(connection);
+}
+
+bool MinerServer::handleRequestWork(const std::string& payload, std::string& reply) {
+    miner_protocol::RequestWork request;
+    if(!miner_protocol::parseMessage(payload, request)) {
+        return false;
+    }
+    if(request.version != miner_protocol::protocol_version) {
+        LOG(ERROR) << "Remote miner uses protocol version " << request.version << " instead of " << miner_protocol::protocol_version;
+        return false;
+    }
+    stats_check_counter_ += request.num_checked_values;
+
+    miner_protocol::AssignWork work;
+    work.num_counter_values = 0;
+    {
+        LOCK_MUTEX_WATCHDOG(mtx_work_access_);
+        if(running_) {
+            const uint64_t granularity = miner_protocol::counter_value_granularity;
+            const uint64_t max_num_counter_values = max_work_unit_size;
+            work.work_id = work_id_;
+            work.epoch = epoch_;
+            work.prefix = prefix_;
+            work.min_allowed_value = min_allowed_value_;
+            work.max_allowed_value = max_allowed_value_;
+            work.first_counter_value = next_counter_value_;
+            work.num_counter_values = std::min(std::max(request.num_requested_values, granularity), max_num_counter_values);
+            work.num_counter_values = (work.num_counter_values + granularity - 1) / granularity * granularity;
+            next_counter_value_ += work.num_counter_values;
+        }
+    }
+
+    if(work.num_counter_values == 0) {
+        miner_protocol::NoWork no_work;
+        no_work.retry_after_ms = retry_after_ms;
+        reply = miner_protocol::frameMessage(miner_protocol::MessageType::NoWork, miner_protocol::serializeMessage(no_work));
+    } else {
+        reply = miner_protocol::frameMessage(miner_protocol::MessageType::AssignWork, miner_protocol::serializeMessage(work));
+    }
+    return true;
+}
+
+void MinerServer::handleFoundValue(const std::string& payload) {
+    miner_protocol::FoundValue found_value;
+    if(!miner_protocol::parseMessage(payload, found_value)) {
+        return;
+    }
+
+    LOCK_MUTEX_WATCHDOG(mtx_work_access_);
+    if(!running_ || found_value.work_id != work_id_) {
+        LOG(INFO) << "Drop found value of outdated work " << found_value.work_id;
+        return;
+    }
+    //remote miners are not trusted, the value has to belong to the current work
+    auto hash = CryptoHelper::calcHash(found_value.data_value);
+    if(found_value.data_value.compare(0, prefix_.length(), prefix_) != 0 ||
+       hash < min_allowed_value_ || hash > max_allowed_value_) {
+        LOG(ERROR) << "Remote miner found invalid value " << found_value.data_value;
+        return;
+    }
+    found_value_callback_(epoch_, found_value.data_value);
+}
+
+void MinerServer::statsThread() {
+    const uint32_t cycle_time_ms = 1000;
+    auto next_cycle_time = std::chrono::system_clock::now();
+    uint64_t last_stats_check_counter = stats_check_counter_;
+    while(!shutdown_) {
+        uint64_t current_stats_check_counter = stats_check_counter_;
+        stats_check_counter_per_sec_ = (current_stats_check_counter - last_stats_check_counter) * 1000 / cycle_time_ms;
+        last_stats_check_counter = current_stats_check_counter;
+        for(uint32_t i=0;i<10;i++) {
+            next_cycle_time += std::chrono::milliseconds(cycle_time_ms/10);
+            std::this_thread::sleep_until(next_cycle_time);
+            if(shutdown_) {
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,145 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FULL_NODE_MINERSERVER_H
+#define FULL_NODE_MINERSERVER_H
+
+#include "IMiner.h"
+#include "MinerProtocol.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <set>
+#include <random>
+
+namespace scn {
+
+    //hands out work units (prefix, epoch, hash area and counter range) to remote MinerClients over TCP
+    //found values are checked and passed to the found value callback of the current work
+    //all sockets are served by asynchronous operations on a single io thread, which also runs the callbacks
+    //NOTE: the protocol is not authenticated - listens on loopback unless another address is given explicitly
+    class MinerServer : public IMiner {
+    public:
+        //port 0 picks a free port, local_miner (optional) mines the same epochs next to the remote miners
+        //connections beyond max_num_connections (one per remote mining thread) are closed right away
+        explicit MinerServer(uint16_t port, IMiner* local_miner = nullptr,
+                             const std::string& listen_address = default_listen_address,
+                             uint32_t max_num_connections = default_max_num_connections);
+        ~MinerServer() override;
+
+        void start(const hash_t& previous_epoch_highest_hash,
+                   const public_key_t& owner_public_key,
+                   epoch_t epoch,
+                   std::function<void(epoch_t,const std::string&)> found_value_callback) override;
+
+        void stop() override;
+
+        bool isRunning() const override;
+
+        epoch_t getEpoch() const override;
+
+        //local and remote checks
+        uint64_t numChecksPerSecond() const override;
+
+        //only the local miner is throttled, remote miners run on other hosts
+        void enterConsensusPhase() override;
+
+        void leaveConsensusPhase() override;
+
+        virtual uint16_t getPort() const;
+
+        virtual std::string getListenAddress() const;
+
+        virtual uint32_t numConnectedMiners() const;
+
+        //upper limit of the counter range of a single work unit
+        static const uint64_t max_work_unit_size = 1ull << 32;
+
+        //time after which an idle client asks for work again
+        static const uint32_t retry_after_ms = 200;
+
+        static const char* const default_listen_address;
+
+        static const uint32_t default_max_num_connections = 256;
+
+    protected:
+
+        //a remote miner, only used on the io thread (buffers stay alive while an operation is pending)
+        struct Connection {
+            explicit Connection(boost::asio::io_context& io_context);
+
+            boost::asio::ip::tcp::socket socket;
+            boost::asio::ip::tcp::endpoint remote_endpoint;
+            uint8_t header[miner_protocol::header_length];
+            std::string payload;
+            std::string reply;
+        };
+
+        //time after which accepting is retried if it failed (e.g. too many open files)
+        static const uint32_t accept_retry_ms = 100;
+
+        virtual void ioThread();
+
+        virtual void statsThread();
+
+        //the handlers of the asynchronous operations start the next operation, so every connection reads
+        //a request, writes the reply (if any) and reads again until it is closed
+        void startAccept();
+
+        void startRead(const std::shared_ptr<Connection>& connection);
+
+        void handleMessage(const std::shared_ptr<Connection>& connection, miner_protocol::MessageType type);
+
+        void closeConnection(const std::shared_ptr<Connection>& connection);
+
+        //false if the request is invalid, the connection is closed then
+        bool handleRequestWork(const std::string& payload, std::string& reply);
+
+        void handleFoundValue(const std::string& payload);
+
+        IMiner* local_miner_;
+        const uint32_t max_num_connections_;
+
+        boost::asio::io_context io_context_;
+        boost::asio::ip::tcp::acceptor acceptor_;
+        boost::asio::steady_timer accept_retry_timer_;
+        std::atomic<bool> shutdown_;
+        std::shared_ptr<std::thread> io_thread_;
+        std::shared_ptr<std::thread> stats_thread_;
+
+        //modified on the io thread only, the mutex is for numConnectedMiners()
+        mutable std::mutex mtx_connections_access_;
+        std::set<std::shared_ptr<Connection>> connections_;
+
+        //current work, next_counter_value_ is the begin of the next unassigned counter range
+        mutable std::mutex mtx_work_access_;
+        std::atomic<bool> running_;
+        uint64_t work_id_;
+        epoch_t epoch_;
+        std::string prefix_;
+        hash_t min_allowed_value_;
+        hash_t max_allowed_value_;
+        uint64_t next_counter_value_;
+        std::function<void(epoch_t,const std::string&)> found_value_callback_;
+        std::default_random_engine generator_;
+
+        std::atomic<uint64_t> stats_check_counter_;
+        std::atomic<uint64_t> stats_check_counter_per_sec_;
+    };
+
+}
+
+#endif //FULL_NODE_MINERSERVER_H
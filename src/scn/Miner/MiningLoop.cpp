@@ -0,0 +1,116 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "MiningLoop.h"
+#include "scn/CryptoHelper/CryptoHelper.h"
+#include <cstring>
+
+using namespace scn;
+
+namespace {
+    const char hex_digits[] = "0123456789ABCDEF";
+
+    inline uint32_t hexValue(uint8_t digit) {
+        return digit <= '9' ? digit - '0' : digit - 'A' + 10;
+    }
+
+    inline uint64_t readBigEndian64(const uint8_t* data) {
+        uint64_t value = 0;
+        for(uint32_t i=0;i<8;i++) {
+            value = (value << 8) | data[i];
+        }
+        return value;
+    }
+}
+
+
+MiningLoop::MiningLoop(const std::string& prefix, const hash_t& min_allowed_value, const hash_t& max_allowed_value,
+                       uint64_t first_counter_value)
+:prefix_(prefix)
+,midstate_(MultiBufferHash::calcMidstate(prefix))
+,tail_length_(prefix.length() - midstate_.num_bytes)
+,num_lanes_(MultiBufferHash::getNumLanes())
+,message_stride_(tail_length_ + max_payload_length)
+,message_buffer_(num_lanes_ * message_stride_)
+,messages_(num_lanes_)
+,lengths_(num_lanes_)
+,digests_(num_lanes_ * CryptoHelper::serialized_hash_size)
+,min_allowed_value_(min_allowed_value)
+,max_allowed_value_(max_allowed_value)
+,min_allowed_leading_word_(min_allowed_value.getWord(0))
+,max_allowed_leading_word_(max_allowed_value.getWord(0)) {
+    //the complete 64 byte blocks of the prefix are hashed only once, every message consists of the rest of the
+    //prefix (tail) and the counter value of its lane, lane i starts with counter value first_counter_value + i
+    for(uint32_t lane=0;lane<num_lanes_;lane++) {
+        uint8_t* message = &message_buffer_[lane * message_stride_];
+        std::copy(prefix_.begin() + midstate_.num_bytes, prefix_.end(), message);
+        message[tail_length_] = '0';
+        uint64_t num_digits = 1;
+        addToHexString(&message[tail_length_], num_digits, first_counter_value);
+        addToHexString(&message[tail_length_], num_digits, lane);
+        messages_[lane] = message;
+        lengths_[lane] = tail_length_ + num_digits;
+    }
+}
+
+uint32_t MiningLoop::checkNextBatch(const std::function<void(const std::string&)>& found_callback) {
+    MultiBufferHash::calcHashesFromMidstate(midstate_, messages_.data(), lengths_.data(), num_lanes_, digests_.data());
+
+    for(uint32_t lane=0;lane<num_lanes_;lane++) {
+        const uint8_t* digest = &digests_[lane * CryptoHelper::serialized_hash_size];
+        //almost every hash is rejected by its leading 64 bits, only the rest gets the full 256 bit compare
+        const uint64_t leading_word = readBigEndian64(digest);
+        if(leading_word < min_allowed_leading_word_ || leading_word > max_allowed_leading_word_) {
+            continue;
+        }
+        auto hash = hash_helper::fromArray(digest);
+        if(hash >= min_allowed_value_ && hash <= max_allowed_value_) {
+            found_callback(prefix_ + getPayload(lane));
+        }
+    }
+
+    for(uint32_t lane=0;lane<num_lanes_;lane++) {
+        uint64_t num_digits = lengths_[lane] - tail_length_;
+        addToHexString(&message_buffer_[lane * message_stride_ + tail_length_], num_digits, num_lanes_);
+        lengths_[lane] = tail_length_ + num_digits;
+    }
+
+    return num_lanes_;
+}
+
+uint32_t MiningLoop::getNumLanes() const {
+    return num_lanes_;
+}
+
+std::string MiningLoop::getPayload(uint32_t lane) const {
+    return std::string(messages_[lane] + tail_length_, messages_[lane] + lengths_[lane]);
+}
+
+void MiningLoop::addToHexString(uint8_t* digits, uint64_t& num_digits, uint64_t increment) {
+    uint64_t carry = increment;
+    for(uint64_t i=num_digits;i>0 && carry!=0;i--) {
+        const uint64_t sum = hexValue(digits[i - 1]) + carry;
+        digits[i - 1] = hex_digits[sum & 0xF];
+        carry = sum >> 4;
+    }
+    while(carry != 0 && num_digits < max_payload_length) {
+        std::memmove(digits + 1, digits, num_digits);
+        digits[0] = hex_digits[carry & 0xF];
+        carry >>= 4;
+        num_digits++;
+    }
+}
@@ -0,0 +1,70 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FULL_NODE_MININGLOOP_H
+#define FULL_NODE_MININGLOOP_H
+
+#include "scn/Common/Common.h"
+#include "scn/CryptoHelper/MultiBufferHash.h"
+#include <functional>
+
+namespace scn {
+
+    //inner loop of a mining thread: checks prefix + counter (upper case hex without leading zeros) for consecutive
+    //counter values starting at first_counter_value, one counter per hash lane
+    //all buffers are allocated in the constructor, checkNextBatch only allocates for values inside the hash area
+    class MiningLoop {
+    public:
+        MiningLoop(const std::string& prefix, const hash_t& min_allowed_value, const hash_t& max_allowed_value,
+                   uint64_t first_counter_value = 0);
+
+        //checks the next getNumLanes() counter values and calls found_callback with the complete data value of every
+        //hash inside the hash area, returns the number of checked values
+        uint32_t checkNextBatch(const std::function<void(const std::string&)>& found_callback);
+
+        uint32_t getNumLanes() const;
+
+        //counter value of the given lane in the next batch as upper case hex string
+        std::string getPayload(uint32_t lane) const;
+
+        //more hex digits than any miner can ever reach
+        static const uint32_t max_payload_length = 32;
+
+    protected:
+
+        //adds increment to the upper case hex string in place, the string grows by one digit on overflow
+        static void addToHexString(uint8_t* digits, uint64_t& num_digits, uint64_t increment);
+
+        std::string prefix_;
+        MultiBufferHash::Midstate midstate_;
+        uint64_t tail_length_;
+        uint32_t num_lanes_;
+        uint32_t message_stride_;
+        std::vector<uint8_t> message_buffer_;
+        std::vector<const uint8_t*> messages_;
+        std::vector<uint64_t> lengths_;
+        std::vector<uint8_t> digests_;
+
+        hash_t min_allowed_value_;
+        hash_t max_allowed_value_;
+        //leading 64 bits of the hash area for the early reject
+        uint64_t min_allowed_leading_word_;
+        uint64_t max_allowed_leading_word_;
+    };
+
+}
+
+#endif //FULL_NODE_MININGLOOP_H
@@ -382,37 +382,32 @@ void P2PConnector::receivedMessage(libtorrent::IPeer& peer, const std::string& m
 
                 block_uid_t uid;
                 ia >> uid;
-                auto baseblock = blockchain_.getBlock(uid);
-                if (baseblock) {
-                    switch (baseblock->header.generic_header.block_type) {
+                //the reply is serialized once per block and shared by all peers asking for it
+                auto message = blockchain_.getEncodedBlock(uid, [this](const BaseBlock& baseblock) {
+                    std::stringstream oss;
+                    cereal::PortableBinaryOutputArchive oa(oss);
+                    const bool reply = true;
+                    oa << protocol_version_;
+                    switch (baseblock.header.generic_header.block_type) {
                         case BlockType::BaselineBlock:
                         default: {
-                            auto block = std::static_pointer_cast<scn::BaselineBlock>(baseblock);
-                            std::stringstream oss;
-                            cereal::PortableBinaryOutputArchive oa(oss);
                             const MessageType type = MessageType::PropagateBaselineBlock;
-                            const bool reply = true;
-                            oa << protocol_version_;
                             oa << (uint8_t)type;
-                            oa << *block;
-                            oa << reply;
-                            peer.sendMessage(std::make_shared<std::string>(std::move(oss.str())));
+                            oa << static_cast<const BaselineBlock&>(baseblock);
                             break;
                         }
                         case BlockType::CollectionBlock: {
-                            auto block = std::static_pointer_cast<scn::CollectionBlock>(baseblock);
-                            std::stringstream oss;
-                            cereal::PortableBinaryOutputArchive oa(oss);
                             const MessageType type = MessageType::PropagateCollectionBlock;
-                            const bool reply = true;
-                            oa << protocol_version_;
                             oa << (uint8_t)type;
-                            oa << *block;
-                            oa << reply;
-                            peer.sendMessage(std::make_shared<std::string>(std::move(oss.str())));
+                            oa << static_cast<const CollectionBlock&>(baseblock);
                             break;
                         }
                     }
+                    oa << reply;
+                    return oss.str();
+                });
+                if (message) {
+                    peer.sendMessage(message);
                 } else {
                     LOG(INFO) << "could not get AskForBlock answer";
                 }
@@ -16,7 +16,13 @@
 
 #include "scn/CryptoHelper/CryptoHelper.h"
 #include "scn/Blockchain/Blockchain.h"
+#include "scn/Blockchain/BlockStore.h"
+#include "scn/Blockchain/Cache.h"
+#include "stubs/SealedEpochStoreStub.h"
+#include "TestUtils.h"
 #include <gtest/gtest.h>
+#include <boost/filesystem.hpp>
+#include <fstream>
 
 using namespace scn;
 
@@ -245,6 +251,35 @@ TEST_F(TestBlockchain, HashAreaCalculation) {
     EXPECT_EQ(hash_helper::toString(min_allowed_hash), "0");
 }
 
+TEST_F(TestBlockchain, HashAreaTableMatchesCalculation) {
+    EXPECT_EQ(hash_helper::toString(HashAreaTable::getInstance().calcChecksum()), HashAreaTable::expected_checksum);
+    for(epoch_t epoch : {0ul, 1ul, 2ul, 17ul, 999ul, 31337ul, 92538ul, 96754ul, 96755ul, 96756ul, 96757ul, 200000ul}) {
+        hash_t max_allowed_hash, min_allowed_hash, expected_max_allowed_hash, expected_min_allowed_hash;
+        Blockchain::getHashArea(epoch, max_allowed_hash, min_allowed_hash);
+        HashAreaTable::calcHashArea(epoch, expected_max_allowed_hash, expected_min_allowed_hash);
+        EXPECT_EQ(max_allowed_hash, expected_max_allowed_hash);
+        EXPECT_EQ(min_allowed_hash, expected_min_allowed_hash);
+    }
+}
+
+TEST_F(TestBlockchain, HashAreaTableBenchmark) {
+    hash_t max_allowed_hash, min_allowed_hash;
+    Blockchain::getHashArea(0, max_allowed_hash, min_allowed_hash); //build table
+
+    const uint32_t num_lookups = 20;
+    const epoch_t epoch = 90000;
+    auto t0 = std::chrono::steady_clock::now();
+    for(uint32_t i=0;i<num_lookups;i++) {
+        HashAreaTable::calcHashArea(epoch, max_allowed_hash, min_allowed_hash);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for(uint32_t i=0;i<num_lookups;i++) {
+        Blockchain::getHashArea(epoch, max_allowed_hash, min_allowed_hash);
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    EXPECT_LT(t2 - t1, t1 - t0);
+}
+
 
 TEST_F(TestBlockchain, validateCollectionBlockValid) {
     addBlock({valid_data_values_epoch_0[1]}, {}); //add some balance
@@ -843,4 +878,642 @@ TEST_F(TestBlockchain, BlockchainOutputStream) {
     EXPECT_NE(stream.str().find(std::to_string(block1.header.block_uid)), std::string::npos);
     EXPECT_NE(stream.str().find(std::to_string(block2.header.block_uid)), std::string::npos);
     EXPECT_NE(stream.str().find(std::to_string(block3.header.block_uid)), std::string::npos);
-}
\ No newline at end of file
+}
+
+TEST_F(TestBlockchain, ParallelVerifierAllPassed) {
+    ParallelVerifier verifier(4);
+    std::vector<std::atomic<uint32_t>> num_calls(1000);
+    auto result = verifier.verify(num_calls.size(), [&](uint32_t index) {
+        num_calls[index]++;
+        return true;
+    });
+    EXPECT_EQ(result, num_calls.size());
+    for(auto& counter : num_calls) {
+        EXPECT_EQ(counter, 1);
+    }
+}
+
+TEST_F(TestBlockchain, ParallelVerifierFirstFailure) {
+    ParallelVerifier verifier(4);
+    for(uint32_t run=0;run<20;run++) {
+        auto result = verifier.verify(1000, [](uint32_t index) {
+            return index != 371 && index != 372 && index != 900;
+        });
+        EXPECT_EQ(result, 371);
+    }
+    EXPECT_EQ(verifier.verify(0, [](uint32_t index) { return false; }), 0);
+    EXPECT_EQ(verifier.verify(3, [](uint32_t index) { return index != 1; }), 1);
+}
+
+TEST_F(TestBlockchain, validateCollectionBlockManySubBlocks) {
+    blockchain.setRootBlock(buildBaselineBlock());
+    std::vector<std::pair<public_key_t, uint64_t>> transactions;
+    for(uint32_t i=1;i<=50;i++) {
+        transactions.emplace_back(other_public_key, i);
+    }
+    auto block = buildCollectionBlock({valid_data_values_epoch_0[4], valid_data_values_epoch_0[5]}, transactions);
+    EXPECT_TRUE(blockchain.validateBlock(block));
+
+    auto it = std::next(block.transactions.begin(), 27);
+    it->second.fraction++;
+    block.header.generic_header.block_hash = 0;
+    CryptoHelper::fillHash(block);
+    EXPECT_FALSE(blockchain.validateBlock(block));
+}
+
+TEST_F(TestBlockchain, validateCollectionBlockVerdictCache) {
+    blockchain.setRootBlock(buildBaselineBlock());
+    auto& verdict_cache = blockchain.getSubBlockVerdictCache();
+    auto block = buildCollectionBlock({valid_data_values_epoch_0[4], valid_data_values_epoch_0[5]},
+                                      {{other_public_key, 1}, {other_public_key, 2}});
+    EXPECT_TRUE(blockchain.validateBlock(block));
+    EXPECT_EQ(verdict_cache.size(), 4);
+    auto num_hits = verdict_cache.numHits();
+
+    //same sub-blocks propagated again are not verified again
+    EXPECT_TRUE(blockchain.validateBlock(block));
+    EXPECT_EQ(verdict_cache.numHits(), num_hits + 4);
+
+    //changed content with the same claimed hash must not hit the cache
+    auto modified_block = block;
+    modified_block.transactions.begin()->second.fraction = 100000000;
+    modified_block.header.generic_header.block_hash = 0;
+    CryptoHelper::fillHash(modified_block);
+    EXPECT_FALSE(blockchain.validateBlock(modified_block));
+
+    //a new newest block invalidates all verdicts
+    blockchain.addBlock(block);
+    EXPECT_EQ(verdict_cache.size(), 0);
+    auto next_block = buildCollectionBlock({}, {});
+    next_block.transactions = block.transactions;
+    next_block.header.generic_header.block_hash = 0;
+    CryptoHelper::fillHash(next_block);
+    EXPECT_FALSE(blockchain.validateBlock(next_block));
+}
+
+TEST_F(TestBlockchain, validateCreationSubBlocksBatch) {
+    addBlock({valid_data_values_epoch_0[0]}, {});
+    auto valid_1 = buildCreationSubBlock(valid_data_values_epoch_0[1]);
+    auto valid_2 = buildCreationSubBlock(valid_data_values_epoch_0[2]);
+    auto already_in_chain = buildCreationSubBlock(valid_data_values_epoch_0[0]);
+    auto invalid_data_value = buildCreationSubBlock(valid_data_values_epoch_0[3] + "F");
+    auto invalid_hash = buildCreationSubBlock(valid_data_values_epoch_0[4]);
+    invalid_hash.header.generic_header.block_hash = CryptoHelper::calcHash("modified");
+
+    auto verdicts = blockchain.validateSubBlocks({&valid_1, &already_in_chain, &invalid_data_value, &valid_2, &invalid_hash});
+    EXPECT_EQ(verdicts, std::vector<bool>({true, false, false, true, false}));
+    //the verdicts match the single checks and the valid ones are cached
+    EXPECT_TRUE(blockchain.validateSubBlock(valid_1));
+    EXPECT_FALSE(blockchain.validateSubBlock(already_in_chain));
+    EXPECT_FALSE(blockchain.validateSubBlock(invalid_data_value));
+    EXPECT_EQ(blockchain.getSubBlockVerdictCache().size(), 2);
+    EXPECT_TRUE(blockchain.validateSubBlocks({}).empty());
+}
+
+TEST_F(TestBlockchain, WalletTableMatchesMap) {
+    std::map<public_key_t, uint64_t> expected_wallets;
+    WalletTable wallets;
+    for(uint32_t i=0;i<1000;i++) {
+        public_key_t public_key("-----BEGIN PUBLIC KEY-----\nKEY" + std::to_string((i * 7919) % 1000) + "\n-----END PUBLIC KEY-----");
+        expected_wallets[public_key] += i;
+        wallets[public_key] += i;
+    }
+    wallets[example_owner_public_key] += 5;
+    expected_wallets[example_owner_public_key] += 5;
+
+    EXPECT_EQ(wallets.size(), expected_wallets.size());
+    EXPECT_EQ(wallets.getBalance(example_owner_public_key_modified), 5);
+    EXPECT_EQ(wallets.getBalance(other_public_key), 0);
+    EXPECT_FALSE(wallets.contains(other_public_key)); //lookup does not create a wallet
+    EXPECT_EQ(wallets.toOrderedMap(), expected_wallets);
+
+    WalletTable assigned_wallets;
+    assigned_wallets.assign(expected_wallets);
+    EXPECT_EQ(assigned_wallets.toOrderedMap(), expected_wallets);
+    assigned_wallets.clear();
+    EXPECT_EQ(assigned_wallets.size(), 0);
+
+    //copies are not affected by changes of the table they were copied from and vice versa
+    WalletTable copied_wallets(wallets);
+    wallets[example_owner_public_key] += 1;
+    wallets[other_public_key] = 7;
+    EXPECT_EQ(copied_wallets.getBalance(example_owner_public_key), 5);
+    EXPECT_FALSE(copied_wallets.contains(other_public_key));
+    EXPECT_EQ(copied_wallets.size(), expected_wallets.size());
+    EXPECT_EQ(copied_wallets.toOrderedMap(), expected_wallets);
+    copied_wallets[other_public_key_2] = 3;
+    EXPECT_FALSE(wallets.contains(other_public_key_2));
+    EXPECT_EQ(wallets.getBalance(example_owner_public_key), 6);
+    EXPECT_EQ(wallets.size(), expected_wallets.size() + 1);
+}
+
+TEST_F(TestBlockchain, WalletsInEstablishedBaseline) {
+    blockchain.setRootBlock(buildBaselineBlock());
+    addBlock({valid_data_values_epoch_0[4]}, {{other_public_key_2, 1700}});
+    blockchain.establishBaseline();
+
+    auto baseline_block = std::static_pointer_cast<BaselineBlock>(blockchain.getRootBlock());
+    std::map<public_key_t, uint64_t> expected_wallets = {
+            {example_owner_public_key, 3 * TransactionSubBlock::fraction_per_coin - 1700},
+            {other_public_key, 2 * TransactionSubBlock::fraction_per_coin},
+            {other_public_key_2, 1700}};
+    EXPECT_EQ(baseline_block->wallets, expected_wallets);
+    EXPECT_EQ(blockchain.getNumWallets(), 3);
+    EXPECT_EQ(blockchain.getBalance(other_public_key_2), 1700);
+}
+
+TEST_F(TestBlockchain, ChainStateSnapshot) {
+    addBlock({valid_data_values_epoch_0[1]}, {});
+    auto chain_state = blockchain.getChainState();
+    EXPECT_EQ(chain_state->newest_block_id, blockchain.getNewestBlockId());
+    EXPECT_EQ(chain_state->wallets->getBalance(example_owner_public_key), 1000000);
+    EXPECT_EQ(chain_state->data_value_hashes_of_epoch->size(), 1);
+
+    addBlock({valid_data_values_epoch_0[2]}, {{other_public_key, 1700}});
+
+    //the old snapshot is unchanged
+    EXPECT_EQ(chain_state->newest_block_id + 1, blockchain.getNewestBlockId());
+    EXPECT_EQ(chain_state->wallets->getBalance(example_owner_public_key), 1000000);
+    EXPECT_EQ(chain_state->data_value_hashes_of_epoch->size(), 1);
+    EXPECT_EQ(chain_state->mining_state.num_minings_in_epoch, 1);
+
+    auto new_chain_state = blockchain.getChainState();
+    EXPECT_EQ(new_chain_state->wallets->getBalance(example_owner_public_key), 2000000 - 1700);
+    EXPECT_EQ(new_chain_state->wallets->getBalance(other_public_key), 1700);
+    EXPECT_EQ(new_chain_state->data_value_hashes_of_epoch->size(), 2);
+    EXPECT_EQ(new_chain_state->mining_state.num_minings_in_epoch, 2);
+
+    //blocks without creations and transactions share the wallets and hashes
+    addBlock({}, {});
+    EXPECT_EQ(blockchain.getChainState()->wallets, new_chain_state->wallets);
+    EXPECT_EQ(blockchain.getChainState()->data_value_hashes_of_epoch, new_chain_state->data_value_hashes_of_epoch);
+}
+
+TEST_F(TestBlockchain, EpochHashSetMergeAndContains) {
+    std::vector<hash_t> sorted_hashes;
+    std::vector<hash_t> all_hashes;
+    for(uint32_t block=0;block<10;block++) {
+        std::vector<hash_t> batch;
+        for(uint32_t i=0;i<100;i++) {
+            batch.push_back(CryptoHelper::calcHash(std::to_string(block) + "_" + std::to_string(i)));
+        }
+        all_hashes.insert(all_hashes.end(), batch.begin(), batch.end());
+        EpochHashSet::mergeBatch(sorted_hashes, batch);
+        EXPECT_TRUE(std::is_sorted(sorted_hashes.begin(), sorted_hashes.end()));
+    }
+    std::sort(all_hashes.begin(), all_hashes.end());
+    EXPECT_EQ(sorted_hashes, all_hashes);
+
+    EpochHashSet hash_set(sorted_hashes);
+    EXPECT_EQ(hash_set.size(), 1000);
+    for(auto& hash : all_hashes) {
+        EXPECT_TRUE(hash_set.contains(hash));
+    }
+    EXPECT_FALSE(hash_set.contains(CryptoHelper::calcHash("not_inserted")));
+    EXPECT_FALSE(EpochHashSet().contains(0));
+
+    //copies are not affected by later insertions
+    EpochHashSet copied_hash_set(hash_set);
+    hash_set.insert({CryptoHelper::calcHash("inserted")});
+    EXPECT_TRUE(hash_set.contains(CryptoHelper::calcHash("inserted")));
+    EXPECT_EQ(hash_set.size(), 1001);
+    EXPECT_FALSE(copied_hash_set.contains(CryptoHelper::calcHash("inserted")));
+    EXPECT_EQ(copied_hash_set.size(), 1000);
+    for(auto& hash : all_hashes) {
+        EXPECT_TRUE(copied_hash_set.contains(hash));
+    }
+}
+
+TEST_F(TestBlockchain, SealedEpochStoreAppendReopen) {
+    const std::string file_path = "./blockchain/sealed_epochs_test";
+    boost::filesystem::remove(file_path);
+    std::vector<std::vector<hash_t>> epochs(3);
+    for(uint32_t epoch=0;epoch<epochs.size();epoch++) {
+        for(uint32_t i=0;i<100 * (epoch + 1);i++) {
+            epochs[epoch].push_back(CryptoHelper::calcHash(std::to_string(epoch) + "_" + std::to_string(i)));
+        }
+    }
+    {
+        SealedEpochStore store(file_path);
+        EXPECT_EQ(store.numEpochs(), 0);
+        store.appendEpoch(epochs[0]);
+        store.appendEpoch(epochs[1]);
+        EXPECT_EQ(store.numEpochs(), 2);
+        EXPECT_EQ(store.getEpoch(1), epochs[1]);
+        EXPECT_EQ(store.getHashes(0)[99], epochs[0][99]);
+    }
+    {
+        //epochs survive a restart, matching epochs are not written again
+        SealedEpochStore store(file_path);
+        EXPECT_EQ(store.numEpochs(), 2);
+        EXPECT_TRUE(store.verifyEpoch(0));
+        EXPECT_TRUE(store.verifyEpoch(1));
+        auto file_size = boost::filesystem::file_size(file_path);
+        store.assign(epochs, 2);
+        EXPECT_EQ(boost::filesystem::file_size(file_path), file_size);
+        store.assign(epochs, 3);
+        EXPECT_EQ(store.getEpoch(2), epochs[2]);
+
+        //a different epoch replaces everything from there on
+        std::swap(epochs[1], epochs[2]);
+        store.assign(epochs, 2);
+        EXPECT_EQ(store.numEpochs(), 2);
+        EXPECT_EQ(store.getEpoch(0), epochs[0]);
+        EXPECT_EQ(store.getEpoch(1), epochs[1]);
+        store.truncate(1);
+        EXPECT_EQ(store.numEpochs(), 1);
+    }
+    {
+        //a corrupt epoch is not verified when opening, assign replaces it without reading it
+        SealedEpochStore store(file_path);
+        store.appendEpoch(epochs[1]);
+    }
+    {
+        std::fstream fs(file_path, std::fstream::binary | std::fstream::in | std::fstream::out);
+        fs.seekp(-1, std::fstream::end);
+        fs.put('X');
+    }
+    SealedEpochStore store(file_path);
+    EXPECT_EQ(store.numEpochs(), 2);
+    EXPECT_TRUE(store.verifyEpoch(0));
+    EXPECT_FALSE(store.verifyEpoch(1));
+    EXPECT_EQ(store.getEpoch(0), epochs[0]);
+    EXPECT_TRUE(store.assign(epochs, 2));
+    EXPECT_TRUE(store.verifyEpoch(1));
+    EXPECT_EQ(store.getEpoch(1), epochs[1]);
+}
+
+TEST_F(TestBlockchain, SealedEpochStoreWriteFailure) {
+    const std::string file_path = "./blockchain/sealed_epochs_test";
+    boost::filesystem::remove(file_path);
+    std::vector<std::vector<hash_t>> epochs(2);
+    for(uint32_t epoch=0;epoch<epochs.size();epoch++) {
+        for(uint32_t i=0;i<100;i++) {
+            epochs[epoch].push_back(CryptoHelper::calcHash(std::to_string(epoch) + "_" + std::to_string(i)));
+        }
+    }
+    SealedEpochStoreStub store(file_path);
+    EXPECT_TRUE(store.appendEpoch(epochs[0]));
+    auto file_size = boost::filesystem::file_size(file_path);
+
+    //writes behind the current end of the file fail, once in the record header and once in the hashes
+    store.max_file_size_ = file_size;
+    bool append_ok = store.appendEpoch(epochs[1]);
+    store.max_file_size_ = file_size + 64 + 100;
+    bool assign_ok = store.assign(epochs, 2);
+    store.max_file_size_ = std::numeric_limits<uint64_t>::max();
+
+    EXPECT_FALSE(append_ok);
+    EXPECT_FALSE(assign_ok);
+    ASSERT_EQ(store.numEpochs(), 1);
+    EXPECT_EQ(store.getEpoch(0), epochs[0]);
+    EXPECT_EQ(boost::filesystem::file_size(file_path), file_size);
+
+    EXPECT_TRUE(store.appendEpoch(epochs[1]));
+    EXPECT_EQ(store.getEpoch(1), epochs[1]);
+}
+
+TEST_F(TestBlockchain, SealedEpochsInEstablishedBaseline) {
+    auto baseline_block = buildBaselineBlock();
+    baseline_block.data_value_hashes.resize(3);
+    for(uint32_t epoch=0;epoch<2;epoch++) {
+        baseline_block.data_value_hashes[epoch].clear();
+        for(uint32_t i=0;i<CollectionBlock::max_num_creations;i++) {
+            baseline_block.data_value_hashes[epoch].push_back(CryptoHelper::calcHash(std::to_string(epoch) + "_" + std::to_string(i)));
+        }
+        std::sort(baseline_block.data_value_hashes[epoch].begin(), baseline_block.data_value_hashes[epoch].end());
+    }
+    baseline_block.data_value_hashes[2].push_back(1);
+    baseline_block.mining_state.epoch = 2;
+    baseline_block.header.generic_header.block_hash = 0;
+    CryptoHelper::fillHash(baseline_block);
+    blockchain.setRootBlock(baseline_block);
+    auto expected_block = baseline_block;
+
+    blockchain.establishBaseline();
+    auto established_block = std::static_pointer_cast<BaselineBlock>(blockchain.getRootBlock());
+    EXPECT_EQ(established_block->data_value_hashes, expected_block.data_value_hashes);
+    EXPECT_EQ(established_block->header.generic_header.block_hash, expected_block.header.generic_header.block_hash);
+}
+
+TEST_F(TestBlockchain, BlockStoreAppendReadReopen) {
+    const std::string folder_path = "./blockchain/block_store_test";
+    boost::filesystem::remove_all(folder_path);
+    boost::filesystem::create_directories(folder_path);
+    {
+        BlockStore store(folder_path);
+        EXPECT_EQ(store.read(1), nullptr);
+        for(block_uid_t uid=1;uid<=100;uid++) {
+            store.append(uid, "block_" + std::to_string(uid));
+        }
+        store.append(50, "block_50_replaced");
+        EXPECT_EQ(*store.read(1), "block_1");
+        EXPECT_EQ(*store.read(50), "block_50_replaced");
+        EXPECT_EQ(store.numBlocks(), 100);
+        EXPECT_EQ(store.numSegments(), 1);
+    }
+    {
+        //append an incomplete record (as if writing was interrupted)
+        std::ofstream ofs(folder_path + "/1.seg", std::ofstream::binary | std::ofstream::app);
+        ofs << "incomplete";
+    }
+    auto file_size = boost::filesystem::file_size(folder_path + "/1.seg");
+    {
+        //a read-only store skips the incomplete record but leaves the file alone
+        BlockStore read_only_store(folder_path, true);
+        EXPECT_EQ(read_only_store.numBlocks(), 100);
+        EXPECT_EQ(*read_only_store.read(50), "block_50_replaced");
+        read_only_store.append(101, "block_101");
+        EXPECT_FALSE(read_only_store.append({{102, "block_102"}}));
+        read_only_store.clear();
+        EXPECT_FALSE(read_only_store.contains(101));
+        EXPECT_EQ(read_only_store.numBlocks(), 100);
+        EXPECT_EQ(boost::filesystem::file_size(folder_path + "/1.seg"), file_size);
+    }
+    BlockStore store(folder_path);
+    EXPECT_LT(boost::filesystem::file_size(folder_path + "/1.seg"), file_size);
+    EXPECT_EQ(store.numBlocks(), 100);
+    EXPECT_EQ(*store.read(100), "block_100");
+    EXPECT_EQ(*store.read(50), "block_50_replaced");
+    store.append(101, "block_101");
+    EXPECT_EQ(*store.read(101), "block_101");
+
+    //segment files are removed with the last reader
+    store.clear();
+    EXPECT_EQ(store.read(1), nullptr);
+    EXPECT_EQ(store.numSegments(), 0);
+    EXPECT_FALSE(boost::filesystem::exists(folder_path + "/1.seg"));
+    store.append(5, "block_5");
+    EXPECT_EQ(*store.read(5), "block_5");
+    EXPECT_EQ(BlockStore(folder_path).numBlocks(), 1);
+}
+
+TEST_F(TestBlockchain, ExternalBlockFromDisk) {
+    auto block = buildCollectionBlock({valid_data_values_epoch_0[1]}, {});
+    boost::filesystem::remove_all("./blockchain/external_block_store_test");
+    EXPECT_EQ(Cache::getExternalBlockFromDisk("./blockchain/external_block_store_test",
+                                              BlockStore("./blockchain/external_block_store_test", true), block.header.block_uid), nullptr);
+    EXPECT_FALSE(boost::filesystem::exists("./blockchain/external_block_store_test"));
+
+    //folders with one file per block can still be imported
+    boost::filesystem::create_directories("./blockchain/external_block_store_test");
+    {
+        std::ofstream ofs("./blockchain/external_block_store_test/" + std::to_string(block.header.block_uid) + ".blk", std::ofstream::binary);
+        cereal::PortableBinaryOutputArchive oa(ofs);
+        oa << (uint8_t)block.header.generic_header.block_type;
+        oa << block;
+    }
+    BlockStore store("./blockchain/external_block_store_test", true);
+    auto read_block = std::static_pointer_cast<CollectionBlock>(Cache::getExternalBlockFromDisk("./blockchain/external_block_store_test", store, block.header.block_uid));
+    ASSERT_NE(read_block, nullptr);
+    EXPECT_EQ(read_block->header.generic_header.block_hash, block.header.generic_header.block_hash);
+    EXPECT_EQ(read_block->creations.size(), 1);
+}
+
+TEST_F(TestBlockchain, CacheBudgetAndHotBlocks) {
+    const std::string folder_path = "./blockchain/cache_test";
+    boost::filesystem::remove_all(folder_path);
+    auto fill_cache = [](Cache& cache) {
+        BaselineBlock baseline_block;
+        baseline_block.header.block_uid = 1;
+        baseline_block.header.generic_header.block_type = BlockType::BaselineBlock;
+        cache.resetCache(1);
+        cache.addBlock(baseline_block);
+        for(block_uid_t uid=2;uid<=40;uid++) {
+            CollectionBlock collection_block;
+            collection_block.header.block_uid = uid;
+            cache.addBlock(collection_block);
+        }
+        cache.flush();
+    };
+
+    {
+        //budget too small for any block: blocks are only kept until they are written
+        Cache cache(folder_path, 1);
+        fill_cache(cache);
+        EXPECT_EQ(cache.numDirtyBlocks(), 0);
+        EXPECT_EQ(cache.numCachedBlocks(), 0);
+        EXPECT_EQ(cache.getBlock(1)->header.block_uid, 1);
+        EXPECT_EQ(cache.getBlock(40)->header.block_uid, 40);
+        EXPECT_EQ(cache.getBlock(41), nullptr);
+        EXPECT_EQ(cache.numHits(), 0);
+        EXPECT_EQ(cache.numMisses(), 3);
+        EXPECT_EQ(cache.numCachedBlocks(), 0);
+        EXPECT_EQ(cache.memoryUsage(), 0);
+    }
+
+    uint64_t block_size;
+    {
+        Cache cache(folder_path);
+        fill_cache(cache);
+        EXPECT_EQ(cache.numCachedBlocks(), 40);
+        EXPECT_GT(cache.memoryUsage(), 0);
+        EXPECT_EQ(cache.getBlock(5)->header.block_uid, 5);
+        EXPECT_EQ(cache.getBlock(5)->header.block_uid, 5);
+        EXPECT_EQ(cache.numHits(), 2);
+        EXPECT_EQ(cache.numEvictions(), 0);
+        EXPECT_DOUBLE_EQ(cache.hitRate(), 1.0);
+        block_size = cache.memoryUsage() / 40;
+    }
+
+    //blocks evicted from a cache are read back from its store (the newest blocks alone exceed this budget)
+    Cache cache(folder_path, 5 * block_size);
+    fill_cache(cache);
+    auto first_uncached = cache.numMisses();
+    for(block_uid_t uid=2;uid<=40;uid++) {
+        ASSERT_NE(cache.getBlock(uid), nullptr);
+        EXPECT_EQ(cache.getBlock(uid)->header.block_uid, uid);
+    }
+    EXPECT_EQ(cache.numMisses() - first_uncached, 2 * (39 - Cache::num_hot_newest_blocks));
+    EXPECT_GT(cache.numEvictions(), 0);
+}
+
+TEST_F(TestBlockchain, CacheLargeBaseline) {
+    const std::string folder_path = "./blockchain/cache_test";
+    boost::filesystem::remove_all(folder_path);
+    auto fill_cache = [](Cache& cache, const BaselineBlock& baseline_block) {
+        cache.resetCache(1);
+        cache.addBlock(baseline_block);
+        for(block_uid_t uid=2;uid<=40;uid++) {
+            CollectionBlock collection_block;
+            collection_block.header.block_uid = uid;
+            cache.addBlock(collection_block);
+        }
+        cache.flush();
+    };
+
+    BaselineBlock baseline_block;
+    baseline_block.header.block_uid = 1;
+    baseline_block.header.generic_header.block_type = BlockType::BaselineBlock;
+    uint64_t collection_blocks_size;
+    {
+        Cache cache(folder_path);
+        fill_cache(cache, baseline_block);
+        collection_blocks_size = cache.memoryUsage();
+    }
+    baseline_block.data_value_hashes.resize(4);
+    for(uint32_t epoch=0;epoch<baseline_block.data_value_hashes.size();epoch++) {
+        for(uint32_t i=0;i<CollectionBlock::max_num_creations;i++) {
+            baseline_block.data_value_hashes[epoch].push_back(CryptoHelper::calcHash(std::to_string(epoch) + "_" + std::to_string(i)));
+        }
+    }
+
+    //the baseline is larger than the whole budget, it must not displace the collection blocks
+    Cache cache(folder_path, 2 * collection_blocks_size);
+    fill_cache(cache, baseline_block);
+    EXPECT_EQ(cache.numDirtyBlocks(), 0);
+    EXPECT_EQ(cache.numCachedBlocks(), 39);
+    EXPECT_EQ(cache.numEvictions(), 0);
+    EXPECT_LE(cache.memoryUsage(), 2 * collection_blocks_size);
+    for(block_uid_t uid=2;uid<=40;uid++) {
+        EXPECT_EQ(cache.getBlock(uid)->header.block_uid, uid);
+    }
+    EXPECT_EQ(cache.numMisses(), 0);
+
+    //it is read from the store on every request
+    for(int i=0;i<2;i++) {
+        auto read_baseline_block = std::static_pointer_cast<BaselineBlock>(cache.getBlock(1));
+        ASSERT_NE(read_baseline_block, nullptr);
+        EXPECT_EQ(read_baseline_block->data_value_hashes, baseline_block.data_value_hashes);
+    }
+    EXPECT_EQ(cache.numMisses(), 2);
+    EXPECT_EQ(cache.numCachedBlocks(), 39);
+    EXPECT_EQ(cache.numEvictions(), 0);
+}
+
+TEST_F(TestBlockchain, CacheEncodedBlockSizeLimit) {
+    const std::string folder_path = "./blockchain/cache_test";
+    boost::filesystem::remove_all(folder_path);
+    uint32_t num_encodings = 0;
+    auto encoder = [&num_encodings](size_t encoded_size) {
+        return [&num_encodings, encoded_size](const BaseBlock&) {
+            num_encodings++;
+            return std::string(encoded_size, 'x');
+        };
+    };
+
+    Cache cache(folder_path, 4000);
+    ASSERT_EQ(cache.maxCachedBlockSize(), 1000);
+    cache.resetCache(1);
+    for(block_uid_t uid=1;uid<=20;uid++) {
+        CollectionBlock collection_block;
+        collection_block.header.block_uid = uid;
+        cache.addBlock(collection_block);
+    }
+    cache.flush();
+    ASSERT_EQ(cache.numCachedBlocks(), 20);
+    ASSERT_LT(cache.memoryUsage() / 20, 500);
+
+    //a small encoded form is kept with the block
+    auto memory_usage = cache.memoryUsage();
+    EXPECT_EQ(cache.getEncodedBlock(15, encoder(10))->size(), 10);
+    EXPECT_EQ(cache.getEncodedBlock(15, encoder(10))->size(), 10);
+    EXPECT_EQ(num_encodings, 1);
+    EXPECT_EQ(cache.numEncodedBlockHits(), 1);
+    EXPECT_EQ(cache.memoryUsage(), memory_usage + 10);
+
+    //block and encoded form together are too large: the block is kept, the encoded form is not
+    memory_usage = cache.memoryUsage();
+    EXPECT_EQ(cache.getEncodedBlock(16, encoder(1000))->size(), 1000);
+    EXPECT_EQ(cache.getEncodedBlock(16, encoder(1000))->size(), 1000);
+    EXPECT_EQ(num_encodings, 3);
+    EXPECT_EQ(cache.numEncodedBlockHits(), 1);
+    EXPECT_EQ(cache.memoryUsage(), memory_usage);
+    EXPECT_EQ(cache.numCachedBlocks(), 20);
+
+    //a large encoded form of a new block is dropped once the block is written
+    CollectionBlock collection_block;
+    collection_block.header.block_uid = 21;
+    cache.addBlock(collection_block);
+    EXPECT_EQ(cache.getEncodedBlock(21, encoder(1000))->size(), 1000);
+    cache.flush();
+    EXPECT_LT(cache.memoryUsage(), memory_usage + 500);
+    EXPECT_EQ(cache.getEncodedBlock(21, encoder(1000))->size(), 1000);
+    EXPECT_EQ(num_encodings, 5);
+    EXPECT_EQ(cache.numCachedBlocks(), 21);
+}
+
+TEST_F(TestBlockchain, CacheReadAhead) {
+    const std::string folder_path = "./blockchain/cache_test";
+    boost::filesystem::remove_all(folder_path);
+    auto fill_cache = [](Cache& cache, block_uid_t num_blocks) {
+        cache.resetCache(1);
+        for(block_uid_t uid=1;uid<=num_blocks;uid++) {
+            CollectionBlock collection_block;
+            collection_block.header.block_uid = uid;
+            cache.addBlock(collection_block);
+        }
+        cache.flush();
+    };
+
+    uint64_t block_size;
+    {
+        Cache cache(folder_path);
+        fill_cache(cache, 10);
+        block_size = cache.memoryUsage() / 10;
+    }
+
+    //the oldest blocks do not fit into the budget anymore
+    Cache cache(folder_path, 100 * block_size);
+    fill_cache(cache, 300);
+    ASSERT_LT(cache.numCachedBlocks(), 150);
+
+    //random access does not trigger read-ahead
+    cache.getBlock(150);
+    cache.getBlock(120);
+    cache.getBlock(170);
+    EXPECT_EQ(cache.numPendingReadAheadBlocks(), 0);
+    EXPECT_EQ(cache.numReadAheadBlocks(), 0);
+    EXPECT_EQ(cache.numMisses(), 3);
+
+    //a sequential stream is read ahead
+    for(block_uid_t uid=2;uid<=4;uid++) {
+        EXPECT_EQ(cache.getBlock(uid)->header.block_uid, uid);
+    }
+    EXPECT_TRUE(waitFor([&cache]() { return cache.numPendingReadAheadBlocks() == 0; }));
+    EXPECT_GT(cache.numReadAheadBlocks(), 0);
+    auto num_misses = cache.numMisses();
+    for(block_uid_t uid=5;uid<=60;uid++) {
+        EXPECT_EQ(cache.getBlock(uid)->header.block_uid, uid);
+        if(uid % 16 == 0) {
+            EXPECT_TRUE(waitFor([&cache]() { return cache.numPendingReadAheadBlocks() == 0; }));
+        }
+    }
+    EXPECT_EQ(cache.numMisses(), num_misses);
+}
+
+TEST_F(TestBlockchain, CacheResetPrunesStoredBlocks) {
+    const std::string folder_path = "./blockchain/cache_test";
+    boost::filesystem::remove_all(folder_path);
+    boost::filesystem::create_directories(folder_path);
+    for(auto file_name : {"5.blk", "700000.blk", "meta_data"}) {
+        std::ofstream ofs(folder_path + "/" + file_name);
+        ofs << "x";
+    }
+
+    //block files of the previous storage format are removed, other files are kept
+    Cache cache(folder_path, 1);
+    EXPECT_FALSE(boost::filesystem::exists(folder_path + "/5.blk"));
+    EXPECT_FALSE(boost::filesystem::exists(folder_path + "/700000.blk"));
+    EXPECT_TRUE(boost::filesystem::exists(folder_path + "/meta_data"));
+
+    cache.resetCache(1);
+    for(block_uid_t uid=1;uid<=100;uid++) {
+        CollectionBlock collection_block;
+        collection_block.header.block_uid = uid;
+        cache.addBlock(collection_block);
+    }
+    cache.flush();
+    ASSERT_NE(cache.getBlock(2), nullptr);
+    EXPECT_TRUE(boost::filesystem::exists(folder_path + "/1.seg"));
+
+    //a new root far ahead does not cost anything per uid in between
+    cache.resetCache(1000000);
+    EXPECT_EQ(cache.numCachedBlocks(), 0);
+    EXPECT_EQ(cache.getBlock(2), nullptr);
+    EXPECT_FALSE(boost::filesystem::exists(folder_path + "/1.seg"));
+    CollectionBlock collection_block;
+    collection_block.header.block_uid = 1000000;
+    EXPECT_EQ(cache.addBlock(collection_block), 1000000);
+    EXPECT_EQ(cache.getBlock(1000000)->header.block_uid, 1000000);
+}
@@ -20,6 +20,7 @@
 #include "scn/Blockchain/Blockchain.h"
 #include "scn/Miner/MinerLocal.h"
 #include "scn/BlockchainManager/BlockchainManager.h"
+#include "TestUtils.h"
 #include <gtest/gtest.h>
 
 using namespace scn;
@@ -83,20 +84,30 @@ protected:
     std::unique_ptr<CryptoHelper> crypto_;
     std::unique_ptr<BlockchainManager> blockchain_manager_;
 
+    //lets the time go on and waits until the blockchain manager handled it: the first idle cycle after the change
+    //may have checked the time before, the second one comes after all state changes caused by the new time
+    void letTheTimeGoOn(uint32_t duration_ms) {
+        sync_timer_stub_->letTheTimeGoOn(duration_ms);
+        auto num_idle_cycles = blockchain_manager_->numIdleCycles();
+        EXPECT_TRUE(waitFor([&]() { return blockchain_manager_->numIdleCycles() >= num_idle_cycles + 2; }));
+    }
+
 
     void CheckBlockAcceptance(uint32_t check_time_in_cycle, bool accept, uint32_t sending_peers) {
         ASSERT_LE(sending_peers, 10);
         //wait one complete cycle (settling)
-        sync_timer_stub_->letTheTimeGoOn(60000);
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        sync_timer_stub_->letTheTimeGoOn(60000);
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        letTheTimeGoOn(60000);
+        letTheTimeGoOn(60000);
 
         //proceed to the first half of introduce block phase
-        sync_timer_stub_->letTheTimeGoOn(30000);
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        sync_timer_stub_->letTheTimeGoOn(check_time_in_cycle);
-        std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+        letTheTimeGoOn(30000);
+        auto num_propagations = p2p_connector_stub_->propagate_collection_block_counter_;
+        letTheTimeGoOn(check_time_in_cycle);
+        //the peers necessary for granting depend on the number of propagations, which catch up one per cycle
+        EXPECT_TRUE(waitFor([&]() {
+            return p2p_connector_stub_->propagate_collection_block_counter_ >=
+                   num_propagations + check_time_in_cycle / CycleStateIntroduceBlock::time_between_propagations_ms_;
+        }));
 
         //send a valid block containing a creation to blockchain manager
         auto previous_block = blockchain_->getNewestBlock();
@@ -116,8 +127,7 @@ protected:
         }
 
         //wait some time to let blockchain manager merge the creation
-        sync_timer_stub_->letTheTimeGoOn(6000);
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        letTheTimeGoOn(6000);
 
         //check if blockchain manager merged the creation
         if(accept) {
@@ -149,6 +159,20 @@ TEST_F(TestBlockchainManager, isBaselineMethod) {
     EXPECT_EQ(BlockchainManager::isBaselineBlock(24482), false);
 }
 
+TEST_F(TestBlockchainManager, numRemainingCreationsMethod) {
+    const uint32_t max_num_creations = CollectionBlock::max_num_creations;
+    MiningState mining_state;
+    EXPECT_EQ(BlockchainManager::numRemainingCreations(mining_state), max_num_creations);
+    EXPECT_EQ(BlockchainManager::numRemainingCreations(mining_state, 3), max_num_creations - 3);
+    mining_state.num_minings_in_epoch = static_cast<int32_t>(max_num_creations) - 1;
+    EXPECT_EQ(BlockchainManager::numRemainingCreations(mining_state), 1);
+    EXPECT_EQ(BlockchainManager::numRemainingCreations(mining_state, 1), 0);
+    EXPECT_EQ(BlockchainManager::numRemainingCreations(mining_state, 5), 0);
+    mining_state.num_minings_in_epoch = static_cast<int32_t>(max_num_creations) + 7;
+    EXPECT_EQ(BlockchainManager::numRemainingCreations(mining_state), 0);
+}
+
+
 TEST_F(TestBlockchainManager, getNextBaselineBlockMethod) {
     EXPECT_EQ(BlockchainManager::getNextBaselineBlock(1), 721);
     EXPECT_EQ(BlockchainManager::getNextBaselineBlock(2), 721);
@@ -183,7 +207,8 @@ TEST_F(TestBlockchainManager, InitialUnsynchronized) {
     init(false);
     EXPECT_EQ(blockchain_manager_->percentBlockchainSynchronized(), 0);
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    //no peers, the blockchain manager keeps fetching
+    EXPECT_TRUE(waitFor([this]() { return blockchain_manager_->numIdleCycles() >= 5; }));
 
     EXPECT_EQ(blockchain_manager_->percentBlockchainSynchronized(), 0);
     EXPECT_EQ(blockchain_manager_->getCurrentState(), ICycleState::State::FetchBlockchain);
@@ -217,8 +242,7 @@ TEST_F(TestBlockchainManager, Synchronization) {
 
     //let some time go by (3/4 cycle)
     for (auto i = 0; i < 6; i++) {
-        sync_timer_stub_->letTheTimeGoOn(15000);
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        letTheTimeGoOn(15000);
     }
 
     ASSERT_EQ(remote_blockchain->getRootBlockId(), blockchain_->getRootBlockId());
@@ -259,8 +283,7 @@ TEST_F(TestBlockchainManager, SynchronizationLong) {
 
     //let some time go by (3/4 cycle)
     for (auto i = 0; i < 6; i++) {
-        sync_timer_stub_->letTheTimeGoOn(15000);
-        std::this_thread::sleep_for(std::chrono::milliseconds(500));
+        letTheTimeGoOn(15000);
     }
 
     ASSERT_EQ(remote_blockchain->getRootBlockId(), blockchain_->getRootBlockId());
@@ -276,47 +299,56 @@ TEST_F(TestBlockchainManager, SynchronizationLong) {
 TEST_F(TestBlockchainManager, CycleStateChanges) {
     init(true);
     //wait one complete cycle (settling)
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(60000);
+    letTheTimeGoOn(60000);
 
     EXPECT_EQ(blockchain_manager_->getCurrentState(), ICycleState::State::Collect);
 
-    sync_timer_stub_->letTheTimeGoOn(30000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(30000);
 
     EXPECT_EQ(blockchain_manager_->getCurrentState(), ICycleState::State::IntroduceBlock);
 
-    sync_timer_stub_->letTheTimeGoOn(30000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(30000);
 
     EXPECT_EQ(blockchain_manager_->getCurrentState(), ICycleState::State::IntroduceBlock);
 
-    sync_timer_stub_->letTheTimeGoOn(30000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(30000);
 
     EXPECT_EQ(blockchain_manager_->getCurrentState(), ICycleState::State::IntroduceBlock);
 
-    sync_timer_stub_->letTheTimeGoOn(30000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(30000);
 
     EXPECT_EQ(blockchain_manager_->getCurrentState(), ICycleState::State::Collect);
 }
 
+TEST_F(TestBlockchainManager, ConsensusPhaseStats) {
+    init(true);
+    //one complete cycle and the beginning of the next, the miner is only throttled during the state changes
+    for(uint32_t i=0;i<6;i++) {
+        letTheTimeGoOn(30000);
+        EXPECT_FALSE(miner_->isInConsensusPhase());
+    }
+
+    auto stats = blockchain_manager_->getConsensusPhaseStats();
+    ASSERT_EQ(stats.count(BlockchainManager::ConsensusPhase::IntroduceBlockStart), 1);
+    ASSERT_EQ(stats.count(BlockchainManager::ConsensusPhase::IntroduceBlockEnd), 1);
+    EXPECT_GE(stats[BlockchainManager::ConsensusPhase::IntroduceBlockStart].num_phases, 1);
+    EXPECT_GE(stats[BlockchainManager::ConsensusPhase::IntroduceBlockEnd].num_phases, 1);
+    auto& end_stats = stats[BlockchainManager::ConsensusPhase::IntroduceBlockEnd];
+    EXPECT_GE(end_stats.max_duration_us, end_stats.last_duration_us);
+    EXPECT_GE(end_stats.total_duration_us, end_stats.max_duration_us);
+}
+
 TEST_F(TestBlockchainManager, MergeBlocks) {
     init(true);
     //wait one complete cycle (settling)
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(60000);
+    letTheTimeGoOn(60000);
 
     p2p_connector_stub_->propagate_collection_block_counter_ = 0;
 
     //proceed from collect phase to introduce block phase
-    sync_timer_stub_->letTheTimeGoOn(30000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(30000);
 
     //check if initial block has been sent by blockchain manager
     EXPECT_EQ(p2p_connector_stub_->propagate_collection_block_counter_, 1);
@@ -336,10 +368,12 @@ TEST_F(TestBlockchainManager, MergeBlocks) {
     collection_block->creations[creation_sub_block.header.generic_header.block_hash] = creation_sub_block;
     CryptoHelper::fillHash(*collection_block);
     p2p_connector_stub_->callback_collection_((*peer_stubs_)[0].getId(), collection_block, false);
+    //the received block is validated with a throttled miner
+    EXPECT_EQ(blockchain_manager_->getConsensusPhaseStats()[BlockchainManager::ConsensusPhase::ValidateBlock].num_phases, 1);
+    EXPECT_FALSE(miner_->isInConsensusPhase());
 
     //wait some time to let blockchain manager merge the creation
-    sync_timer_stub_->letTheTimeGoOn(6000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(6000);
 
     //check if blockchain manager merged the creation
     EXPECT_EQ(p2p_connector_stub_->propagate_collection_block_counter_, 2);
@@ -350,16 +384,13 @@ TEST_F(TestBlockchainManager, MergeBlocks) {
 TEST_F(TestBlockchainManager, MergeBlocksDuplicate) {
     init(true);
     //wait one complete cycle (settling)
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(60000);
+    letTheTimeGoOn(60000);
 
     p2p_connector_stub_->propagate_collection_block_counter_ = 0;
 
     //proceed from collect phase to introduce block phase
-    sync_timer_stub_->letTheTimeGoOn(30000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(30000);
 
     //check if initial block has been sent by blockchain manager
     EXPECT_EQ(p2p_connector_stub_->propagate_collection_block_counter_, 1);
@@ -391,8 +422,7 @@ TEST_F(TestBlockchainManager, MergeBlocksDuplicate) {
     p2p_connector_stub_->callback_collection_((*peer_stubs_)[0].getId(), collection_block, false);
 
     //wait some time to let blockchain manager merge the creation
-    sync_timer_stub_->letTheTimeGoOn(6000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(6000);
 
     //check if blockchain manager merged the creation twice
     EXPECT_EQ(p2p_connector_stub_->propagate_collection_block_counter_, 2);
@@ -402,16 +432,13 @@ TEST_F(TestBlockchainManager, MergeBlocksDuplicate) {
 TEST_F(TestBlockchainManager, MergeBlocksDuplicate2) {
     init(true);
     //wait one complete cycle (settling)
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(60000);
+    letTheTimeGoOn(60000);
 
     p2p_connector_stub_->propagate_collection_block_counter_ = 0;
 
     //proceed from collect phase to introduce block phase
-    sync_timer_stub_->letTheTimeGoOn(30000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(30000);
 
     //check if initial block has been sent by blockchain manager
     EXPECT_EQ(p2p_connector_stub_->propagate_collection_block_counter_, 1);
@@ -433,8 +460,7 @@ TEST_F(TestBlockchainManager, MergeBlocksDuplicate2) {
     CryptoHelper::fillHash(*collection_block);
     p2p_connector_stub_->callback_collection_((*peer_stubs_)[0].getId(), collection_block, false);
 
-    sync_timer_stub_->letTheTimeGoOn(4000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(4000);
 
     //send a valid block containing the same creation but a different hash to blockchain manager
     collection_block->creations.clear();
@@ -454,8 +480,7 @@ TEST_F(TestBlockchainManager, MergeBlocksDuplicate2) {
     p2p_connector_stub_->callback_collection_((*peer_stubs_)[0].getId(), collection_block, false);
 
     //wait some time to let blockchain manager merge the creation
-    sync_timer_stub_->letTheTimeGoOn(6000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(6000);
 
     //check if blockchain manager merged the creation only once
     EXPECT_EQ(p2p_connector_stub_->propagate_collection_block_counter_, 3);
@@ -498,18 +523,14 @@ TEST_F(TestBlockchainManager, AcceptLateBlockMultiplePeers2) {
 TEST_F(TestBlockchainManager, OutOfSyncDetectionGoodWeather) {
     init(true);
     //wait one complete cycle (settling)
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(60000);
+    letTheTimeGoOn(60000);
 
     EXPECT_EQ(blockchain_manager_->getCurrentState(), ICycleState::State::Collect);
 
     //wait one complete cycle
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(60000);
+    letTheTimeGoOn(60000);
 
     EXPECT_EQ(blockchain_manager_->getCurrentState(), ICycleState::State::Collect);
 }
@@ -517,20 +538,16 @@ TEST_F(TestBlockchainManager, OutOfSyncDetectionGoodWeather) {
 TEST_F(TestBlockchainManager, OutOfSyncDetectionBadWeather1) {
     init(true);
     //wait one complete cycle (settling)
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(60000);
+    letTheTimeGoOn(60000);
 
     EXPECT_EQ(blockchain_manager_->getCurrentState(), ICycleState::State::Collect);
 
     sync_timer_stub_->letTheTimeGoOn(120000); //fast forward some cycles
 
     //wait one complete cycle
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(60000);
+    letTheTimeGoOn(60000);
 
     EXPECT_EQ(blockchain_manager_->getCurrentState(), ICycleState::State::FetchBlockchain);
 }
@@ -538,46 +555,65 @@ TEST_F(TestBlockchainManager, OutOfSyncDetectionBadWeather1) {
 TEST_F(TestBlockchainManager, TriggerCreation) {
     init(true);
     //wait one complete cycle (settling)
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(60000);
+    letTheTimeGoOn(60000);
 
     blockchain_manager_->foundHashCallback(0, valid_data_values_epoch_0[0]);
 
-    sync_timer_stub_->letTheTimeGoOn(10000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(10000);
 
     //wait one complete cycle
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(60000);
+    letTheTimeGoOn(60000);
 
     //check if data_value entered the blockchain
     ASSERT_EQ(p2p_connector_stub_->last_collection_block_.creations.size(), 1);
     EXPECT_EQ(p2p_connector_stub_->last_collection_block_.creations.begin()->second.data_value, valid_data_values_epoch_0[0]);
 }
 
+TEST_F(TestBlockchainManager, TriggerCreationBatch) {
+    init(true);
+    //wait one complete cycle (settling)
+    letTheTimeGoOn(60000);
+    letTheTimeGoOn(60000);
+
+    //duplicates and invalid values are handled in the same batch
+    for(uint32_t i=0;i<2;i++) {
+        for(auto& data_value : valid_data_values_epoch_0) {
+            blockchain_manager_->foundHashCallback(0, data_value);
+        }
+    }
+    blockchain_manager_->foundHashCallback(0, valid_data_values_epoch_0[0] + "F");
+
+    letTheTimeGoOn(10000);
+
+    //wait one complete cycle
+    letTheTimeGoOn(60000);
+    letTheTimeGoOn(60000);
+
+    //check if all data_values entered the blockchain exactly once
+    std::set<std::string> data_values;
+    for(auto& creation : p2p_connector_stub_->last_collection_block_.creations) {
+        data_values.insert(creation.second.data_value);
+    }
+    EXPECT_EQ(p2p_connector_stub_->last_collection_block_.creations.size(), valid_data_values_epoch_0.size());
+    EXPECT_EQ(data_values, std::set<std::string>(valid_data_values_epoch_0.begin(), valid_data_values_epoch_0.end()));
+}
+
 TEST_F(TestBlockchainManager, TriggerTransactionAndCreation) {
     init(true);
     //wait one complete cycle (settling)
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(60000);
+    letTheTimeGoOn(60000);
 
     blockchain_manager_->foundHashCallback(0, valid_data_values_epoch_0[0]);
     blockchain_manager_->triggerTransaction(other_public_key, 17);
 
-    sync_timer_stub_->letTheTimeGoOn(10000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(10000);
 
     //wait one complete cycle
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-    sync_timer_stub_->letTheTimeGoOn(60000);
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    letTheTimeGoOn(60000);
+    letTheTimeGoOn(60000);
 
     //check if data_value and transaction entered the blockchain
     ASSERT_EQ(p2p_connector_stub_->last_collection_block_.creations.size(), 1);
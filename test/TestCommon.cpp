@@ -15,13 +15,17 @@
  */
 
 #include "scn/Common/BloomFilter.h"
+#include "scn/Common/CpuAffinity.h"
+#include "scn/Common/Serialization/Hash.h"
+#include <cereal/archives/portable_binary.hpp>
 #include <gtest/gtest.h>
 #include <boost/random.hpp>
+#include <thread>
 using namespace boost::random;
 
 using namespace scn;
 
-typedef independent_bits_engine<mt19937, 256, scn::hash_t> generator_hash_type;
+typedef independent_bits_engine<mt19937, 256, boost::multiprecision::uint256_t> generator_hash_type;
 
 class TestCommon : public testing::Test {
 public:
@@ -33,7 +37,7 @@ public:
     }
 
     hash_t getRandomHash() {
-        return random_hash_generator();
+        return hash_t(random_hash_generator());
     }
 
 protected:
@@ -99,6 +103,47 @@ TEST_F(TestCommon, HashHelperFromArray) {
     EXPECT_EQ(hash, 0x123456789ABCDEF);
 }
 
+TEST_F(TestCommon, HashMatchesMultiprecisionType) {
+    std::vector<boost::multiprecision::uint256_t> values = {0, 1, 0xF, 0x10, std::numeric_limits<boost::multiprecision::uint256_t>::max()};
+    for(uint32_t i=0;i<100;i++) {
+        values.push_back(random_hash_generator());
+        values.push_back(values.back() >> (i * 2));
+    }
+    for(auto& value : values) {
+        hash_t hash(value);
+        EXPECT_EQ(hash.toUint256(), value);
+        EXPECT_EQ(hash_helper::toString(hash), value.str(0, std::ios_base::hex | std::ios_base::uppercase));
+
+        //serialized as four 64 bit words, most significant first
+        std::stringstream oss;
+        {
+            cereal::PortableBinaryOutputArchive oa(oss);
+            oa << hash;
+        }
+        std::stringstream expected_oss;
+        {
+            cereal::PortableBinaryOutputArchive oa(expected_oss);
+            for(auto j = 3; j >= 0; j--) {
+                oa << (uint64_t) (value >> (j * 64));
+            }
+        }
+        EXPECT_EQ(oss.str(), expected_oss.str());
+
+        EXPECT_EQ(hash.getMostSignificantBit(), value == 0 ? -1 : static_cast<int32_t>(boost::multiprecision::msb(value)));
+
+        for(auto& other_value : {values[0], values[2], values[5], values[6]}) {
+            hash_t other_hash(other_value);
+            EXPECT_EQ(hash < other_hash, value < other_value);
+            EXPECT_EQ(hash == other_hash, value == other_value);
+            EXPECT_EQ(hash > other_hash, value > other_value);
+        }
+    }
+    EXPECT_EQ(hash_t(0xFFFFFFFFFFFFFFFF) + 1, hash_t(0, 0, 1, 0));
+    EXPECT_EQ(hash_t(0, 0, 1, 0) - 1, hash_t(0xFFFFFFFFFFFFFFFF));
+    EXPECT_EQ(hash_t::max() + 1, 0);
+    EXPECT_EQ(hash_t::max().toUint256(), std::numeric_limits<boost::multiprecision::uint256_t>::max());
+}
+
 
 TEST_F(TestCommon, PublicKeyConstruct1) {
     PublicKeyPEM key(example_owner_public_key_string);
@@ -122,6 +167,29 @@ TEST_F(TestCommon, PublicKeyConstruct3) {
     EXPECT_EQ(key.isEmpty(), true);
 }
 
+TEST_F(TestCommon, PublicKeyInterning) {
+    PublicKeyPEM key(example_owner_public_key_string);
+    auto num_interned_keys = PublicKeyPEM::numInternedKeys();
+    {
+        PublicKeyPEM same_key("-----BEGIN PUBLIC KEY-----\n " + example_owner_public_key_string_short + " \n-----END PUBLIC KEY-----");
+        PublicKeyPEM other_key("-----BEGIN PUBLIC KEY-----\nKEY_OF_INTERNING_TEST\n-----END PUBLIC KEY-----");
+        PublicKeyPEM other_key_copy = other_key;
+        EXPECT_EQ(PublicKeyPEM::numInternedKeys(), num_interned_keys + 1);
+        EXPECT_EQ(key.getId(), same_key.getId());
+        EXPECT_EQ(&key.getAsShortString(), &same_key.getAsShortString()); //string exists once
+        EXPECT_NE(key.getId(), other_key.getId());
+        EXPECT_EQ(key, same_key);
+        EXPECT_NE(key, other_key);
+        EXPECT_EQ(other_key < key, other_key.getAsShortString() < key.getAsShortString());
+        EXPECT_FALSE(key < same_key);
+        EXPECT_EQ(std::hash<PublicKeyPEM>()(key), std::hash<PublicKeyPEM>()(same_key));
+        EXPECT_EQ(PublicKeyPEM().getId(), 0);
+        EXPECT_EQ(PublicKeyPEM(""), PublicKeyPEM());
+    }
+    //keys are released with their last handle
+    EXPECT_EQ(PublicKeyPEM::numInternedKeys(), num_interned_keys);
+}
+
 
 TEST_F(TestCommon, BloomFilterInsert) {
     BloomFilter<8192> x;
@@ -182,3 +250,37 @@ TEST_F(TestCommon, BloomFilterMerge) {
     EXPECT_EQ(b.findHash(789), true);
     EXPECT_EQ(b.findHash(159), false);
 }
+
+TEST_F(TestCommon, CpuAffinityParseCoreList) {
+    std::vector<uint32_t> cores;
+    EXPECT_TRUE(CpuAffinity::parseCoreList("0-3,8, 10-11", cores));
+    EXPECT_EQ(cores, std::vector<uint32_t>({0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_TRUE(CpuAffinity::parseCoreList("5,1-2,2", cores));
+    EXPECT_EQ(cores, std::vector<uint32_t>({1, 2, 5}));
+    EXPECT_TRUE(CpuAffinity::parseCoreList("", cores));
+    EXPECT_TRUE(cores.empty());
+    EXPECT_FALSE(CpuAffinity::parseCoreList("3-1", cores));
+    EXPECT_FALSE(CpuAffinity::parseCoreList("1-", cores));
+    EXPECT_FALSE(CpuAffinity::parseCoreList("a", cores));
+    EXPECT_FALSE(CpuAffinity::parseCoreList("1x", cores));
+}
+
+TEST_F(TestCommon, CpuAffinityPinThread) {
+    bool pinned = false;
+    bool isolated = false;
+    std::thread([&]() {
+        pinned = CpuAffinity::pinCurrentThread({0});
+        //without miner cores the thread stays where it is
+        CpuAffinity::isolateFromMinerCores();
+        std::this_thread::yield();
+#ifdef __linux__
+        isolated = (sched_getcpu() == 0);
+#else
+        isolated = pinned;
+#endif
+    }).join();
+#if defined(__linux__) || defined(_WIN32)
+    EXPECT_TRUE(pinned);
+#endif
+    EXPECT_EQ(isolated, pinned);
+}
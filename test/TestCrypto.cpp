@@ -15,6 +15,7 @@
  */
 
 #include "scn/CryptoHelper/CryptoHelper.h"
+#include "scn/CryptoHelper/MultiBufferHash.h"
 #include <gtest/gtest.h>
 
 using namespace scn;
@@ -121,4 +122,261 @@ TEST_F(TestCrypto, IsPublicKeyValid) {
 TEST_F(TestCrypto, IsPrivateKeyValid) {
     EXPECT_TRUE(CryptoHelper::isPrivateKeyValid(example_owner_private_key_));
     EXPECT_FALSE(CryptoHelper::isPrivateKeyValid("ABC"));
-}
\ No newline at end of file
+}
+
+TEST_F(TestCrypto, PublicKeyCacheHitsAndMisses) {
+    PublicKeyCache cache;
+    EXPECT_NE(cache.getKey(example_owner_public_key_), nullptr);
+    EXPECT_NE(cache.getKey(example_owner_public_key_), nullptr);
+    EXPECT_NE(cache.getKey(other_public_key_), nullptr);
+    EXPECT_EQ(cache.getKey(PublicKeyPEM()), nullptr);
+    EXPECT_EQ(cache.getKey(PublicKeyPEM()), nullptr);
+    EXPECT_EQ(cache.numHits(), 2);
+    EXPECT_EQ(cache.numMisses(), 3);
+    EXPECT_EQ(cache.size(), 3);
+}
+
+TEST_F(TestCrypto, PublicKeyCacheBounded) {
+    PublicKeyCache cache(1);
+    EXPECT_NE(cache.getKey(example_owner_public_key_), nullptr);
+    EXPECT_NE(cache.getKey(other_public_key_), nullptr);
+    EXPECT_EQ(cache.size(), 1);
+    EXPECT_NE(cache.getKey(example_owner_public_key_), nullptr);
+    EXPECT_EQ(cache.numHits(), 0);
+    EXPECT_EQ(cache.numMisses(), 3);
+}
+
+TEST_F(TestCrypto, SignatureVerificationRepeated) {
+    auto signature = crypto_.calcSignature("A random text.");
+    auto hits_before = CryptoHelper::getPublicKeyCache().numHits();
+    for(auto i=0;i<10;i++) {
+        EXPECT_TRUE(crypto_.verifySignature("A random text.", signature, example_owner_public_key_));
+        EXPECT_FALSE(crypto_.verifySignature("A random text.", signature, other_public_key_));
+    }
+    EXPECT_GE(CryptoHelper::getPublicKeyCache().numHits() - hits_before, 18);
+}
+
+TEST_F(TestCrypto, HashStreamBufSubstitution) {
+    for(uint32_t buffer_size : {1, 4, 8192}) {
+        HashStreamBuf hash_buf(buffer_size);
+        hash_buf.substituteTrailingBytes(6, "text.");
+        std::ostream hash_stream(&hash_buf);
+        hash_stream << "A";
+        hash_stream.flush();
+        hash_buf.substituteNextBytes(" ra");
+        hash_stream << "XXXndom YYYYYY";
+        hash_stream.flush();
+        EXPECT_EQ(hash_buf.digestHash(), CryptoHelper::calcHash("A random text."));
+    }
+}
+
+TEST_F(TestCrypto, BlockVerificationWithoutCopy) {
+    CreationSubBlock sub_block;
+    sub_block.header.generic_header.previous_block_hash = 12345;
+    sub_block.data_value = "A random text.";
+    sub_block.creator = example_owner_public_key_;
+    crypto_.fillSignature(sub_block);
+    CryptoHelper::fillHash(sub_block);
+    EXPECT_TRUE(CryptoHelper::verifyHash(sub_block));
+    EXPECT_TRUE(CryptoHelper::verifySignature(sub_block, example_owner_public_key_));
+    EXPECT_FALSE(CryptoHelper::verifySignature(sub_block, other_public_key_));
+
+    //same result as verifying the serialized copy with block_hash and signature cleared
+    CreationSubBlock sub_block_copy = sub_block;
+    sub_block_copy.header.generic_header.block_hash = 0;
+    sub_block_copy.signature = "";
+    std::stringstream oss;
+    cereal::PortableBinaryOutputArchive oa(oss);
+    oa << sub_block_copy;
+    EXPECT_TRUE(CryptoHelper::verifySignature(oss.str(), sub_block.signature, example_owner_public_key_));
+
+    sub_block.data_value = "B random text.";
+    EXPECT_FALSE(CryptoHelper::verifyHash(sub_block));
+    EXPECT_FALSE(CryptoHelper::verifySignature(sub_block, example_owner_public_key_));
+}
+
+TEST_F(TestCrypto, MultiBufferHashAllImplementations) {
+    std::vector<std::string> data;
+    for(uint32_t length=0;length<300;length++) {
+        data.emplace_back(length, static_cast<char>('A' + length % 26));
+    }
+    data.emplace_back("A random text.");
+    data.emplace_back(1024, 'x');
+
+    std::vector<hash_t> expected_hashes;
+    for(auto& element : data) {
+        expected_hashes.push_back(CryptoHelper::calcHash(element));
+    }
+
+    auto default_implementation = MultiBufferHash::getImplementation();
+    for(auto implementation : {MultiBufferHash::Implementation::Scalar, MultiBufferHash::Implementation::Avx2, MultiBufferHash::Implementation::Avx512}) {
+        if(!MultiBufferHash::isSupported(implementation)) {
+            std::cout << "Multi buffer hash implementation " << (uint32_t)implementation << " not supported" << std::endl;
+            continue;
+        }
+        MultiBufferHash::setImplementation(implementation);
+        EXPECT_EQ(MultiBufferHash::calcHashes(data), expected_hashes);
+        EXPECT_TRUE(MultiBufferHash::calcHashes(std::vector<std::string>()).empty());
+    }
+    MultiBufferHash::setImplementation(default_implementation);
+}
+
+TEST_F(TestCrypto, MultiBufferHashDefaultImplementation) {
+    //AVX2 lanes only where neither AVX-512 nor SHA-NI (used by the scalar implementation) is available
+    auto expected_implementation = MultiBufferHash::Implementation::Scalar;
+    if(MultiBufferHash::isSupported(MultiBufferHash::Implementation::Avx512)) {
+        expected_implementation = MultiBufferHash::Implementation::Avx512;
+    } else if(!MultiBufferHash::hasShaExtensions() && MultiBufferHash::isSupported(MultiBufferHash::Implementation::Avx2)) {
+        expected_implementation = MultiBufferHash::Implementation::Avx2;
+    }
+    EXPECT_EQ(MultiBufferHash::getImplementation(), expected_implementation);
+}
+
+TEST_F(TestCrypto, MultiBufferHashFromMidstate) {
+    std::vector<std::string> prefixes = {"", "short prefix", std::string(64, 'p'), std::string(200, 'q')};
+    std::vector<std::string> messages;
+    for(uint32_t length=0;length<140;length+=7) {
+        messages.emplace_back(length, static_cast<char>('a' + length % 26));
+    }
+
+    auto default_implementation = MultiBufferHash::getImplementation();
+    for(auto implementation : {MultiBufferHash::Implementation::Scalar, MultiBufferHash::Implementation::Avx2, MultiBufferHash::Implementation::Avx512}) {
+        if(!MultiBufferHash::isSupported(implementation)) {
+            continue;
+        }
+        MultiBufferHash::setImplementation(implementation);
+        auto num_lanes = MultiBufferHash::getNumLanes();
+        for(auto& prefix : prefixes) {
+            auto midstate = MultiBufferHash::calcMidstate(prefix);
+            auto tail = prefix.substr(midstate.num_bytes);
+            for(size_t offset=0;offset<messages.size();offset+=num_lanes) {
+                uint32_t num_messages = std::min(static_cast<size_t>(num_lanes), messages.size() - offset);
+                std::vector<std::string> lane_messages;
+                std::vector<const uint8_t*> lane_pointers;
+                std::vector<uint64_t> lane_lengths;
+                for(uint32_t i=0;i<num_messages;i++) {
+                    lane_messages.push_back(tail + messages[offset + i]);
+                }
+                for(auto& lane_message : lane_messages) {
+                    lane_pointers.push_back(reinterpret_cast<const uint8_t*>(lane_message.data()));
+                    lane_lengths.push_back(lane_message.length());
+                }
+                std::vector<uint8_t> digests(num_messages * 32);
+                MultiBufferHash::calcHashesFromMidstate(midstate, lane_pointers.data(), lane_lengths.data(), num_messages, digests.data());
+                for(uint32_t i=0;i<num_messages;i++) {
+                    EXPECT_EQ(hash_helper::fromArray(&digests[i * 32]), CryptoHelper::calcHash(prefix + messages[offset + i]));
+                }
+            }
+        }
+    }
+    MultiBufferHash::setImplementation(default_implementation);
+}
+
+TEST_F(TestCrypto, MultiBufferHashBenchmark) {
+    std::vector<std::string> data;
+    for(uint32_t i=0;i<100000;i++) {
+        data.push_back("0_MFYwEAYHKoZIzj0CAQYFK4EEAAoDQgAEvdfi1bMgqn03FuVcjwtLMJyfnxinHrvYJzyHUNUzT6IngeP4ijXcHHqTXyfEoqZ5Clz+ZlOSYL1beQTpJ4BDwg==_248833349_" + std::to_string(i));
+    }
+
+    auto default_implementation = MultiBufferHash::getImplementation();
+    for(auto implementation : {MultiBufferHash::Implementation::Scalar, MultiBufferHash::Implementation::Avx2, MultiBufferHash::Implementation::Avx512}) {
+        if(!MultiBufferHash::isSupported(implementation)) {
+            continue;
+        }
+        MultiBufferHash::setImplementation(implementation);
+        auto start = std::chrono::steady_clock::now();
+        auto hashes = MultiBufferHash::calcHashes(data);
+        auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Multi buffer hash implementation " << (uint32_t)implementation << ": " << duration_us << " us for " << data.size() << " hashes" << std::endl;
+        EXPECT_EQ(hashes.size(), data.size());
+    }
+    MultiBufferHash::setImplementation(default_implementation);
+}
+
+TEST_F(TestCrypto, MerkleTreeIncremental) {
+    std::vector<hash_t> leaves;
+    for(uint32_t i=0;i<200;i++) {
+        leaves.push_back(CryptoHelper::calcHash(std::to_string(i)));
+    }
+
+    MerkleTree tree;
+    EXPECT_EQ(tree.getRoot(), 0);
+    for(auto& leaf : leaves) {
+        EXPECT_TRUE(tree.insert(leaf));
+    }
+    EXPECT_FALSE(tree.insert(leaves[17]));
+    EXPECT_EQ(tree.size(), leaves.size());
+
+    //root does not depend on insertion order and matches the one built from the sorted leaves
+    MerkleTree reverse_tree;
+    for(auto it = leaves.rbegin(); it != leaves.rend(); it++) {
+        reverse_tree.insert(*it);
+    }
+    auto sorted_leaves = leaves;
+    std::sort(sorted_leaves.begin(), sorted_leaves.end());
+    EXPECT_EQ(tree.getRoot(), reverse_tree.getRoot());
+    EXPECT_EQ(tree.getRoot(), MerkleTree::calcRoot(sorted_leaves));
+
+    //erasing leaves results in the root of the remaining set
+    EXPECT_TRUE(tree.erase(leaves[17]));
+    EXPECT_FALSE(tree.erase(leaves[17]));
+    EXPECT_FALSE(tree.contains(leaves[17]));
+    sorted_leaves.erase(std::find(sorted_leaves.begin(), sorted_leaves.end(), leaves[17]));
+    EXPECT_EQ(tree.getRoot(), MerkleTree::calcRoot(sorted_leaves));
+    for(auto& leaf : leaves) {
+        tree.erase(leaf);
+    }
+    EXPECT_EQ(tree.size(), 0);
+    EXPECT_EQ(tree.getRoot(), 0);
+}
+
+TEST_F(TestCrypto, MerkleTreeInclusionProof) {
+    MerkleTree tree;
+    for(uint32_t i=0;i<100;i++) {
+        tree.insert(CryptoHelper::calcHash(std::to_string(i)));
+    }
+    MerkleProof proof;
+    auto leaf = CryptoHelper::calcHash("42");
+    ASSERT_TRUE(tree.getProof(leaf, proof));
+    EXPECT_TRUE(MerkleTree::verifyProof(leaf, proof, tree.getRoot()));
+    EXPECT_FALSE(MerkleTree::verifyProof(CryptoHelper::calcHash("43"), proof, tree.getRoot()));
+    EXPECT_FALSE(tree.getProof(CryptoHelper::calcHash("100"), proof));
+}
+
+TEST_F(TestCrypto, CollectionBlockMerkleHashMode) {
+    CollectionBlock block;
+    block.header.block_uid = 5;
+    for(uint32_t i=0;i<10;i++) {
+        TransactionSubBlock transaction;
+        transaction.fraction = i + 1;
+        transaction.pre_owner = example_owner_public_key_;
+        CryptoHelper::fillHash(transaction);
+        block.transactions[transaction.header.generic_header.block_hash] = transaction;
+    }
+
+    CryptoHelper::setCollectionBlockHashMode(CryptoHelper::CollectionBlockHashMode::MerkleRoot);
+    CryptoHelper::fillHash(block);
+    EXPECT_TRUE(CryptoHelper::verifyHash(block));
+
+    MerkleTree transactions_tree;
+    for(auto& transaction : block.transactions) {
+        transactions_tree.insert(transaction.first);
+    }
+    EXPECT_EQ(block.header.generic_header.block_hash,
+              CryptoHelper::calcMerkleBlockHash(block, transactions_tree.getRoot(), 0));
+
+    //keys have to match the sub block hashes
+    auto modified_block = block;
+    modified_block.transactions.begin()->second.header.generic_header.block_hash = CryptoHelper::calcHash("modified");
+    EXPECT_FALSE(CryptoHelper::verifyHash(modified_block));
+
+    modified_block = block;
+    modified_block.header.block_uid++;
+    EXPECT_FALSE(CryptoHelper::verifyHash(modified_block));
+
+    CryptoHelper::setCollectionBlockHashMode(CryptoHelper::CollectionBlockHashMode::Serialized);
+    EXPECT_FALSE(CryptoHelper::verifyHash(block));
+    block.header.generic_header.block_hash = 0;
+    CryptoHelper::fillHash(block);
+    EXPECT_TRUE(CryptoHelper::verifyHash(block));
+}
@@ -15,11 +15,18 @@
  */
 
 #include "scn/Miner/MinerLocal.h"
+#include "scn/Miner/MiningLoop.h"
+#include "scn/Miner/MinerServer.h"
+#include "scn/Miner/MinerClient.h"
+#include "scn/Common/CpuAffinity.h"
+#include "scn/CryptoHelper/CryptoHelper.h"
+#include "scn/Blockchain/Blockchain.h"
+#include "TestUtils.h"
 #include <gtest/gtest.h>
+#include <set>
 
 using namespace scn;
 
-
 class TestMiner : public testing::Test {
 public:
 
@@ -32,6 +39,10 @@ public:
         miner_local->start(12345, example_owner_public_key, 10, std::bind(&TestMiner::foundHashCallback, this, std::placeholders::_1, std::placeholders::_2));
     }
 
+    std::function<void(epoch_t,const std::string&)> foundHashFunction() {
+        return std::bind(&TestMiner::foundHashCallback, this, std::placeholders::_1, std::placeholders::_2);
+    }
+
     void stopMining() {
         if(miner_local) {
             miner_local->stop();
@@ -41,11 +52,43 @@ public:
 protected:
 
     void foundHashCallback(const epoch_t epoch, const std::string& data) {
+        std::lock_guard<std::mutex> lock(mtx_found_hashes_map_access_);
         found_hashes_map_[data] = epoch;
     }
 
+    size_t numFoundHashes() {
+        std::lock_guard<std::mutex> lock(mtx_found_hashes_map_access_);
+        return found_hashes_map_.size();
+    }
+
+    std::set<std::string> foundHashes() {
+        std::lock_guard<std::mutex> lock(mtx_found_hashes_map_access_);
+        std::set<std::string> found_hashes;
+        for(auto& found_hash : found_hashes_map_) {
+            found_hashes.insert(found_hash.first);
+        }
+        return found_hashes;
+    }
+
+    //worker thread which found the data value, taken from the counter range of the data value
+    static uint32_t workerOfFoundHash(const std::string& data_value) {
+        return static_cast<uint32_t>(std::stoull(data_value.substr(data_value.rfind('_') + 1), nullptr, 16) >> MinerLocal::thread_counter_range_bits);
+    }
+
+    //workers which found the data values not contained in known_found_hashes
+    std::set<uint32_t> workersOfNewFoundHashes(const std::set<std::string>& known_found_hashes) {
+        std::set<uint32_t> workers;
+        for(auto& found_hash : foundHashes()) {
+            if(known_found_hashes.count(found_hash) == 0) {
+                workers.insert(workerOfFoundHash(found_hash));
+            }
+        }
+        return workers;
+    }
+
     std::shared_ptr<MinerLocal> miner_local;
 
+    std::mutex mtx_found_hashes_map_access_;
     std::map<std::string, epoch_t> found_hashes_map_;
 
     public_key_t example_owner_public_key = PublicKeyPEM("-----BEGIN PUBLIC KEY-----\n"
@@ -57,25 +100,23 @@ protected:
 
 TEST_F(TestMiner, singleMiningThread) {
     startMining(1);
-    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    EXPECT_TRUE(waitFor([this]() { return numFoundHashes() > 0; }));
     stopMining();
 
-    std::cout << "Number of Minings in 1000ms: " << found_hashes_map_.size() << std::endl;
     EXPECT_GT(found_hashes_map_.size(), 0);
 }
 
 TEST_F(TestMiner, multipleMiningThreads) {
     startMining(4);
-    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+    EXPECT_TRUE(waitFor([this]() { return workersOfNewFoundHashes({}).size() > 1; }));
     stopMining();
 
-    std::cout << "Number of Minings in 1000ms: " << found_hashes_map_.size() << std::endl;
     EXPECT_GT(found_hashes_map_.size(), 0);
 }
 
 TEST_F(TestMiner, checksPerSecond) {
     startMining(1);
-    std::this_thread::sleep_for(std::chrono::milliseconds(2000));
+    EXPECT_TRUE(waitFor([this]() { return miner_local->numChecksPerSecond() > 0; }));
     auto num_checks_per_second = miner_local->numChecksPerSecond();
     stopMining();
 
@@ -89,4 +130,352 @@ TEST_F(TestMiner, changeNumMiningThreads) {
     miner_local->changeNumWorkerThreads(3);
     EXPECT_EQ(miner_local->numWorkerThreads(), 3);
     stopMining();
-}
\ No newline at end of file
+}
+
+TEST_F(TestMiner, changeNumMiningThreadsKeepsMining) {
+    startMining(3);
+    auto generation = miner_local->getGeneration();
+    miner_local->changeNumWorkerThreads(1);
+    EXPECT_TRUE(miner_local->isRunning());
+    EXPECT_EQ(miner_local->getGeneration(), generation);
+    auto num_found_hashes = numFoundHashes();
+    EXPECT_TRUE(waitFor([&]() { return numFoundHashes() > num_found_hashes; }));
+    miner_local->changeNumWorkerThreads(2);
+    EXPECT_EQ(miner_local->numWorkerThreads(), 2);
+    EXPECT_EQ(miner_local->getGeneration(), generation);
+    stopMining();
+
+    //changing the number of threads of a stopped miner does not start it
+    miner_local->changeNumWorkerThreads(4);
+    EXPECT_FALSE(miner_local->isRunning());
+}
+
+TEST_F(TestMiner, deterministicThreadPartitioning) {
+    //pinned to the first core - the partitioning must not depend on the scheduling
+    CpuAffinity::setMinerCores({0});
+    miner_local = std::make_shared<MinerLocal>(2);
+    miner_local->setHostId(777);
+    EXPECT_EQ(miner_local->getHostId(), 777);
+    miner_local->start(12345, example_owner_public_key, 10, foundHashFunction());
+    EXPECT_TRUE(waitFor([this]() { return workersOfNewFoundHashes({}).size() == 2; }));
+    stopMining();
+    CpuAffinity::setMinerCores({});
+
+    const std::string expected_prefix = "3039_" + example_owner_public_key.getAsShortString() + "_777_";
+    std::set<uint64_t> counter_ranges;
+    for(auto& found_hash : found_hashes_map_) {
+        ASSERT_EQ(found_hash.first.compare(0, expected_prefix.length(), expected_prefix), 0);
+        //work nonce, then the counter
+        auto counter_position = found_hash.first.find('_', expected_prefix.length()) + 1;
+        uint64_t counter_value = std::stoull(found_hash.first.substr(counter_position), nullptr, 16);
+        counter_ranges.insert(counter_value >> MinerLocal::thread_counter_range_bits);
+    }
+    EXPECT_EQ(counter_ranges, std::set<uint64_t>({0, 1}));
+}
+
+TEST_F(TestMiner, restartOnSameEpochMinesNewValues) {
+    //a restart on the same epoch (as after every new baseline) must not mine the values of the previous start again
+    CpuAffinity::setMinerCores({0});
+    miner_local = std::make_shared<MinerLocal>(2);
+    auto mineValues = [this](uint32_t num_values) {
+        miner_local->start(12345, example_owner_public_key, 10, foundHashFunction());
+        EXPECT_TRUE(waitFor([this, num_values]() { return numFoundHashes() >= num_values; }));
+        stopMining();
+        std::lock_guard<std::mutex> lock(mtx_found_hashes_map_access_);
+        std::set<std::string> found_values;
+        for(auto& found_hash : found_hashes_map_) {
+            found_values.insert(found_hash.first);
+        }
+        found_hashes_map_.clear();
+        return found_values;
+    };
+    auto first_values = mineValues(10);
+    auto second_values = mineValues(10);
+    CpuAffinity::setMinerCores({});
+
+    ASSERT_GT(first_values.size(), 0);
+    ASSERT_GT(second_values.size(), 0);
+    for(auto& value : second_values) {
+        EXPECT_EQ(first_values.count(value), 0) << value;
+    }
+    //same host id, different work nonce
+    auto workPrefix = [](const std::string& value) {
+        return value.substr(0, value.rfind('_'));
+    };
+    EXPECT_NE(workPrefix(*first_values.begin()), workPrefix(*second_values.begin()));
+}
+
+TEST_F(TestMiner, consensusPhaseThrottle) {
+    auto waitForThrottledWorkers = [this](uint32_t num_throttled_workers) {
+        waitFor([&]() { return miner_local->numThrottledWorkers() == num_throttled_workers; });
+        return miner_local->numThrottledWorkers();
+    };
+
+    startMining(4);
+    EXPECT_EQ(miner_local->getConsensusPhaseThrottle(), MinerLocal::default_consensus_phase_throttle_percent);
+    miner_local->setConsensusPhaseThrottle(50);
+    miner_local->enterConsensusPhase();
+    EXPECT_TRUE(miner_local->isInConsensusPhase());
+    EXPECT_EQ(waitForThrottledWorkers(2), 2);
+
+    //overlapping phases, the throttle can be changed during a phase, the first worker never pauses
+    miner_local->enterConsensusPhase();
+    miner_local->setConsensusPhaseThrottle(100);
+    EXPECT_EQ(waitForThrottledWorkers(3), 3);
+    auto known_found_hashes = foundHashes();
+    EXPECT_TRUE(waitFor([&]() { return numFoundHashes() >= known_found_hashes.size() + 3; }));
+    EXPECT_EQ(workersOfNewFoundHashes(known_found_hashes), std::set<uint32_t>({0}));
+
+    //a new epoch during the phase does not wake up the workers
+    miner_local->start(54321, example_owner_public_key, 11, foundHashFunction());
+    EXPECT_EQ(waitForThrottledWorkers(3), 3);
+
+    miner_local->leaveConsensusPhase();
+    EXPECT_TRUE(miner_local->isInConsensusPhase());
+    miner_local->leaveConsensusPhase();
+    EXPECT_FALSE(miner_local->isInConsensusPhase());
+    EXPECT_EQ(waitForThrottledWorkers(0), 0);
+    known_found_hashes = foundHashes();
+    EXPECT_TRUE(waitFor([&]() { return workersOfNewFoundHashes(known_found_hashes).size() > 1; }));
+
+    //stop while throttled
+    miner_local->enterConsensusPhase();
+    EXPECT_EQ(waitForThrottledWorkers(3), 3);
+    stopMining();
+    miner_local->leaveConsensusPhase();
+}
+
+TEST_F(TestMiner, consensusPhaseSingleWorker) {
+    startMining(1);
+    miner_local->setConsensusPhaseThrottle(100);
+    miner_local->enterConsensusPhase();
+    auto num_found_hashes = numFoundHashes();
+    EXPECT_TRUE(waitFor([&]() { return numFoundHashes() > num_found_hashes; }));
+    EXPECT_EQ(miner_local->numThrottledWorkers(), 0);
+    miner_local->leaveConsensusPhase();
+    stopMining();
+}
+
+TEST_F(TestMiner, hotEpochSwitch) {
+    startMining(2);
+    EXPECT_TRUE(waitFor([this]() { return numFoundHashes() > 0; }));
+
+    hash_t max_allowed_hash, min_allowed_hash;
+    Blockchain::getHashArea(11, max_allowed_hash, min_allowed_hash);
+    std::mutex mtx_epoch_11_values;
+    std::vector<std::string> epoch_11_values;
+    auto start_time = std::chrono::steady_clock::now();
+    miner_local->start(54321, example_owner_public_key, 11, [&](epoch_t epoch, const std::string& data) {
+        std::lock_guard<std::mutex> lock(mtx_epoch_11_values);
+        EXPECT_EQ(epoch, 11);
+        epoch_11_values.push_back(data);
+    });
+    auto switch_duration_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+    EXPECT_EQ(miner_local->getEpoch(), 11);
+    EXPECT_TRUE(waitFor([&]() {
+        std::lock_guard<std::mutex> lock(mtx_epoch_11_values);
+        return !epoch_11_values.empty();
+    }));
+
+    start_time = std::chrono::steady_clock::now();
+    stopMining();
+    auto stop_duration_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+    std::cout << "Epoch switch: " << switch_duration_us << "us, stop: " << stop_duration_us << "us" << std::endl;
+
+    //no callback after stop returned
+    size_t num_epoch_11_values = 0;
+    {
+        std::lock_guard<std::mutex> lock(mtx_epoch_11_values);
+        num_epoch_11_values = epoch_11_values.size();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    std::lock_guard<std::mutex> lock(mtx_epoch_11_values);
+    EXPECT_EQ(epoch_11_values.size(), num_epoch_11_values);
+
+    EXPECT_GT(epoch_11_values.size(), 0);
+    const std::string expected_prefix = "D431_" + example_owner_public_key.getAsShortString() + "_";
+    for(auto& value : epoch_11_values) {
+        EXPECT_EQ(value.compare(0, expected_prefix.length(), expected_prefix), 0);
+        auto hash = CryptoHelper::calcHash(value);
+        EXPECT_TRUE(hash >= min_allowed_hash && hash <= max_allowed_hash) << value;
+    }
+}
+
+TEST_F(TestMiner, validMiningResultsAllImplementations) {
+    hash_t max_allowed_hash, min_allowed_hash;
+    Blockchain::getHashArea(10, max_allowed_hash, min_allowed_hash);
+    const std::string expected_prefix = "3039_" + example_owner_public_key.getAsShortString() + "_";
+
+    auto default_implementation = MultiBufferHash::getImplementation();
+    for(auto implementation : {MultiBufferHash::Implementation::Scalar, MultiBufferHash::Implementation::Avx2, MultiBufferHash::Implementation::Avx512}) {
+        if(!MultiBufferHash::isSupported(implementation)) {
+            continue;
+        }
+        MultiBufferHash::setImplementation(implementation);
+        found_hashes_map_.clear();
+        startMining(1);
+        EXPECT_TRUE(waitFor([this]() { return numFoundHashes() > 0 && miner_local->numChecksPerSecond() > 0; }));
+        auto num_checks_per_second = miner_local->numChecksPerSecond();
+        stopMining();
+
+        std::cout << "Implementation " << (uint32_t)implementation << ": " << num_checks_per_second << " checks per second, "
+                  << found_hashes_map_.size() << " minings" << std::endl;
+        EXPECT_GT(found_hashes_map_.size(), 0);
+        for(auto& found_hash : found_hashes_map_) {
+            EXPECT_EQ(found_hash.first.compare(0, expected_prefix.length(), expected_prefix), 0);
+            auto hash = CryptoHelper::calcHash(found_hash.first);
+            EXPECT_TRUE(hash >= min_allowed_hash && hash <= max_allowed_hash) << found_hash.first;
+        }
+    }
+    MultiBufferHash::setImplementation(default_implementation);
+}
+
+TEST_F(TestMiner, miningLoopCounterValues) {
+    hash_t max_allowed_hash, min_allowed_hash;
+    Blockchain::getHashArea(10, max_allowed_hash, min_allowed_hash);
+    //long prefix so that the messages start in the second 64 byte block
+    const std::string prefix = std::string(70, 'x') + "_";
+    MiningLoop mining_loop(prefix, min_allowed_hash, max_allowed_hash);
+    const uint32_t num_lanes = mining_loop.getNumLanes();
+
+    std::vector<std::string> found_values;
+    const std::function<void(const std::string&)> found_callback = [&found_values](const std::string& data_value) {
+        found_values.push_back(data_value);
+    };
+    //counter values up to 0x1000 cover every growth of the hex string
+    uint64_t value = 0;
+    while(value < 0x1000 + num_lanes) {
+        for(uint32_t lane=0;lane<num_lanes;lane++) {
+            std::stringstream stream;
+            stream << std::uppercase << std::hex << (value + lane);
+            ASSERT_EQ(mining_loop.getPayload(lane), stream.str());
+        }
+        value += mining_loop.checkNextBatch(found_callback);
+    }
+
+    //all reported values must be inside the hash area, all values inside the hash area must be reported
+    std::set<std::string> expected_values;
+    for(uint64_t i=0;i<value;i++) {
+        std::stringstream stream;
+        stream << prefix << std::uppercase << std::hex << i;
+        auto hash = CryptoHelper::calcHash(stream.str());
+        if(hash >= min_allowed_hash && hash <= max_allowed_hash) {
+            expected_values.insert(stream.str());
+        }
+    }
+    EXPECT_GT(expected_values.size(), 0);
+    EXPECT_EQ(std::set<std::string>(found_values.begin(), found_values.end()), expected_values);
+    EXPECT_EQ(found_values.size(), expected_values.size());
+}
+
+TEST_F(TestMiner, remoteMiningLocalhost) {
+    MinerServer miner_server(0);
+    MinerClient miner_client("127.0.0.1", miner_server.getPort(), 2);
+    miner_client.start();
+    miner_server.start(12345, example_owner_public_key, 10, foundHashFunction());
+    EXPECT_TRUE(waitFor([&]() {
+        return miner_server.numConnectedMiners() == 2 && miner_server.numChecksPerSecond() > 0 && numFoundHashes() > 0;
+    }));
+    auto num_checks_per_second = miner_server.numChecksPerSecond();
+    //client first, values found while stopping the server would be counted by the client but dropped by the server
+    miner_client.stop();
+    EXPECT_TRUE(waitFor([&]() { return numFoundHashes() == miner_client.numFoundValues(); }));
+    miner_server.stop();
+
+    std::cout << "Remote mining: " << num_checks_per_second << " checks per second, " << found_hashes_map_.size() << " minings" << std::endl;
+    EXPECT_GT(num_checks_per_second, 0);
+    EXPECT_GT(found_hashes_map_.size(), 0);
+    EXPECT_EQ(found_hashes_map_.size(), miner_client.numFoundValues());
+
+    hash_t max_allowed_hash, min_allowed_hash;
+    Blockchain::getHashArea(10, max_allowed_hash, min_allowed_hash);
+    const std::string expected_prefix = "3039_" + example_owner_public_key.getAsShortString() + "_";
+    for(auto& found_hash : found_hashes_map_) {
+        EXPECT_EQ(found_hash.second, 10);
+        EXPECT_EQ(found_hash.first.compare(0, expected_prefix.length(), expected_prefix), 0);
+        auto hash = CryptoHelper::calcHash(found_hash.first);
+        EXPECT_TRUE(hash >= min_allowed_hash && hash <= max_allowed_hash) << found_hash.first;
+    }
+}
+
+TEST_F(TestMiner, minerServerListenAddressAndConnectionLimit) {
+    EXPECT_EQ(MinerServer(0).getListenAddress(), "127.0.0.1");
+
+    //the third remote mining thread is rejected
+    MinerServer miner_server(0, nullptr, "127.0.0.1", 2);
+    EXPECT_EQ(miner_server.getListenAddress(), "127.0.0.1");
+    MinerClient miner_client("127.0.0.1", miner_server.getPort(), 3);
+    miner_client.start();
+    EXPECT_TRUE(waitFor([&]() { return miner_server.numConnectedMiners() == 2; }));
+    EXPECT_EQ(miner_server.numConnectedMiners(), 2);
+    miner_client.stop();
+}
+
+TEST_F(TestMiner, minerServerProtocol) {
+    MinerServer miner_server(0);
+    boost::asio::io_context io_context;
+    boost::asio::ip::tcp::socket socket(io_context);
+    socket.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::address_v4::loopback(), miner_server.getPort()));
+
+    auto requestWork = [&socket](uint64_t num_requested_values, miner_protocol::MessageType& type, miner_protocol::AssignWork& work) {
+        miner_protocol::RequestWork request;
+        request.version = miner_protocol::protocol_version;
+        request.num_checked_values = 0;
+        request.num_requested_values = num_requested_values;
+        std::string payload;
+        EXPECT_TRUE(miner_protocol::writeMessage(socket, miner_protocol::MessageType::RequestWork, request));
+        EXPECT_TRUE(miner_protocol::readMessage(socket, type, payload));
+        if(type == miner_protocol::MessageType::AssignWork) {
+            EXPECT_TRUE(miner_protocol::parseMessage(payload, work));
+        }
+    };
+
+    //no work before start
+    miner_protocol::MessageType type;
+    miner_protocol::AssignWork work1, work2;
+    requestWork(1000, type, work1);
+    EXPECT_EQ(type, miner_protocol::MessageType::NoWork);
+
+    //consecutive work units get disjoint counter ranges
+    miner_server.start(12345, example_owner_public_key, 10, foundHashFunction());
+    requestWork(1000, type, work1);
+    ASSERT_EQ(type, miner_protocol::MessageType::AssignWork);
+    requestWork(1, type, work2);
+    ASSERT_EQ(type, miner_protocol::MessageType::AssignWork);
+    EXPECT_EQ(work1.epoch, 10);
+    EXPECT_EQ(work1.work_id, work2.work_id);
+    EXPECT_EQ(work1.prefix, work2.prefix);
+    EXPECT_EQ(work1.num_counter_values, 1024);
+    EXPECT_EQ(work2.num_counter_values, miner_protocol::counter_value_granularity);
+    EXPECT_EQ(work2.first_counter_value, work1.first_counter_value + work1.num_counter_values);
+
+    //invalid and outdated values are dropped, a valid one is passed to the callback
+    std::string valid_value;
+    MiningLoop mining_loop(work1.prefix, work1.min_allowed_value, work1.max_allowed_value, work1.first_counter_value);
+    while(valid_value.empty()) {
+        mining_loop.checkNextBatch([&valid_value](const std::string& data_value) { valid_value = data_value; });
+    }
+    miner_protocol::FoundValue found_value;
+    found_value.work_id = work1.work_id;
+    found_value.data_value = work1.prefix + "0";
+    EXPECT_TRUE(miner_protocol::writeMessage(socket, miner_protocol::MessageType::FoundValue, found_value));
+    found_value.work_id = work1.work_id - 1;
+    found_value.data_value = valid_value;
+    EXPECT_TRUE(miner_protocol::writeMessage(socket, miner_protocol::MessageType::FoundValue, found_value));
+    found_value.work_id = work1.work_id;
+    EXPECT_TRUE(miner_protocol::writeMessage(socket, miner_protocol::MessageType::FoundValue, found_value));
+    //the reply to a work request guarantees that the found values have been handled
+    requestWork(1, type, work2);
+    EXPECT_EQ(found_hashes_map_.size(), 1);
+    EXPECT_EQ(found_hashes_map_.count(valid_value), 1);
+
+    //a new epoch gets a new work id, stop ends handing out work
+    miner_server.start(12345, example_owner_public_key, 11, foundHashFunction());
+    requestWork(1, type, work2);
+    ASSERT_EQ(type, miner_protocol::MessageType::AssignWork);
+    EXPECT_EQ(work2.epoch, 11);
+    EXPECT_GT(work2.work_id, work1.work_id);
+    miner_server.stop();
+    requestWork(1, type, work2);
+    EXPECT_EQ(type, miner_protocol::MessageType::NoWork);
+}
@@ -0,0 +1,93 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+//separate test executable: replaces the global operator new to count allocations, which must not affect other tests
+
+#include "scn/Miner/MiningLoop.h"
+#include "scn/Blockchain/Blockchain.h"
+#include <gtest/gtest.h>
+#include <glog/logging.h>
+#include <cstdlib>
+#include <new>
+
+using namespace scn;
+
+namespace {
+    //allocations are only counted on threads which enabled counting
+    thread_local bool count_allocations = false;
+    thread_local uint64_t num_allocations = 0;
+}
+
+void* operator new(std::size_t size) {
+    if(count_allocations) {
+        num_allocations++;
+    }
+    if(void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    std::free(ptr);
+}
+
+
+TEST(TestMiningLoopAllocations, miningLoopBenchmarkNoAllocation) {
+    hash_t max_allowed_hash, min_allowed_hash;
+    Blockchain::getHashArea(10, max_allowed_hash, min_allowed_hash);
+    //same length as a real prefix (epoch, short public key string, miner id)
+    const std::string prefix = "3039_" + std::string(120, 'K') + "_12345_";
+    MiningLoop mining_loop(prefix, min_allowed_hash, max_allowed_hash);
+
+    uint64_t num_found = 0;
+    const std::function<void(const std::string&)> found_callback = [&num_found](const std::string&) {
+        num_found++;
+    };
+    //the found path builds the data value string - not counted, the hit rate is known from the number of found values
+    uint64_t num_checks = 0;
+    uint64_t num_found_before = 0;
+    uint64_t num_allocations_without_hit = 0;
+    auto start_time = std::chrono::steady_clock::now();
+    for(uint32_t batch=0;batch<200000;batch++) {
+        num_found_before = num_found;
+        num_allocations = 0;
+        count_allocations = true;
+        num_checks += mining_loop.checkNextBatch(found_callback);
+        count_allocations = false;
+        if(num_found == num_found_before) {
+            num_allocations_without_hit += num_allocations;
+        }
+    }
+    auto duration_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+
+    std::cout << "Mining loop: " << num_checks << " checks in " << duration_us << "us ("
+              << (num_checks * 1000000 / std::max<int64_t>(duration_us, 1)) << " checks per second), "
+              << num_found << " minings" << std::endl;
+    EXPECT_EQ(num_allocations_without_hit, 0);
+    EXPECT_GT(num_found, 0);
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    google::InitGoogleLogging(argv[0]);
+    return RUN_ALL_TESTS();
+}
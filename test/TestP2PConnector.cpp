@@ -406,6 +406,28 @@ TEST_F(TestP2PConnector, incomingAskForBlock2) {
     EXPECT_EQ(dummy_peer_.send_message_counter_, 1);
 }
 
+TEST_F(TestP2PConnector, incomingAskForBlockReplyShared) {
+    std::stringstream oss;
+    cereal::PortableBinaryOutputArchive oa(oss);
+    oa << (uint16_t)1; //protocol version
+    oa << (uint8_t)5; //AskForBlock
+    oa << blockchain_.getNewestBlockId();
+
+    p2p_connector_.receivedMessage(dummy_peer_, oss.str());
+    auto first_reply = dummy_peer_.last_message_;
+    p2p_connector_.receivedMessage(dummy_peer_, oss.str());
+
+    EXPECT_EQ(dummy_peer_.send_message_counter_, 2);
+    ASSERT_NE(first_reply, nullptr);
+    EXPECT_EQ(dummy_peer_.last_message_, first_reply); //same buffer, not serialized again
+    EXPECT_EQ(blockchain_.getCache().numEncodedBlockHits(), 1);
+
+    //the reply is a regular block message
+    p2p_connector_.receivedMessage(dummy_peer_, *first_reply);
+    ASSERT_NE(last_received_collection_block, nullptr);
+    EXPECT_EQ(last_received_collection_block->header.generic_header.block_hash, blockchain_.getNewestBlock()->header.generic_header.block_hash);
+}
+
 TEST_F(TestP2PConnector, numConnectedPeers) {
     EXPECT_EQ(p2p_connector_.numConnectedPeers(), 1);
 
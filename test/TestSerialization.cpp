@@ -23,7 +23,7 @@
 #include <boost/random.hpp>
 using namespace boost::random;
 
-typedef independent_bits_engine<mt19937, 256, scn::hash_t> generator_hash_type;
+typedef independent_bits_engine<mt19937, 256, boost::multiprecision::uint256_t> generator_hash_type;
 
 using namespace scn;
 
@@ -152,7 +152,7 @@ TEST(TestSerialization, BaselineBlockHashHuge) {
     for(uint32_t epoch=0;epoch<coins_total/1000;epoch++) {
         block.data_value_hashes[epoch].reserve(1000);
         for(uint32_t creation=0;creation<1000;creation++) {
-            block.data_value_hashes[epoch].push_back(random_hash_generator());
+            block.data_value_hashes[epoch].push_back(hash_t(random_hash_generator()));
         }
     }
     t2 = std::chrono::system_clock::now();
@@ -33,9 +33,11 @@ namespace scn {
         std::string id_   = "123456";
         uint32_t send_message_counter_;
         uint32_t ban_counter_;
+        std::shared_ptr<const std::string> last_message_;
 
-        virtual void sendMessage(std::shared_ptr<std::string> message) {
+        virtual void sendMessage(std::shared_ptr<const std::string> message) {
             send_message_counter_++;
+            last_message_ = message;
         }
 
         virtual std::string getInfo() const {
@@ -0,0 +1,54 @@
+/*
+ * This file is part of SwabianCoin.
+ *
+ * SwabianCoin is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * SwabianCoin is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with SwabianCoin.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef FULL_NODE_SEALEDEPOCHSTORESTUB_H
+#define FULL_NODE_SEALEDEPOCHSTORESTUB_H
+
+#include "scn/Blockchain/SealedEpochStore.h"
+#include <limits>
+
+namespace scn {
+
+    //fails writes behind max_file_size_ like a full disk: the bytes which fit are written, then the stream fails
+    class SealedEpochStoreStub : public SealedEpochStore {
+    public:
+        explicit SealedEpochStoreStub(const std::string& file_path)
+        :SealedEpochStore(file_path)
+        ,max_file_size_(std::numeric_limits<uint64_t>::max()) {}
+
+        ~SealedEpochStoreStub() override = default;
+
+        uint64_t max_file_size_;
+
+    protected:
+
+        void writeToFile(std::ofstream& ofs, const char* data, uint64_t size) override {
+            if(!ofs) {
+                return;
+            }
+            auto position = static_cast<uint64_t>(ofs.tellp());
+            if(position + size > max_file_size_) {
+                SealedEpochStore::writeToFile(ofs, data, max_file_size_ - std::min(position, max_file_size_));
+                ofs.setstate(std::ios_base::badbit);
+                return;
+            }
+            SealedEpochStore::writeToFile(ofs, data, size);
+        }
+    };
+
+}
+
+#endif //FULL_NODE_SEALEDEPOCHSTORESTUB_H